@@ -18,14 +18,30 @@
 
 #include <assert.h>
 #include <exception>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdio.h>
 #include <string>
+#include <utime.h>
 #include <vector>
 
+// Uncomment to always evaluate every page (ignoring the cached metrics)
+//#define DISABLE_METRICS_CACHE
+
+// Bump whenever the evaluation changes so old cached metrics aren't used
+#define METRICS_CACHE_VERSION "2"
+
+// The most pages whose metrics are kept in the cache (each is a small file)
+#define MAX_METRICS_CACHE_ENTRIES 5000
+
 Evaluator::Evaluator(
     std::string resultsDirPath,
     std::string groundtruthDirPath,
-    bool typeSpecificMode)
-: coloredImageSubDirName("coloredImages") {
+    bool typeSpecificMode,
+    std::string metricsCachePath)
+: coloredImageSubDirName("coloredImages"), inMemoryResults(NULL),
+  inMemoryPageImages(NULL), cachedPageCount(0) {
   this->resultsDirPath = Utils::checkTrailingSlash(resultsDirPath);
   this->groundtruthDirPath = Utils::checkTrailingSlash(groundtruthDirPath);
   this->typeSpecificMode = typeSpecificMode;
@@ -34,6 +50,9 @@ Evaluator::Evaluator(
 
   this->groundtruthRectFilePath = this->groundtruthDirPath + std::string("groundtruth.rect");
   this->resultsRectFilePath = this->resultsDirPath + std::string("results.rect");
+  this->metricsCacheDirPath = (metricsCachePath != "") ?
+      Utils::checkTrailingSlash(metricsCachePath) :
+      this->resultsDirPath + std::string("metricsCache/");
 }
 
 
@@ -75,6 +94,9 @@ void Evaluator::evaluateSingleRun() {
   }
 
   // 4. Run the evaluation logic
+  groundtruthRectLines = readRectLinesByPage(groundtruthRectFilePath);
+  resultsRectLines = readRectLinesByPage(resultsRectFilePath);
+  cachedPageCount = 0;
   std::vector<std::vector<HypothesisMetrics> > all_dataset_metrics;   // the metrics for each page of the dataset being evaluated
   for(int i = 0; i < inputImagePaths.size(); ++i) {
 
@@ -86,39 +108,265 @@ void Evaluator::evaluateSingleRun() {
       return;
     }
 
-    // page metrics can be separated out by the type of element being evaluated
-    // or all combined together. in the former case there will be multiple metrics
-    // per page and in the latter just one per page.
-    std::vector<HypothesisMetrics> page_metrics;
-    try {
-    if(typeSpecificMode) {
-      // evaluate each type separately
-      HypothesisMetrics disp_metrics = getEvaluationMetrics(
-          (std::string)"displayed", i);
-      page_metrics.push_back(disp_metrics);
-      HypothesisMetrics emb_metrics = getEvaluationMetrics(
-          (std::string)"embedded", i);
-      page_metrics.push_back(emb_metrics);
-      //HypothesisMetrics label_metrics = getEvaluationMetrics(
-     //     (std::string)"label", i);
-     // page_metrics.push_back(label_metrics); // not doing label for now.... (and/or ever)
+    all_dataset_metrics.push_back(getPageMetrics(i));
+  }
+  assert(all_dataset_metrics.size() == inputImagePaths.size());
+  std::cout << "Finished evaluating images in " << resultsDirPath << " ("
+      << cachedPageCount << " of " << inputImagePaths.size()
+      << " pages were unchanged and used their cached metrics)" << std::endl;
+#ifndef DISABLE_METRICS_CACHE
+  evictCachedMetrics();
+#endif
+
+  printMetricsToFile(all_dataset_metrics);
+}
+
+std::vector<DatasetMetrics> Evaluator::evaluateInMemory(
+    const std::vector<MathExpressionFinderResults*>& results,
+    Pixa* const pageImages) {
+
+  // 1. Verify the groundtruth dir is in the correct format (there's no
+  //    results dir to check since the results haven't been written)
+  if(!verifyOneRectFileAt(groundtruthDirPath)) {
+    return std::vector<DatasetMetrics>();
+  }
+  if(!Utils::existsFile(groundtruthRectFilePath)) {
+    std::cout << "ERROR: The groundtruth .rect file is expected to be named as follows: "
+        << groundtruthRectFilePath << ". A file with that path could not be found.\n";
+    return std::vector<DatasetMetrics>();
+  }
+  if(!DatasetSelectionMenu::groundtruthDirPathIsGood(groundtruthDirPath)) {
+    return std::vector<DatasetMetrics>();
+  }
+
+  // 2. Make sure there's a result and an image for each groundtruth page
+  inputImagePaths = DatasetSelectionMenu::findGroundtruthImagePaths(groundtruthDirPath);
+  if(results.size() != pixaGetCount(pageImages)) {
+    std::cout << "ERROR: There are " << results.size() << " results but "
+        << pixaGetCount(pageImages) << " page images.\n";
+    return std::vector<DatasetMetrics>();
+  }
+  if(results.size() != inputImagePaths.size()) {
+    std::cout << "ERROR: There are results for " << results.size() << " pages "
+        << "but the groundtruth has " << inputImagePaths.size() << " pages.\n";
+    return std::vector<DatasetMetrics>();
+  }
+
+  // 3. Run the evaluation logic on the results as they are
+  inMemoryResults = &results;
+  inMemoryPageImages = pageImages;
+  groundtruthRectLines = readRectLinesByPage(groundtruthRectFilePath);
+  resultsRectLines.clear();
+  cachedPageCount = 0;
+  std::vector<std::vector<HypothesisMetrics> > all_dataset_metrics;
+  for(int i = 0; i < results.size(); ++i) {
+    if(Utils::stringSplit(results[i]->getResultsName(), '.')[0] != Utils::intToString(i)) {
+      std::cout << "Error: " << results[i]->getResultsName() << " is at the " << i
+          << " index in its vector which doesn't match its name.\n";
+      inMemoryResults = NULL;
+      inMemoryPageImages = NULL;
+      return std::vector<DatasetMetrics>();
     }
-    else {
-      // evaluate all of the above types (considering them all the same)
-      HypothesisMetrics all_metrics = getEvaluationMetrics(
-          (std::string)"all", i);
-      page_metrics.push_back(all_metrics);
+    all_dataset_metrics.push_back(getPageMetrics(i));
+  }
+  inMemoryResults = NULL;
+  inMemoryPageImages = NULL;
+  std::cout << "Finished evaluating the results in memory (" << cachedPageCount
+      << " of " << results.size() << " pages were unchanged and used their "
+      << "cached metrics)" << std::endl;
+#ifndef DISABLE_METRICS_CACHE
+  evictCachedMetrics();
+#endif
+
+  if(!Utils::existsDirectory(resultsDirPath)) {
+    Utils::exec(std::string("mkdir -p ") + resultsDirPath);
+  }
+  return printMetricsToFile(all_dataset_metrics);
+}
+
+std::vector<HypothesisMetrics> Evaluator::getPageMetrics(const int i) {
+  // page metrics can be separated out by the type of element being evaluated
+  // or all combined together. in the former case there will be multiple metrics
+  // per page and in the latter just one per page.
+  std::vector<HypothesisMetrics> page_metrics;
+
+  // skip the evaluation if nothing the page's metrics depend on has changed
+#ifndef DISABLE_METRICS_CACHE
+  const std::string cacheKey = getPageCacheKey(i);
+  if(readCachedPageMetrics(cacheKey, &page_metrics)) {
+    ++cachedPageCount;
+    return page_metrics;
+  }
+#endif
+  try {
+  if(typeSpecificMode) {
+    // evaluate each type separately
+    HypothesisMetrics disp_metrics = getEvaluationMetrics(
+        (std::string)"displayed", i);
+    page_metrics.push_back(disp_metrics);
+    HypothesisMetrics emb_metrics = getEvaluationMetrics(
+        (std::string)"embedded", i);
+    page_metrics.push_back(emb_metrics);
+    //HypothesisMetrics label_metrics = getEvaluationMetrics(
+   //     (std::string)"label", i);
+   // page_metrics.push_back(label_metrics); // not doing label for now.... (and/or ever)
+  }
+  else {
+    // evaluate all of the above types (considering them all the same)
+    HypothesisMetrics all_metrics = getEvaluationMetrics(
+        (std::string)"all", i);
+    page_metrics.push_back(all_metrics);
+  }
+  } catch (std::exception& e) {
+    std::cout << "ERROR: Exception caught while running the evaluation.\n";
+    return page_metrics; // not cached since it's incomplete
+  }
+#ifndef DISABLE_METRICS_CACHE
+  writeCachedPageMetrics(cacheKey, page_metrics);
+#endif
+  return page_metrics;
+}
+
+std::string Evaluator::getPageCacheKey(const int i) {
+  std::string mode = std::string(METRICS_CACHE_VERSION) +
+      (typeSpecificMode ? " typeSpecific" : " all");
+  unsigned long long hash = Utils::hashBytes(mode.c_str(), mode.size());
+  const std::string& groundtruthRects = groundtruthRectLines[i];
+  hash = Utils::hashBytes(groundtruthRects.c_str(), groundtruthRects.size(), hash);
+  if(inMemoryResults == NULL) {
+    const std::string& resultsRects = resultsRectLines[i];
+    hash = Utils::hashBytes(resultsRects.c_str(), resultsRects.size(), hash);
+    hash = Utils::hashFile(inputImagePaths[i], hash);
+    hash = Utils::hashFile(coloredResultsImagePaths[i], hash);
+  } else {
+    MathExpressionFinderResults* const pageResults = (*inMemoryResults)[i];
+    const std::string resultsRects = pageResults->getResultsRectLines();
+    hash = Utils::hashBytes(resultsRects.c_str(), resultsRects.size(), hash);
+    Pix* const images[2] = { pixaGetPix(inMemoryPageImages, i, L_CLONE),
+        pageResults->getVisualResultsEvalDisplay() };
+    for(int j = 0; j < 2; ++j) {
+      const l_int32 width = pixGetWidth(images[j]);
+      const l_int32 height = pixGetHeight(images[j]);
+      const l_int32 depth = pixGetDepth(images[j]);
+      const l_int32 dims[3] = { width, height, depth };
+      hash = Utils::hashBytes((const char*)dims, sizeof(dims), hash);
+      // Only the bits of each row that hold pixels are hashed. The padding
+      // out to the end of the row's last word isn't necessarily cleared, so
+      // it would give the same page a different key. Leptonica packs the
+      // pixels from the most significant bit of each word down.
+      const l_int32 wpl = pixGetWpl(images[j]);
+      const l_int32 fullWords = (width * depth) / 32;
+      const l_int32 extraBits = (width * depth) % 32;
+      const l_uint32 lastWordMask = (extraBits == 0) ? 0 :
+          (0xffffffff << (32 - extraBits));
+      const l_uint32* const data = pixGetData(images[j]);
+      for(l_int32 y = 0; y < height; ++y) {
+        const l_uint32* const row = data + y * wpl;
+        hash = Utils::hashBytes((const char*)row, fullWords * 4, hash);
+        if(extraBits > 0) {
+          const l_uint32 lastWord = row[fullWords] & lastWordMask;
+          hash = Utils::hashBytes((const char*)&lastWord, 4, hash);
+        }
+      }
+    }
+    Pix* binaryImage = images[0];
+    pixDestroy(&binaryImage);
+  }
+  char key[17];
+  snprintf(key, sizeof(key), "%016llx", hash);
+  return std::string(key);
+}
+
+bool Evaluator::readCachedPageMetrics(const std::string& key,
+    std::vector<HypothesisMetrics>* const page_metrics) {
+  const std::string cachePath = metricsCacheDirPath + key;
+  std::ifstream cacheStream(cachePath.c_str());
+  if(!cacheStream.is_open()) {
+    return false;
+  }
+  utime(cachePath.c_str(), NULL); // mark it as recently used
+  std::vector<HypothesisMetrics> cached;
+  std::string line;
+  while(std::getline(cacheStream, line)) {
+    if(line.empty()) {
+      continue;
     }
-    } catch (std::exception& e) {
-      std::cout << "ERROR: Exception caught while running the evaluation.\n";
+    std::istringstream lineStream(line);
+    HypothesisMetrics m;
+    lineStream >> m.res_type_name >> m.correctsegmentations >> m.total_gt_regions
+        >> m.total_recall >> m.total_fallout >> m.total_precision >> m.total_fdr
+        >> m.oversegmentations >> m.avg_oversegmentations_perbox
+        >> m.undersegmentations >> m.avg_undersegmentations_perbox
+        >> m.oversegmentedcomponents >> m.undersegmentedcomponents
+        >> m.falsenegatives >> m.falsepositives >> m.negative_predictive_val
+        >> m.specificity >> m.accuracy >> m.total_false_negative_pix
+        >> m.total_false_positive_pix >> m.total_positive_fg_pix
+        >> m.total_true_positive_fg_pix >> m.total_true_negative_fg_pix
+        >> m.total_fg_pix >> m.total_negative_fg_pix;
+    if(lineStream.fail()) {
+      return false; // corrupt, evaluate it again
     }
-    all_dataset_metrics.push_back(page_metrics);
+    cached.push_back(m);
   }
-  assert(all_dataset_metrics.size() == inputImagePaths.size());
-  std::cout << "Finished evaluating images in " << resultsDirPath << std::endl;
+  if(cached.size() != (typeSpecificMode ? 2 : 1)) {
+    return false;
+  }
+  *page_metrics = cached;
+  return true;
+}
 
+void Evaluator::writeCachedPageMetrics(const std::string& key,
+    const std::vector<HypothesisMetrics>& page_metrics) {
+  if(!Utils::existsDirectory(metricsCacheDirPath)) {
+    Utils::exec(std::string("mkdir -p ") + metricsCacheDirPath);
+  }
+  std::ofstream cacheStream((metricsCacheDirPath + key).c_str());
+  cacheStream << std::setprecision(17);
+  for(int i = 0; i < page_metrics.size(); ++i) {
+    const HypothesisMetrics& m = page_metrics[i];
+    cacheStream << m.res_type_name << " " << m.correctsegmentations << " "
+        << m.total_gt_regions << " " << m.total_recall << " " << m.total_fallout
+        << " " << m.total_precision << " " << m.total_fdr << " "
+        << m.oversegmentations << " " << m.avg_oversegmentations_perbox << " "
+        << m.undersegmentations << " " << m.avg_undersegmentations_perbox << " "
+        << m.oversegmentedcomponents << " " << m.undersegmentedcomponents << " "
+        << m.falsenegatives << " " << m.falsepositives << " "
+        << m.negative_predictive_val << " " << m.specificity << " "
+        << m.accuracy << " " << m.total_false_negative_pix << " "
+        << m.total_false_positive_pix << " " << m.total_positive_fg_pix << " "
+        << m.total_true_positive_fg_pix << " " << m.total_true_negative_fg_pix
+        << " " << m.total_fg_pix << " " << m.total_negative_fg_pix << "\n";
+  }
+}
+
+void Evaluator::evictCachedMetrics() {
+  if(!Utils::existsDirectory(metricsCacheDirPath)) {
+    return;
+  }
+  // the entries are listed newest first, so everything past the limit goes
+  Utils::exec(std::string("cd ") + metricsCacheDirPath + std::string(" && ls -t | tail -n +")
+      + Utils::intToString(MAX_METRICS_CACHE_ENTRIES + 1)
+      + std::string(" | xargs -r rm -f"));
+}
 
+std::map<int, std::string> Evaluator::readRectLinesByPage(
+    const std::string& rectFilePath) {
+  std::map<int, std::string> rectLines;
+  std::ifstream rectStream(rectFilePath.c_str());
+  std::string line;
+  while(std::getline(rectStream, line)) {
+    if(line.empty()) {
+      continue;
+    }
+    const int pageNumber = atoi(Utils::stringSplit(
+        Utils::stringSplit(line)[0], '.')[0].c_str());
+    rectLines[pageNumber] += line + "\n";
+  }
+  return rectLines;
+}
 
+std::vector<DatasetMetrics> Evaluator::printMetricsToFile(
+    const std::vector<std::vector<HypothesisMetrics> >& all_dataset_metrics) {
   std::vector<DatasetMetrics> avg_dataset_metrics = getDatasetAverages(all_dataset_metrics);
 
   // print all the metrics to a file in a subdir of the results directory
@@ -130,6 +378,7 @@ void Evaluator::evaluateSingleRun() {
   MetricsPrinter::printDatasetMetrics(all_dataset_metrics, metric_stream);
   metric_stream << "-----------------------------------------\n";
   MetricsPrinter::printAvgMetrics(avg_dataset_metrics, metric_stream);
+  return avg_dataset_metrics;
 }
 
 vector<DatasetMetrics> Evaluator::getDatasetAverages(
@@ -234,16 +483,9 @@ HypothesisMetrics Evaluator::getEvaluationMetrics(
 
   // The first step is to create the bipartite graph data structure
   // for the image
-  GraphInput gi;
-
-  gi.gtboxfile = groundtruthRectFilePath;
-  gi.gtimg = readInColorImage(coloredGroundtruthImagePaths[i]);
-  gi.hypboxfile = resultsRectFilePath;
-  gi.hypimg = readInColorImage(coloredResultsImagePaths[i]);
-  gi.imgname = Utils::getNameFromPath(inputImagePaths[i]);
+  GraphInput gi = getGraphInput(i);
   gi.evalTopDir = evalTopDir;
   gi.dbgdir = this_dbgdir;
-  gi.inimg = readInColorImage(inputImagePaths[i]);
   BipartiteGraph pixelGraph(typenamespec, gi);
 
   // Now get and print the metrics
@@ -261,6 +503,83 @@ HypothesisMetrics Evaluator::getEvaluationMetrics(
 
 
 
+GraphInput Evaluator::getGraphInput(const int i) {
+  GraphInput gi;
+  gi.gtboxfile = groundtruthRectFilePath;
+  if(inMemoryResults == NULL) {
+    gi.gtimg = readInColorImage(coloredGroundtruthImagePaths[i]);
+    gi.hypboxfile = resultsRectFilePath;
+    gi.hypimg = readInColorImage(coloredResultsImagePaths[i]);
+    gi.imgname = Utils::getNameFromPath(inputImagePaths[i]);
+    gi.inimg = readInColorImage(inputImagePaths[i]);
+  } else {
+    // the graph destroys its images when cleared, so it gets copies
+    MathExpressionFinderResults* const pageResults = (*inMemoryResults)[i];
+    Pix* binaryImage = pixaGetPix(inMemoryPageImages, i, L_CLONE);
+    gi.gtimg = colorGroundtruthPage(binaryImage, i);
+    gi.hypboxes = pageResults->getResultsRectLines();
+    gi.hypboxesinmemory = true;
+    gi.hypimg = pixConvertTo32(pageResults->getVisualResultsEvalDisplay());
+    gi.imgname = pageResults->getResultsName();
+    gi.inimg = pixConvertTo32(binaryImage);
+    gi.savetracker = false;
+    pixDestroy(&binaryImage);
+  }
+  return gi;
+}
+
+Pix* Evaluator::colorGroundtruthPage(Pix* const binaryImage,
+    const int pageNumber) {
+  Pix* coloredImage = pixConvertTo32(binaryImage);
+  std::ifstream gtFileStream(groundtruthRectFilePath.c_str());
+  if(!gtFileStream.is_open()) {
+    std::cout << "ERROR: Could not open the file at "
+         << groundtruthRectFilePath << endl;
+    throw std::exception();
+  }
+  std::string line;
+  while(getline(gtFileStream, line)) {
+    if(line.empty()) {
+      continue;
+    }
+    std::vector<std::string> splitline = Utils::stringSplit(line);
+    if(atoi(Utils::stringSplit(splitline[0], '.')[0].c_str()) != pageNumber) {
+      continue;
+    }
+    const int rectleft = atoi(splitline[2].c_str());
+    const int recttop = atoi(splitline[3].c_str());
+    const int rectright = atoi(splitline[4].c_str());
+    const int rectbottom = atoi(splitline[5].c_str());
+    if(rectleft == -1 || recttop == -1 ||
+        rectright == -1 || rectbottom == -1)
+      continue; // if the image has nothing then it should have a single entry with -1's
+    LayoutEval::Color color;
+    if(!getColorFromRectType(splitline[1], &color)) {
+      std::cout << "ERROR: Rectangle of unknown type in .rect file.\n";
+      throw std::exception();
+    }
+    BOX* box = boxCreate(rectleft, recttop,
+        rectright - rectleft, rectbottom - recttop);
+    Lept_Utils::fillBoxForeground(coloredImage, box, color);
+    boxDestroy(&box);
+  }
+  gtFileStream.close();
+  return coloredImage;
+}
+
+bool Evaluator::getColorFromRectType(const std::string& recttype,
+    LayoutEval::Color* const color) {
+  if(recttype == "displayed")
+    *color = LayoutEval::RED;
+  else if(recttype == "embedded")
+    *color = LayoutEval::BLUE;
+  else if(recttype == "label")
+    *color = LayoutEval::GREEN;
+  else
+    return false;
+  return true;
+}
+
 Pix* Evaluator::readInColorImage(const std::string& imagePath) {
   Pix* image = Utils::leptReadImg(imagePath);
   Pix* convertedImage = pixConvertTo32(image);
@@ -351,13 +670,7 @@ bool Evaluator::colorGroundtruthBlobs() {
     BOX* box = boxCreate(rectleft, recttop,
         rectright - rectleft, rectbottom - recttop);
     LayoutEval::Color color;
-    if(recttype == "displayed")
-      color = LayoutEval::RED;
-    else if(recttype == "embedded")
-      color = LayoutEval::BLUE;
-    else if(recttype == "label")
-      color = LayoutEval::GREEN;
-    else {
+    if(!getColorFromRectType(recttype, &color)) {
       std::cout << "ERROR: Rectangle of unknown type in .rect file.\n";
       return false;
     }
@@ -8,9 +8,14 @@
 #ifndef EVALUATOR_H_
 #define EVALUATOR_H_
 
+#include <MFinderResults.h>
 #include <DatasetMetrics.h>
 #include <baseapi.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
 /********************************************************************************
 * Evaluate layout accuracy.                                                     *
 *                                                                               *
@@ -27,6 +32,14 @@
 * Takes the groundtruth data                                                    *
 * and uses it to color the blobs of interest appropriately based on their type. *
 *                                                                               *
+* The metrics for each page are cached keyed by a hash of the page's result    *
+* rectangles, groundtruth rectangles, and images, so only the pages whose       *
+* results changed since the last evaluation are evaluated again. The dataset    *
+* averages are always computed from all of the pages. The cache is kept in the  *
+* results directory unless another one is given (the finder keeps it with the   *
+* trained finder since its results directory is cleared out on every run) and   *
+* only the most recently used MAX_METRICS_CACHE_ENTRIES pages are kept in it.   *
+*                                                                               *
 ********************************************************************************/
 class Evaluator {
  public:
@@ -34,10 +47,25 @@ class Evaluator {
   Evaluator(
       std::string resultsPath,
       std::string groundtruthPath,
-      bool typeSpecificMode);
+      bool typeSpecificMode,
+      std::string metricsCachePath="");
 
   void evaluateSingleRun();
 
+  /**
+   * Evaluates results straight from the finder without going through the
+   * results directory. The hypothesis rectangles are taken from the results,
+   * the colored hypothesis images from their eval displays, and the colored
+   * groundtruth images are made from the binary page images the results were
+   * found on, so no images are written out or read back in. The results and
+   * images have to be for all of the groundtruth pages in order (i.e., named
+   * 0, 1, 2, ...). The metrics are written to the results directory the same
+   * way evaluateSingleRun writes them. Returns the dataset averages (one for
+   * each result type being evaluated), or nothing if the evaluation failed.
+   */
+  std::vector<DatasetMetrics> evaluateInMemory(const std::vector<MathExpressionFinderResults*>& results,
+      Pixa* const pageImages);
+
   void evaluateMultipleRuns();
 
  private:
@@ -52,8 +80,50 @@ class Evaluator {
 
   Pix* readInColorImage(const std::string& imagePath);
 
+  // Gets the metrics of the page at the given index for each of the
+  // result types being evaluated
+  std::vector<HypothesisMetrics> getPageMetrics(const int imageIndex);
+
   HypothesisMetrics getEvaluationMetrics(const std::string typenamespec,
       const int imageIndex);
+
+  // Builds the graph input for the page at the given index either from the
+  // files or from the results being evaluated in memory
+  GraphInput getGraphInput(const int imageIndex);
+
+  // Averages the metrics over the pages and prints them to the results dir,
+  // returns the averages
+  std::vector<DatasetMetrics> printMetricsToFile(
+      const std::vector<std::vector<HypothesisMetrics> >& all_dataset_metrics);
+
+  // Colors the foreground pixels of a copy of the given binary page image
+  // based on the groundtruth rectangles for that page
+  Pix* colorGroundtruthPage(Pix* const binaryImage, const int pageNumber);
+
+  // Gets the key the page's metrics are cached under: a hash of its result
+  // rectangles, groundtruth rectangles, and images, along with the mode
+  std::string getPageCacheKey(const int imageIndex);
+
+  // Reads the cached metrics for the page with the given key, returns false
+  // if there aren't any. The cached metrics don't include the per region
+  // descriptions (i.e., the boxes and overlapgts) since they're only needed
+  // for printing the page's verbose metrics, which are left as they were.
+  bool readCachedPageMetrics(const std::string& key,
+      std::vector<HypothesisMetrics>* const page_metrics);
+  void writeCachedPageMetrics(const std::string& key,
+      const std::vector<HypothesisMetrics>& page_metrics);
+
+  // Removes the least recently used cached metrics once there are more than
+  // MAX_METRICS_CACHE_ENTRIES (reading a page's metrics counts as using them)
+  void evictCachedMetrics();
+
+  // Reads in the lines of a .rect file grouped by page number
+  static std::map<int, std::string> readRectLinesByPage(const std::string& rectFilePath);
+
+  // Gets the evaluation color for a type of rectangle in a .rect file,
+  // returns false if the type is unknown
+  static bool getColorFromRectType(const std::string& recttype,
+      LayoutEval::Color* const color);
   std::vector<DatasetMetrics> getDatasetAverages(
       const std::vector<std::vector<HypothesisMetrics> >& all_metrics);
 
@@ -70,6 +140,17 @@ class Evaluator {
   std::vector<std::string> coloredGroundtruthImagePaths;
   std::vector<std::string> coloredResultsImagePaths;
 
+  // set while evaluating in memory (NULL otherwise)
+  const std::vector<MathExpressionFinderResults*>* inMemoryResults;
+  Pixa* inMemoryPageImages;
+
+  // the .rect file lines for each page (by page number)
+  std::map<int, std::string> groundtruthRectLines;
+  std::map<int, std::string> resultsRectLines; // only when not evaluating in memory
+
+  std::string metricsCacheDirPath;
+  int cachedPageCount; // pages whose metrics came from the cache on this run
+
   tesseract::ImageThresholder imageThresholder;
 };
 
@@ -20,6 +20,7 @@
 #include <assert.h>
 
 #include "Utils.h"
+using namespace std;
 using namespace Utils;
 
 #define debug 1
@@ -66,11 +67,18 @@ BipartiteGraph::BipartiteGraph(string type_, GraphInput input)
     cout << "ERROR: Could not open " << gtboxfilename << endl;
     assert(false);
   }
-  hypfile.open(hypboxfilename.c_str(), ifstream::in);
-  if((hypfile.rdstate() & std::ifstream::failbit) != 0 ) {
-    cout << "ERROR: Could not open " << hypboxfilename << endl;
-    assert(false);
+  if(input.hypboxesinmemory) {
+    hypboxstream.str(input.hypboxes);
+    hypinput = &hypboxstream;
+  } else {
+    hypfile.open(hypboxfilename.c_str(), ifstream::in);
+    if((hypfile.rdstate() & std::ifstream::failbit) != 0 ) {
+      cout << "ERROR: Could not open " << hypboxfilename << endl;
+      assert(false);
+    }
+    hypinput = &hypfile;
   }
+  savetracker = input.savetracker;
 
   // build and append all the vertices to the groundtruth set and
   // then the hypothesis set
@@ -150,7 +158,7 @@ void BipartiteGraph::destroyMetrics() {
 }
 
 void BipartiteGraph::makeVertices(Bipartite::GraphChoice graph) {
-  ifstream* file;
+  istream* file;
   PIX* img;
   vector<Vertex>* set;
   PIX* tracker;
@@ -161,7 +169,7 @@ void BipartiteGraph::makeVertices(Bipartite::GraphChoice graph) {
     set = &GroundTruth;
     tracker = gt_tracker;
   } else {
-    file = &hypfile;
+    file = hypinput;
     img = hypimg;
     set = &Hypothesis;
     tracker = hyp_tracker;
@@ -823,14 +831,16 @@ HypothesisMetrics BipartiteGraph::getHypothesisMetrics() {
   trackerDrawSegmentations();
 
 #ifdef SHOW_HYP_TRACKER_FINAL
-  string final_tracker_im = tracker_dir + filename + (string)"_" + type + (string)"_evalResults.png";
-  cout << "Displaying the final hypothesis tracker image and/or saving it to "
-       << final_tracker_im << endl;
-  pixWrite(final_tracker_im.c_str(), hyp_tracker, IFF_PNG);
+  if(savetracker) {
+    string final_tracker_im = tracker_dir + filename + (string)"_" + type + (string)"_evalResults.png";
+    cout << "Displaying the final hypothesis tracker image and/or saving it to "
+         << final_tracker_im << endl;
+    pixWrite(final_tracker_im.c_str(), hyp_tracker, IFF_PNG);
 #ifdef DISPLAY_ON
-  pixDisplay(hyp_tracker, 100, 100);
-  waitForInput();
+    pixDisplay(hyp_tracker, 100, 100);
+    waitForInput();
 #endif
+  }
 #endif
   return hypmetrics;
 }
@@ -21,7 +21,7 @@
 #include <vector>
 #include <string>
 #include <fstream>
-using namespace std;
+#include <sstream>
 #include <allheaders.h> // leptonica api
 
 #include <Lept_Utils.h>
@@ -36,11 +36,18 @@ struct Edge; // forward declaration
 // block detection specifies which rectangles in the
 // box files are of interest
 struct GraphInput {
-  string hypboxfile; // text file holding the hypothesis rectangles
-  string gtboxfile; // text file holding the groundtruth rectangles
-  string imgname; // the name of the image being evaluated
-  string evalTopDir; // evaluation directory
-  string dbgdir; // the directory to place all debug output
+  GraphInput() : hypboxesinmemory(false), savetracker(true),
+      hypimg(NULL), gtimg(NULL), inimg(NULL) {}
+  std::string hypboxfile; // text file holding the hypothesis rectangles
+  std::string hypboxes; // the hypothesis rectangles themselves (in the same format
+                   // as the file) if hypboxesinmemory is set
+  bool hypboxesinmemory; // read the hypothesis rectangles from hypboxes
+                         // rather than from hypboxfile
+  std::string gtboxfile; // text file holding the groundtruth rectangles
+  std::string imgname; // the name of the image being evaluated
+  std::string evalTopDir; // evaluation directory
+  std::string dbgdir; // the directory to place all debug output
+  bool savetracker; // whether the final tracker image is saved to evalTopDir
   PIX* hypimg;
   PIX* gtimg;
   PIX* inimg;
@@ -52,9 +59,9 @@ struct Vertex {
   int pix_foreground_duplicate; // part of the foreground but overlaps another vertex
                                 // this is recorded in order to avoid double counting
   int area;
-  string whichset; // either hypothesis or groundtruth
+  std::string whichset; // either hypothesis or groundtruth
   int setindex;
-  vector<Edge> edges;
+  std::vector<Edge> edges;
 };
 
 struct Edge {
@@ -87,7 +94,7 @@ struct GroundTruthMetrics {
   int total_area; // total area of the image
   double area_ratio; // ratio of total segmented rectangle area
                      // to total image area
-  vector<GTBoxDescription> descriptions; // metrics useful in weighting
+  std::vector<GTBoxDescription> descriptions; // metrics useful in weighting
                                          // the importance of each box
 };
 
@@ -204,10 +211,10 @@ struct HypothesisMetrics {
   int total_negative_fg_pix; // = total_fg_pix - total_positive_fg_pix
                              // this is the total number of pixels detected
                              // as negative in the hypothesis (TN+FN)
-  vector<RegionDescription> boxes; // metrics on each hypothesis rectangle
-  vector<OverlappingGTRegion> overlapgts;
+  std::vector<RegionDescription> boxes; // metrics on each hypothesis rectangle
+  std::vector<OverlappingGTRegion> overlapgts;
 
-  string res_type_name; // the type of page results being evaluated (type of layout analyzed)
+  std::string res_type_name; // the type of page results being evaluated (type of layout analyzed)
 };
 
 /**********************************************************************
@@ -267,7 +274,7 @@ public:
   // on the given type of block (i.e. for math equation detection
   // this could be either displayed regions, embedded regions,
   // or equation labels.
-  BipartiteGraph(string type, GraphInput input);
+  BipartiteGraph(std::string type, GraphInput input);
 
   ~BipartiteGraph();
 
@@ -309,7 +316,7 @@ private:
 
   void getGroundTruthMetrics();
 
-  LayoutEval::Color getColorFromType(const string& type);
+  LayoutEval::Color getColorFromType(const std::string& type);
 
   // true negatives are color-coded to orange
   int countTrueNegatives();
@@ -318,19 +325,19 @@ private:
   // within the hypbox that aren't within the bounds of any of the
   // groundtruth boxes in gtboxes (this gives the false positives
   // for the given hypbox). False positives are color coded to blue.
-  int countFalsePositives(BOX* hypbox, vector<BOX*> gtboxes, int& duplicates);
+  int countFalsePositives(BOX* hypbox, std::vector<BOX*> gtboxes, int& duplicates);
 
   // counts the pixels of the given color in any of the boxes in
   // the groundtruth box vector of gtim that are also in the
   // hypothesis box (this gives the number of true positives for the
   // given hypbox). True positives are color-coded to red.
-  int countTruePositives(BOX* hypbox, vector<BOX*> gtboxes, int& duplicates);
+  int countTruePositives(BOX* hypbox, std::vector<BOX*> gtboxes, int& duplicates);
 
   // counts the pixels of the given color in the groundtruth image
   // within the gtbox that aren't within the bounds of any of the
   // hypothesis boxes in hypboxes (this gives the false negatives
   // for the given gtbox). False negatives are color coded to green.
-  int countFalseNegatives(BOX* gtbox, vector<BOX*> hypboxes, int& duplicates);
+  int countFalseNegatives(BOX* gtbox, std::vector<BOX*> hypboxes, int& duplicates);
 
   // counts the number of pixels in the Box region of
   // the given Pix that have the given color. if
@@ -364,16 +371,19 @@ private:
   // evaluation results.
   void trackerDrawSegmentations();
 
-  string type; // the type of rectangle to look for in the txt file
+  std::string type; // the type of rectangle to look for in the txt file
   LayoutEval::Color color; // the color associated with the type
 
-  vector<Vertex> GroundTruth; // the groudtruth set
-  vector<Vertex> Hypothesis; // the hypothesis set
+  std::vector<Vertex> GroundTruth; // the groudtruth set
+  std::vector<Vertex> Hypothesis; // the hypothesis set
 
-  ifstream gtfile;
-  ifstream hypfile;
+  std::ifstream gtfile;
+  std::ifstream hypfile;
+  std::istringstream hypboxstream;
+  std::istream* hypinput; // either the hypothesis file or stream
+  bool savetracker;
   int filenum;
-  string filename;
+  std::string filename;
   PIX* inimg;
   PIX* hypimg;
   PIX* gtimg;
@@ -382,7 +392,7 @@ private:
                  // are evaluated
   PIX* gt_tracker; // tracks pixel counts made from groundtruth image
   PIX* hyp_tracker; // tracks pixel counts made from hypothesis image
-  string tracker_dir; // directory to place all debug output
+  std::string tracker_dir; // directory to place all debug output
 };
 
 #endif
@@ -16,10 +16,22 @@
 #include <InfoFileParser.h>
 #include <GeometryCat.h>
 #include <RecCat.h>
+#include <MemStats.h>
+#include <Evaluator.h>
+#include <PagePipeline.h>
+#include <WordCache.h>
+#include <ResolutionNormalizer.h>
+#include <PageSource.h>
 
 #include <allheaders.h> // leptonica
 
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 #include <string>
+#include <vector>
+#include <assert.h>
+#include <stdlib.h>
 
 // for testing
 #include <DetMenu.h>
@@ -40,19 +52,83 @@
  */
 int main(int argc, char* argv[]) {
 
-  if(argc == 2) {
-    if(std::string(argv[1]) == std::string("-m")) { // interactive menu
-      runInteractiveMenu();
-      return 0;
+  if(argc == 2 && std::string(argv[1]) == std::string("-m")) { // interactive menu
+    runInteractiveMenu();
+    return 0;
+  }
+
+  // Otherwise the arguments are the path to run on along with any options
+  char* path = NULL;
+  bool doJustDetection = false;
+  int shardIndex = 0;
+  int shardCount = 1;
+  int mergeShardCount = 0;
+  long memoryCeilingMB = 0;
+  char* evalGroundtruthPath = NULL;
+  PagePipelineConfig pipelineConfig;
+  bool pipelined = false;
+  int targetDpi = 0;
+  DetectionStateMode detectionStateMode = IGNORE_DETECTION_STATE;
+  std::vector<double> detectionThresholds;
+  int speckleFilter = -1; // -1 keeps the trained finder's setting
+  int pictureFilter = -1;
+  bool argsOk = (argc > 1);
+  for(int i = 1; i < argc && argsOk; ++i) {
+    const std::string arg = std::string(argv[i]);
+    if(arg == std::string("-d")) {
+      doJustDetection = true;
+    } else if(arg == std::string("--shard") && i + 1 < argc) {
+      argsOk = parseShard(std::string(argv[++i]), &shardIndex, &shardCount);
+    } else if(arg == std::string("--merge") && i + 1 < argc) {
+      mergeShardCount = atoi(argv[++i]);
+      argsOk = (mergeShardCount > 0);
+    } else if(arg == std::string("--max-rss-mb") && i + 1 < argc) {
+      memoryCeilingMB = atol(argv[++i]);
+      argsOk = (memoryCeilingMB > 0);
+    } else if(arg == std::string("--eval") && i + 1 < argc) {
+      evalGroundtruthPath = argv[++i];
+    } else if(arg == std::string("--pipeline") && i + 1 < argc) {
+      argsOk = parsePipeline(std::string(argv[++i]), &pipelineConfig);
+      pipelined = true;
+    } else if(arg == std::string("--dpi") && i + 1 < argc) {
+      targetDpi = atoi(argv[++i]);
+      argsOk = (targetDpi > 0);
+    } else if(arg == std::string("--save-detection")) {
+      argsOk = (detectionStateMode == IGNORE_DETECTION_STATE);
+      detectionStateMode = SAVE_DETECTION_STATE;
+    } else if(arg == std::string("--replay")) {
+      argsOk = (detectionStateMode == IGNORE_DETECTION_STATE);
+      detectionStateMode = REPLAY_DETECTION_STATE;
+    } else if(arg == std::string("--threshold") && i + 1 < argc) {
+      argsOk = detectionThresholds.empty();
+      detectionThresholds.push_back(atof(argv[++i]));
+    } else if(arg == std::string("--sweep") && i + 1 < argc) {
+      argsOk = detectionThresholds.empty()
+          && parseSweep(std::string(argv[++i]), &detectionThresholds);
+    } else if(arg == std::string("--speckle-filter") && i + 1 < argc) {
+      argsOk = parseOnOff(std::string(argv[++i]), &speckleFilter);
+    } else if(arg == std::string("--picture-filter") && i + 1 < argc) {
+      argsOk = parseOnOff(std::string(argv[++i]), &pictureFilter);
+    } else if(path == NULL) {
+      path = argv[i]; // assume anything else is the path
     } else {
-      runFinder(argv[1]); // assume given path as second arg
-      return 0;
+      argsOk = false;
     }
-  } else if(argc == 3) {
-    if(std::string(argv[1]) == std::string("-d")) {
-      runFinder(argv[2], true); // assume path is third arg
-      return 0;
+  }
+  if(argsOk && path != NULL && optionsAreCompatible(mergeShardCount > 0,
+      shardCount > 1, evalGroundtruthPath != NULL, pipelined,
+      memoryCeilingMB > 0, detectionStateMode == REPLAY_DETECTION_STATE,
+      detectionThresholds.size(),
+      speckleFilter >= 0 || pictureFilter >= 0)) {
+    if(mergeShardCount > 0) {
+      // shards are run unattended, so a failed merge has to show in the exit status
+      return runMerge(path, doJustDetection, mergeShardCount) ? 0 : 1;
+    } else {
+      runFinder(path, doJustDetection, shardIndex, shardCount, memoryCeilingMB,
+          evalGroundtruthPath, pipelined ? &pipelineConfig : NULL, targetDpi,
+          detectionStateMode, detectionThresholds, speckleFilter, pictureFilter);
     }
+    return 0;
   }
   // if gets here then input wasn't expected
   MathExpressionFinderUsage::printUsage();
@@ -71,7 +147,12 @@ void runInteractiveMenu() {
   delete mainMenu;
 }
 
-void runFinder(char* path, bool doJustDetection) {
+void runFinder(char* path, bool doJustDetection,
+    const int shardIndex, const int shardCount, const long memoryCeilingMB,
+    char* evalGroundtruthPath, const PagePipelineConfig* pipelineConfig,
+    const int targetDpi, const DetectionStateMode detectionStateMode,
+    const std::vector<double>& detectionThresholds, const int speckleFilter,
+    const int pictureFilter) {
   const std::string trainedFinderPath =
       FinderTrainingPaths::getTrainedFinderRoot();
   Utils::exec(std::string("mkdir -p ") + trainedFinderPath, true);
@@ -95,29 +176,86 @@ void runFinder(char* path, bool doJustDetection) {
 
   FinderInfo* finderInfo =
       TrainingInfoFileParser().readInfoFromFile(finderName);
+  if(speckleFilter >= 0
+      && (speckleFilter == 1) != finderInfo->isSpeckleFilterEnabled()) {
+    std::cout << "The speckle filter is turned "
+        << (speckleFilter == 1 ? "on" : "off") << " for this run, but the "
+        << "finder was trained with it " << (speckleFilter == 1 ? "off" : "on")
+        << ".\n";
+    finderInfo->setSpeckleFilterEnabled(speckleFilter == 1);
+  }
+  if(pictureFilter >= 0
+      && (pictureFilter == 1) != finderInfo->isPictureFilterEnabled()) {
+    std::cout << "The picture filter is turned "
+        << (pictureFilter == 1 ? "on" : "off") << " for this run, but the "
+        << "finder was trained with it " << (pictureFilter == 1 ? "off" : "on")
+        << ".\n";
+    finderInfo->setPictureFilterEnabled(pictureFilter == 1);
+  }
   std::string imagePath = std::string(path);
   Pixa* images = pixaCreate(0);
-  std::vector<std::string> imageNames;
+  std::vector<PageSource> allPageSources;
   // if the image path is a directory, then read in all of the files in that
-  // directory (assumes they are images)
+  // directory (assumes they are images). each page of a multi-page TIFF is
+  // a page of the run on its own (only its page headers are read for now).
   if(Utils::existsDirectory(imagePath)) {
-    std::vector<std::string> imagePaths =
+    std::vector<std::string> dirImagePaths =
         DatasetSelectionMenu::findImagePaths(imagePath);
-    for(int i = 0; i < imagePaths.size(); ++i) {
-      std::cout << "image path " << imagePaths[i] << std::endl;;
-      pixaAddPix(images,
-          Utils::leptReadAndBinarizeImg(imagePaths[i]),
-          L_INSERT);
-      imageNames.push_back(DatasetSelectionMenu::getFileNameFromPath(imagePaths[i]));
+    for(int i = 0; i < dirImagePaths.size(); ++i) {
+      PageSource::addPageSources(dirImagePaths[i], &allPageSources);
     }
   } else if(Utils::existsFile(imagePath)) {
-    pixaAddPix(images, Utils::leptReadAndBinarizeImg(imagePath), L_INSERT);
-    imageNames.push_back(DatasetSelectionMenu::getFileNameFromPath(imagePath));
+    PageSource::addPageSources(imagePath, &allPageSources);
   } else {
     std::cout << "Unable to read in the image(s) on the given path." << std::endl;
     return MathExpressionFinderUsage::printUsage();
   }
 
+  // if this is one shard of a run then only every shardCount'th page is
+  // run, starting from shardIndex
+  std::vector<PageSource> pageSources;
+  std::vector<std::string> imageNames;
+  std::vector<int> pageNumbers; // position of each page in the full run
+  bool hasTiffPages = false;
+  for(int i = 0; i < allPageSources.size(); ++i) {
+    if(i % shardCount != shardIndex) {
+      continue;
+    }
+    pageNumbers.push_back(i);
+    pageSources.push_back(allPageSources[i]);
+    imageNames.push_back(allPageSources[i].getName());
+    hasTiffPages = hasTiffPages || allPageSources[i].isTiffPage();
+    std::cout << "image path " << allPageSources[i].path;
+    if(allPageSources[i].isTiffPage()) {
+      std::cout << " page " << allPageSources[i].page;
+    }
+    std::cout << std::endl;
+  }
+
+  // A multi-page TIFF can have far too many pages for them all to be read in
+  // upfront (like they are below when not pipelined), so those always go
+  // through the pipeline. It only has a few pages in memory at a time and
+  // gets rid of each page's result images as soon as they're written.
+  // Replaying doesn't use the pipeline, so the pages are all read in then.
+  PagePipelineConfig tiffPipelineConfig;
+  if(hasTiffPages && detectionStateMode != REPLAY_DETECTION_STATE) {
+    if(pipelineConfig != NULL) {
+      tiffPipelineConfig = *pipelineConfig;
+    } else if(memoryCeilingMB > 0) {
+      std::cout << "The memory ceiling isn't checked for multi-page TIFFs since "
+          << "their pages are run through the pipeline.\n";
+    }
+    tiffPipelineConfig.releaseWrittenImages = true;
+    pipelineConfig = &tiffPipelineConfig;
+  }
+
+  // when pipelined the pipeline reads each image in as it's needed
+  if(pipelineConfig == NULL) {
+    for(int i = 0; i < pageSources.size(); ++i) {
+      pixaAddPix(images, pageSources[i].readBinarized(), L_INSERT);
+    }
+  }
+
   GeometryBasedExtractorCategory spatialCategory;
   RecognitionBasedExtractorCategory recognitionCategory;
   MathExpressionFinder* finder =
@@ -125,29 +263,147 @@ void runFinder(char* path, bool doJustDetection) {
           &spatialCategory,
           &recognitionCategory,
           finderInfo);
+  finder->setMemoryCeiling(memoryCeilingMB * 1024);
+  finder->setTargetResolution(targetDpi);
+
+  std::string resultsDirName = getResultsNameFromPath(imagePath);
+  if(doJustDetection) {
+    resultsDirName = resultsDirName + "_detection_only";
+  }
+  if(shardCount > 1) {
+    resultsDirName = MathExpressionFinderResults::getShardResultsDirName(
+        resultsDirName, shardIndex, shardCount);
+  }
+  // Get rid of an earlier run's results up front, since the pipeline starts
+  // writing result images as soon as the first page is done
+  if(!MathExpressionFinderResults::clearResultsDir(resultsDirName, imagePath)) {
+    pixaDestroy(&images);
+    delete finder;
+    delete finderInfo;
+    return;
+  }
+
+  // the states are kept by page name, so every shard (and a detection only
+  // run) can share the same directory
+  const std::string detectionStateDirName =
+      getResultsNameFromPath(imagePath) + "_detection_state";
+  if(detectionStateMode == SAVE_DETECTION_STATE) {
+    finder->setDetectionStateDir(detectionStateDirName);
+  }
+
+  // the evaluation metrics are cached with the finder since the results
+  // directory is cleared out on every run (see Evaluator)
+  const std::string metricsCacheDirName = Utils::checkTrailingSlash(
+      finderInfo->getFinderTrainingPaths()->getTrainingDirPath()) + "metricsCache";
+
+  // a sweep evaluates and gets rid of the results at each threshold itself
+  if(detectionThresholds.size() > 1) {
+    runThresholdSweep(finder, doJustDetection ? DETECT : FIND, images,
+        imageNames, detectionStateDirName, resultsDirName,
+        std::string(evalGroundtruthPath), metricsCacheDirName,
+        detectionThresholds);
+    pixaDestroy(&images);
+    delete finder;
+    delete finderInfo;
+    return;
+  }
 
   std::vector<MathExpressionFinderResults*> results;
-  if(!doJustDetection) {
+  if(detectionStateMode == REPLAY_DETECTION_STATE) {
+    results = finder->replayFromDetectionState(doJustDetection ? DETECT : FIND,
+        images, imageNames, detectionStateDirName,
+        detectionThresholds.empty() ? NULL : &detectionThresholds[0]);
+  } else if(pipelineConfig != NULL) {
+    // the pipeline writes each page's result images as soon as it's done
+    // (none are written when evaluating), the results file is written below
+    results = finder->getResultsPipelined(doJustDetection ? DETECT : FIND,
+        pageSources, imageNames, *pipelineConfig,
+        (evalGroundtruthPath != NULL) ? std::string("") : resultsDirName,
+        (evalGroundtruthPath != NULL) ? images : NULL);
+  } else if(!doJustDetection) {
     results = finder->findMathExpressions(images, imageNames);
   } else {
     results = finder->detectMathExpressions(images, imageNames);
   }
 
+  // Evaluate the results against the groundtruth while they're still in
+  // memory rather than writing them out for the evaluator to read back in.
+  // Only the metrics (and the memory stats) are written in this mode.
+  if(evalGroundtruthPath != NULL) {
+    Evaluator(resultsDirName, std::string(evalGroundtruthPath), false,
+        metricsCacheDirName).evaluateInMemory(results, images);
+  }
+
   pixaDestroy(&images); // destroy finished image(s)
 
-  // Display the results
-  for(int i = 0; i < results.size(); ++i) {
-    results[i]->displaySegmentationResults();
+  // Pages that went over the memory ceiling were skipped, so only the
+  // page numbers of the ones that finished go with the results (there are no
+  // memory stats for a pipelined run, which leaves out the pages that failed)
+  std::vector<PageMemoryStats>& memoryStats = finder->getMemoryStats();
+  std::vector<int> finishedPageNumbers;
+  if(memoryStats.empty()) {
+    const std::vector<int>& failedPages = finder->getPipelineFailedPages();
+    for(int i = 0; i < pageNumbers.size(); ++i) {
+      if(std::find(failedPages.begin(), failedPages.end(), i) == failedPages.end()) {
+        finishedPageNumbers.push_back(pageNumbers[i]);
+      }
+    }
+  }
+  for(int i = 0; i < memoryStats.size(); ++i) {
+    if(!memoryStats[i].isFailed()) {
+      finishedPageNumbers.push_back(pageNumbers[i]);
+    } else {
+      std::cout << "No results for " << memoryStats[i].getPageName()
+          << " since it went over the memory ceiling.\n";
+    }
+  }
+
+  // Display the results (not for shards since they're meant to be run
+  // unattended, or for multi-page TIFFs whose result images are already gone)
+  if(shardCount == 1 && evalGroundtruthPath == NULL && !hasTiffPages) {
+    for(int i = 0; i < results.size(); ++i) {
+      results[i]->displaySegmentationResults();
+    }
   }
 
   // Write the results to a directory in the current location (creates
   // the directory)
-  std::string resultsDirName = getResultsNameFromPath(imagePath);
-  if(doJustDetection) {
-    resultsDirName = resultsDirName + "_detection_only";
+  if(evalGroundtruthPath != NULL) {
+    std::cout << "The evaluation metrics were written to "
+        << Utils::checkTrailingSlash(resultsDirName) << "eval/metrics\n";
+  } else if(shardCount == 1) {
+    MathExpressionFinderResults::printResultsToFiles(results,
+        resultsDirName, pipelineConfig == NULL);
+  } else {
+    MathExpressionFinderResults::printShardResultsToFiles(results,
+        finishedPageNumbers, resultsDirName, shardIndex, shardCount,
+        pipelineConfig == NULL);
+  }
+
+  // Write out the memory used by each stage of each page alongside the results
+  Utils::exec(std::string("mkdir -p ") + resultsDirName);
+  if(pipelineConfig == NULL) {
+    PageMemoryStats::writeStatsFile(memoryStats,
+        Utils::checkTrailingSlash(resultsDirName) + "memory_stats.tsv");
+  }
+
+  // and how each page's resolution was normalized (compare the time taken and,
+  // with --eval, the metrics to a run without it to see what it trades off)
+  if(targetDpi > 0) {
+    ResolutionNormalizer::writeReportFile(finder->getResolutionStats(),
+        Utils::checkTrailingSlash(resultsDirName) + "resolution_stats.tsv");
+  }
+
+  // along with how well the dictionary/stopword/math word lookups were cached
+  std::cout << "Word lookup cache:\n";
+  WordClassificationCache::getInstance().printStats(std::cout);
+  WordClassificationCache::getInstance().writeStatsFile(
+      Utils::checkTrailingSlash(resultsDirName) + "word_cache_stats.tsv");
+
+  // and the detector's predictions (there weren't any if it was replayed)
+  if(detectionStateMode != REPLAY_DETECTION_STATE) {
+    finder->getDetector()->writeStats(resultsDirName);
   }
-  MathExpressionFinderResults::printResultsToFiles(results,
-      resultsDirName);
 
   // Destroy results
   for(int i = 0; i < results.size(); ++i) {
@@ -159,6 +415,176 @@ void runFinder(char* path, bool doJustDetection) {
   delete finderInfo;
 }
 
+bool runMerge(char* path, bool doJustDetection, const int shardCount) {
+  std::string resultsDirName = getResultsNameFromPath(std::string(path));
+  if(doJustDetection) {
+    resultsDirName = resultsDirName + "_detection_only";
+  }
+  if(!MathExpressionFinderResults::clearResultsDir(resultsDirName,
+      std::string(path))) {
+    return false;
+  }
+  return MathExpressionFinderResults::mergeShardResults(resultsDirName, shardCount);
+}
+
+bool optionsAreCompatible(const bool merging, const bool sharded,
+    const bool evaluating, const bool pipelined, const bool memoryCeiling,
+    const bool replaying, const int thresholdCount, const bool filtering) {
+  if(merging && (sharded || evaluating || pipelined || replaying)) {
+    std::cout << "ERROR: --merge only merges the results of the shards, so it "
+        << "can't be used with --shard, --eval, --pipeline or --replay.\n";
+    return false;
+  }
+  if(evaluating && sharded) {
+    std::cout << "ERROR: --eval can't be used with --shard since only the "
+        << "metrics would be written, which can't be merged.\n";
+    return false;
+  }
+  if(pipelined && memoryCeiling) {
+    std::cout << "ERROR: --max-rss-mb can't be used with --pipeline since the "
+        << "pages in the pipeline share the process's memory.\n";
+    return false;
+  }
+  if(replaying && pipelined) {
+    std::cout << "ERROR: --replay can't be used with --pipeline since replaying "
+        << "only runs segmentation.\n";
+    return false;
+  }
+  if(thresholdCount > 0 && !replaying) {
+    std::cout << "ERROR: --threshold and --sweep need --replay since the blobs "
+        << "are detected again from the scores saved by --save-detection.\n";
+    return false;
+  }
+  if(filtering && (merging || replaying)) {
+    std::cout << "ERROR: --speckle-filter and --picture-filter can't be used "
+        << "with --merge or --replay since neither of them builds any grids.\n";
+    return false;
+  }
+  if(thresholdCount > 1 && !evaluating) {
+    std::cout << "ERROR: --sweep needs --eval to evaluate the results at each "
+        << "threshold.\n";
+    return false;
+  }
+  return true;
+}
+
+void runThresholdSweep(MathExpressionFinder* const finder,
+    const RunMode runMode, Pixa* const images,
+    const std::vector<std::string>& imageNames,
+    const std::string& detectionStateDirName, const std::string& resultsDirName,
+    const std::string& evalGroundtruthPath,
+    const std::string& metricsCacheDirName,
+    const std::vector<double>& detectionThresholds) {
+  Utils::exec(std::string("mkdir -p ") + resultsDirName);
+  const std::string sweepPath =
+      Utils::checkTrailingSlash(resultsDirName) + "threshold_sweep.tsv";
+  std::ofstream sweepStream(sweepPath.c_str());
+  if(!sweepStream.is_open()) {
+    std::cout << "ERROR: Could not open " << sweepPath << " to write the threshold sweep to\n";
+    assert(false);
+    return;
+  }
+  sweepStream << "threshold\tresult_type\trecall\tprecision\tfallout\t"
+      << "correct_ratio\tmissed_ratio\tfalse_regions\n";
+  for(int i = 0; i < detectionThresholds.size(); ++i) {
+    std::ostringstream threshold;
+    threshold << detectionThresholds[i];
+    std::cout << "Replaying at detection threshold " << threshold.str() << ".\n";
+    std::vector<MathExpressionFinderResults*> results =
+        finder->replayFromDetectionState(runMode, images, imageNames,
+            detectionStateDirName, &detectionThresholds[i]);
+    const std::vector<DatasetMetrics> metrics = Evaluator(
+        Utils::checkTrailingSlash(resultsDirName) + "threshold_" + threshold.str(),
+        evalGroundtruthPath, false, metricsCacheDirName)
+        .evaluateInMemory(results, images);
+    for(int j = 0; j < metrics.size(); ++j) {
+      sweepStream << threshold.str() << "\t" << metrics[j].res_type_name << "\t"
+          << metrics[j].TPR << "\t" << metrics[j].PPV << "\t" << metrics[j].FPR
+          << "\t" << metrics[j].avg_correct_ratio << "\t"
+          << metrics[j].avg_missed_ratio << "\t" << metrics[j].avg_false_regions
+          << "\n";
+    }
+    sweepStream.flush(); // so a long sweep can be followed as it goes
+    for(int j = 0; j < results.size(); ++j) {
+      delete results[j];
+    }
+  }
+  std::cout << "The recall and precision at each threshold were written to "
+      << sweepPath << "\n";
+}
+
+bool parseSweep(const std::string& arg,
+    std::vector<double>* const detectionThresholds) {
+  const std::vector<std::string> parts = Utils::stringSplit(arg, ':');
+  if(parts.size() != 3) {
+    return false;
+  }
+  const double low = atof(parts[0].c_str());
+  const double high = atof(parts[1].c_str());
+  const double step = atof(parts[2].c_str());
+  if(!(step > 0) || !(low <= high)) {
+    return false;
+  }
+  // counted rather than accumulated so the last threshold isn't lost to
+  // rounding error
+  const int count = (int)((high - low) / step + 1e-9) + 1;
+  for(int i = 0; i < count; ++i) {
+    detectionThresholds->push_back(low + i * step);
+  }
+  return true;
+}
+
+bool parseShard(const std::string& arg, int* const shardIndex,
+    int* const shardCount) {
+  const size_t slashIndex = arg.find('/');
+  if(slashIndex == std::string::npos || slashIndex == 0
+      || slashIndex == arg.size() - 1) {
+    return false;
+  }
+  *shardIndex = atoi(arg.substr(0, slashIndex).c_str());
+  *shardCount = atoi(arg.substr(slashIndex + 1).c_str());
+  return *shardCount > 0 && *shardIndex >= 0 && *shardIndex < *shardCount;
+}
+
+bool parseOnOff(const std::string& arg, int* const value) {
+  if(arg == std::string("on")) {
+    *value = 1;
+  } else if(arg == std::string("off")) {
+    *value = 0;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool parsePipeline(const std::string& arg,
+    PagePipelineConfig* const pipelineConfig) {
+  std::vector<int> counts;
+  size_t start = 0;
+  while(start <= arg.size()) {
+    size_t commaIndex = arg.find(',', start);
+    if(commaIndex == std::string::npos) {
+      commaIndex = arg.size();
+    }
+    const int count = atoi(arg.substr(start, commaIndex - start).c_str());
+    if(count <= 0) {
+      return false;
+    }
+    counts.push_back(count);
+    start = commaIndex + 1;
+  }
+  if(counts.size() < 3 || counts.size() > 4) {
+    return false;
+  }
+  pipelineConfig->readWorkers = counts[0];
+  pipelineConfig->gridWorkers = counts[1];
+  pipelineConfig->writeWorkers = counts[2];
+  if(counts.size() == 4) {
+    pipelineConfig->queueSize = counts[3];
+  }
+  return true;
+}
+
 std::string getResultsNameFromPath(std::string path) {
   if(Utils::existsDirectory(path)) {
     if(path.at(path.size() - 1) == '/') {
@@ -8,15 +8,113 @@
 #ifndef MATHEXPRESSIONFINDERMAIN_H_
 #define MATHEXPRESSIONFINDERMAIN_H_
 
+#include <PagePipeline.h>
+#include <MFinderResults.h>
+
+#include <allheaders.h>
+
 #include <string>
+#include <vector>
+
+class MathExpressionFinder;
 
 void runInteractiveMenu();
 
-void runFinder(char* path, bool doJustDetection=false);
+// Whether the detection state of each page is saved once detection is done on
+// it, or segmentation is replayed from the states saved by an earlier run
+// instead of running everything before it again (see DetectionState)
+enum DetectionStateMode {
+  IGNORE_DETECTION_STATE,
+  SAVE_DETECTION_STATE,
+  REPLAY_DETECTION_STATE
+};
+
+// Runs the finder on the image(s) at the given path. When shardCount is more
+// than one, only the pages whose position in the directory listing is
+// shardIndex modulo shardCount are run and their results are printed to the
+// shard's own directory (see runMerge). Pages that need more than
+// memoryCeilingMB (if more than 0) on top of what the process was already
+// using are skipped. The memory used by each
+// stage of each page is written to memory_stats.tsv in the results directory.
+// If a groundtruth path is given then the results are evaluated against it in
+// memory and only the metrics are written (see Evaluator::evaluateInMemory).
+// Each page's metrics are cached in the trained finder's directory so pages
+// whose results haven't changed aren't evaluated again on the next run.
+// If a pipeline config is given then the pages are run through a PagePipeline
+// with those worker counts instead of one after the other, in which case no
+// memory stats are written and there's no memory ceiling. If a target
+// resolution (in dpi) is given then pages well over it are reduced to it
+// before they're processed (see ResolutionNormalizer) and the resolution each
+// page was estimated at and processed at (along with how long it took) is
+// written to resolution_stats.tsv in the results directory. Every page of a
+// multi-page TIFF is run as a page of its own, named after the file and its
+// page index (see PageSource), and is read in only when it's needed. Runs with
+// multi-page TIFFs always go through a PagePipeline (with one worker per stage
+// if no config is given) and their result images aren't displayed. The
+// detection states of the pages are saved to or replayed from a directory
+// named after the path with _detection_state on the end, which is shared by
+// all of the shards of a run. Replaying runs at most segmentation, so it can't
+// be done with a pipeline config, and every page (including each page of a
+// multi-page TIFF) is read in upfront. If a detection threshold is given when
+// replaying then the blobs are detected again at it from their saved scores.
+// If more than one is given then the run is a threshold sweep, which needs a
+// groundtruth path: the results at each threshold are evaluated in memory and
+// their metrics written to threshold_<threshold>/eval/metrics in the results
+// directory, with the recall and precision at each threshold summarized in
+// threshold_sweep.tsv there. Nothing else is written for a sweep. A speckle
+// or picture filter setting of 1 or 0 turns that filter on or off for the run
+// in place of the trained finder's setting (see FinderInfo), -1 keeps it.
+void runFinder(char* path, bool doJustDetection=false,
+    const int shardIndex=0, const int shardCount=1,
+    const long memoryCeilingMB=0, char* evalGroundtruthPath=NULL,
+    const PagePipelineConfig* pipelineConfig=NULL,
+    const int targetDpi=0,
+    const DetectionStateMode detectionStateMode=IGNORE_DETECTION_STATE,
+    const std::vector<double>& detectionThresholds=std::vector<double>(),
+    const int speckleFilter=-1, const int pictureFilter=-1);
+
+// Merges the results printed by all of the shards of a sharded run on the
+// given path into the same results a single run would have printed. Returns
+// false if any of the shards' results are missing or incomplete.
+bool runMerge(char* path, bool doJustDetection, const int shardCount);
+
+// Checks that the options given on the command line can be used together,
+// printing what's wrong with them if not
+static bool optionsAreCompatible(const bool merging, const bool sharded,
+    const bool evaluating, const bool pipelined, const bool memoryCeiling,
+    const bool replaying, const int thresholdCount, const bool filtering);
 
 // Runs trainer in isolation (for debug/experiment purposes)
 static void runTrainer();
 
 static std::string getResultsNameFromPath(std::string path);
 
+// Replays the pages at each of the thresholds and evaluates the results (see
+// runFinder)
+static void runThresholdSweep(MathExpressionFinder* const finder,
+    const RunMode runMode, Pixa* const images,
+    const std::vector<std::string>& imageNames,
+    const std::string& detectionStateDirName, const std::string& resultsDirName,
+    const std::string& evalGroundtruthPath,
+    const std::string& metricsCacheDirName,
+    const std::vector<double>& detectionThresholds);
+
+// Parses a shard argument of the form i/N (0 <= i < N), returns false if invalid
+static bool parseShard(const std::string& arg, int* const shardIndex,
+    int* const shardCount);
+
+// Parses an argument of on or off into 1 or 0, returns false if invalid
+static bool parseOnOff(const std::string& arg, int* const value);
+
+// Parses a pipeline argument of the form R,G,W or R,G,W,Q giving the number
+// of read, Tesseract, and write workers (and optionally the queue size), all
+// more than 0. Returns false if invalid.
+static bool parsePipeline(const std::string& arg,
+    PagePipelineConfig* const pipelineConfig);
+
+// Parses a sweep argument of the form LO:HI:STEP (LO <= HI, STEP > 0) into
+// the thresholds from LO to HI, returns false if invalid
+static bool parseSweep(const std::string& arg,
+    std::vector<double>* const detectionThresholds);
+
 #endif /* MATHEXPRESSIONFINDERMAIN_H_ */
@@ -32,10 +32,14 @@ FinderInfo::FinderInfo(
     std::string groundtruthDirPath,
     std::string groundtruthFileName,
     std::string description,
-    std::vector<std::string> groundtruthImagePaths)
+    std::vector<std::string> groundtruthImagePaths,
+    bool speckleFilterEnabled,
+    bool pictureFilterEnabled)
 : finderTrainingPaths(NULL), finderName(""), detectorName(""),
   segmentorName(""), groundtruthName(""), groundtruthDirPath(""),
-  groundtruthFilePath(""), description("") {
+  groundtruthFilePath(""), description(""),
+  speckleFilterEnabled(speckleFilterEnabled),
+  pictureFilterEnabled(pictureFilterEnabled) {
   this->finderName = finderName;
   this->finderTrainingPaths = finderTrainingPaths;
   this->featureExtractorUniqueNames = featureExtractorUniqueNames;
@@ -118,6 +122,30 @@ std::vector<std::string> FinderInfo::getGroundtruthImagePaths() {
   return groundtruthImagePaths;
 }
 
+bool FinderInfo::isSpeckleFilterEnabled() {
+  return speckleFilterEnabled;
+}
+
+void FinderInfo::setSpeckleFilterEnabled(const bool enabled) {
+  speckleFilterEnabled = enabled;
+}
+
+bool FinderInfo::isPictureFilterEnabled() {
+  return pictureFilterEnabled;
+}
+
+void FinderInfo::setPictureFilterEnabled(const bool enabled) {
+  pictureFilterEnabled = enabled;
+}
+
+BlobDataGridFactory FinderInfo::getGridFactory() {
+  SpeckleFilterParams speckleParams;
+  speckleParams.enabled = speckleFilterEnabled;
+  PictureFilterParams pictureParams;
+  pictureParams.enabled = pictureFilterEnabled;
+  return BlobDataGridFactory(speckleParams, pictureParams);
+}
+
 void FinderInfo::displayInformation() {
   // Temporarily create the math finder so I can get the info from it
   GeometryBasedExtractorCategory spatialCategory;
@@ -144,6 +172,8 @@ void FinderInfo::displayInformation() {
   std::cout << "Detector name: " << getDetectorName() << std::endl;
   std::cout << "Segmentor name: " << getSegmentorName() << std::endl;
   std::cout << "Groundtruth path: " << getGroundtruthDirPath() << std::endl;
+  std::cout << "Speckle filter: " << (speckleFilterEnabled ? "on" : "off") << std::endl;
+  std::cout << "Picture filter: " << (pictureFilterEnabled ? "on" : "off") << std::endl;
   std::cout << "Description: " << getDescription() << std::endl;
 
   delete mathFinder; // done so deallocate
@@ -151,6 +181,10 @@ void FinderInfo::displayInformation() {
 
 // Builder Stuff
 
+FinderInfoBuilder::FinderInfoBuilder()
+: finderTrainingPaths(NULL), speckleFilterEnabled(false),
+  pictureFilterEnabled(false) {}
+
 FinderInfoBuilder* FinderInfoBuilder
 ::setFinderName(std::string finderName) {
   this->finderName = finderName;
@@ -214,6 +248,18 @@ FinderInfoBuilder* FinderInfoBuilder
   return this;
 }
 
+FinderInfoBuilder* FinderInfoBuilder
+::setSpeckleFilterEnabled(bool speckleFilterEnabled) {
+  this->speckleFilterEnabled = speckleFilterEnabled;
+  return this;
+}
+
+FinderInfoBuilder* FinderInfoBuilder
+::setPictureFilterEnabled(bool pictureFilterEnabled) {
+  this->pictureFilterEnabled = pictureFilterEnabled;
+  return this;
+}
+
 std::string FinderInfoBuilder::getFinderName() {
   return finderName;
 }
@@ -244,6 +290,12 @@ std::string FinderInfoBuilder::getDescription() {
 std::vector<std::string> FinderInfoBuilder::getGroundtruthImagePaths() {
   return groundtruthImagePaths;
 }
+bool FinderInfoBuilder::isSpeckleFilterEnabled() {
+  return speckleFilterEnabled;
+}
+bool FinderInfoBuilder::isPictureFilterEnabled() {
+  return pictureFilterEnabled;
+}
 
 FinderInfo::~FinderInfo() {
   delete finderTrainingPaths;
@@ -272,6 +324,8 @@ FinderInfo* FinderInfoBuilder::build() {
       groundtruthDirPath,
       groundtruthFilePath,
       description,
-      groundtruthImagePaths);
+      groundtruthImagePaths,
+      speckleFilterEnabled,
+      pictureFilterEnabled);
 }
 
@@ -10,6 +10,8 @@
 
 #include <FinderTrainingPaths.h>
 
+#include <BlobDataGridFactory.h>
+
 #include <vector>
 #include <string>
 
@@ -27,7 +29,9 @@ class FinderInfo {
       std::string groundtruthDirPath,
       std::string groundtruthFileName,
       std::string description,
-      std::vector<std::string> groundtruthImagePaths);
+      std::vector<std::string> groundtruthImagePaths,
+      bool speckleFilterEnabled,
+      bool pictureFilterEnabled);
 
   ~FinderInfo();
 
@@ -86,6 +90,41 @@ class FinderInfo {
    */
   std::vector<std::string> getGroundtruthImagePaths();
 
+  /**
+   * Whether speckle and other noise is left off of the grids of this Finder's
+   * pages (see SpeckleFilter). Set when the Finder is trained, since the
+   * features only mean the same thing if the grids for training and for
+   * finding are built the same way. Off for Finders trained before it could
+   * be set.
+   */
+  bool isSpeckleFilterEnabled();
+
+  /**
+   * Overrides the speckle filter setting for this run only (it isn't written
+   * back to the info file)
+   */
+  void setSpeckleFilterEnabled(const bool enabled);
+
+  /**
+   * Whether the components within photographs, halftones and other pictures
+   * are left off of the grids of this Finder's pages and hidden from
+   * Tesseract (see PictureFilter). Set when the Finder is trained just like
+   * the speckle filter, and off for Finders trained before it could be set.
+   */
+  bool isPictureFilterEnabled();
+
+  /**
+   * Overrides the picture filter setting for this run only (it isn't written
+   * back to the info file)
+   */
+  void setPictureFilterEnabled(const bool enabled);
+
+  /**
+   * Gets a factory that builds the grids of this Finder's pages with its
+   * filter settings
+   */
+  BlobDataGridFactory getGridFactory();
+
   void displayInformation();
 
  private:
@@ -99,12 +138,16 @@ class FinderInfo {
   std::string groundtruthFilePath;
   std::string description;
   std::vector<std::string> groundtruthImagePaths;
+  bool speckleFilterEnabled;
+  bool pictureFilterEnabled;
 };
 
 class FinderInfoBuilder {
 
  public:
 
+  FinderInfoBuilder();
+
   FinderInfoBuilder* setFinderName(std::string finderName);
 
   FinderInfoBuilder* setFinderTrainingPaths(FinderTrainingPaths* const finderTraininPaths);
@@ -125,6 +168,10 @@ class FinderInfoBuilder {
 
   FinderInfoBuilder* setGroundtruthImagePaths(std::vector<std::string> trainingImagePaths);
 
+  FinderInfoBuilder* setSpeckleFilterEnabled(bool speckleFilterEnabled);
+
+  FinderInfoBuilder* setPictureFilterEnabled(bool pictureFilterEnabled);
+
   std::string getFinderName();
   FinderTrainingPaths* getFinderTrainingPaths();
   std::vector<std::string> getFeatureExtractorUniqueNames();
@@ -135,6 +182,8 @@ class FinderInfoBuilder {
   std::string getGroundtruthFilePath();
   std::string getDescription();
   std::vector<std::string> getGroundtruthImagePaths();
+  bool isSpeckleFilterEnabled();
+  bool isPictureFilterEnabled();
 
 
   /**
@@ -154,6 +203,8 @@ class FinderInfoBuilder {
   std::string groundtruthFilePath;
   std::string description;
   std::vector<std::string> groundtruthImagePaths;
+  bool speckleFilterEnabled;
+  bool pictureFilterEnabled;
 };
 
 #endif /* FINDERINFO_H_ */
@@ -24,7 +24,9 @@ TrainingInfoFileParser::TrainingInfoFileParser()
   groundtruthDirPathKey("GroundtruthDirPath"),
   groundtruthFilePathKey("GroundtruthFilePath"),
   featureExtractorsKey("Feature extractors"),
-  groundtruthImagePathsKey("GroundtruthImagePaths") {}
+  groundtruthImagePathsKey("GroundtruthImagePaths"),
+  speckleFilterKey("Speckle filter"),
+  pictureFilterKey("Picture filter") {}
 
 bool TrainingInfoFileParser::writeInfoToFile(FinderInfo* const finderInfo) {
 
@@ -68,6 +70,10 @@ bool TrainingInfoFileParser::writeInfoToFile(FinderInfo* const finderInfo) {
     outStream << finderInfo->getFeatureExtractorUniqueNames()[i] << " ";
   }
   outStream << std::endl;
+  outStream << speckleFilterKey << ": "
+      << (finderInfo->isSpeckleFilterEnabled() ? "on" : "off") << std::endl;
+  outStream << pictureFilterKey << ": "
+      << (finderInfo->isPictureFilterEnabled() ? "on" : "off") << std::endl;
   outStream.close();
   return true;
 }
@@ -138,6 +144,16 @@ FinderInfo* TrainingInfoFileParser::readInfoFromFile(std::string finderName) {
     } else if(key == featureExtractorsKey) {
       assertLineNumber(lineNumber++, 8, infoFilePath);
       builder.setFeatureExtractorUniqueNames(Utils::stringSplit(value, ' '));
+    } else if(key == speckleFilterKey) {
+      // not in the files of Finders trained before it could be set, which
+      // were trained without the filter
+      assertLineNumber(lineNumber++, 9, infoFilePath);
+      value = Utils::removeEmpty(value);
+      builder.setSpeckleFilterEnabled(value == "on");
+    } else if(key == pictureFilterKey) {
+      assertLineNumber(lineNumber++, 10, infoFilePath);
+      value = Utils::removeEmpty(value);
+      builder.setPictureFilterEnabled(value == "on");
     } else {
       std::cout << "ERROR: Unexpected input from file at " << infoFilePath << std::endl;
       assert(false);
@@ -44,6 +44,8 @@ class TrainingInfoFileParser {
   const std::string groundtruthFilePathKey;
   const std::string featureExtractorsKey;
   const std::string groundtruthImagePathsKey;
+  const std::string speckleFilterKey;
+  const std::string pictureFilterKey;
 };
 
 
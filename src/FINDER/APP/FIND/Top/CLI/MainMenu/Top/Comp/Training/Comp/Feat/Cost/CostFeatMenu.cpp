@@ -0,0 +1,147 @@
+/*
+ * CostFeatMenu.cpp
+ */
+
+#include <CostFeatMenu.h>
+
+#include <FeatSelMenuMain.h>
+#include <SpatialMenu.h>
+#include <RecMenu.h>
+#include <TrainingMenu.h>
+#include <NameMenu.h>
+#include <DatasetMenu.h>
+#include <DoTrainingMenu.h>
+
+#include <FeatCostSel.h>
+#include <FinderInfo.h>
+#include <FinderTrainingPaths.h>
+#include <FTPathsFactory.h>
+#include <BlobFeatExtFac.h>
+#include <Utils.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+
+CostFeatMenu::CostFeatMenu(SpatialFeatureMenu* const spatialMenu,
+    RecognitionFeatureMenu* const recMenu,
+    TrainingMenu* const trainingMenu,
+    FeatureSelectionMenuMain* const back) {
+  subMenus.push_back(back);
+  this->spatialMenu = spatialMenu;
+  this->recMenu = recMenu;
+  this->trainingMenu = trainingMenu;
+}
+
+std::string CostFeatMenu::getName() const {
+  return "Choose features by accuracy and extraction time";
+}
+
+void CostFeatMenu::doTask() {
+
+  // The features are timed and evaluated on the groundtruth being trained on
+  NameSelectionMenu* const nameMenu = trainingMenu->getNameSelectionMenu();
+  DatasetSelectionMenu* const datasetMenu = trainingMenu->getDatasetSelectionMenu();
+  while(nameMenu->getFinderName() == "") {
+    nameMenu->promptSetFinderName();
+  }
+  if(!datasetMenu->isComplete()) {
+    datasetMenu->doTask();
+    if(!datasetMenu->isComplete()) {
+      return;
+    }
+  }
+  FinderInfo* finderInfo = FinderInfoBuilder().setFinderName(nameMenu->getFinderName())
+      ->setGroundtruthName(datasetMenu->getGroundtruthName())
+      ->setGroundtruthDirPath(datasetMenu->getGroundtruthDirPath())
+      ->setGroundtruthFilePath(datasetMenu->getGroundtruthFilePath())
+      ->setFinderTrainingPaths(FinderTrainingPathsFactory().createFinderTrainingPaths(
+          nameMenu->getFinderName()))
+      ->setGroundtruthImagePaths(datasetMenu->getGroundtruthImagePaths())
+      ->build();
+
+  const int pageCount = (int)promptNumber(
+      "How many of the groundtruth pages should each feature be timed on? "
+      "The features are extracted from scratch on every page for every "
+      "feature, so a handful of pages is usually enough.",
+      1, finderInfo->getGroundtruthImagePaths().size());
+  const double minAccuracy = promptNumber(
+      "What is the lowest acceptable detection accuracy (the mean of the "
+      "accuracy on math and non-math blobs, between 0 and 1)?", 0, 1);
+
+  // Measure all of the features with all of their flags
+  std::vector<BlobFeatureExtractorFactory*> allFactories = spatialMenu->getAllFactories();
+  const std::vector<BlobFeatureExtractorFactory*> recFactories = recMenu->getAllFactories();
+  allFactories.insert(allFactories.end(), recFactories.begin(), recFactories.end());
+  CostAwareFeatureSelector selector(finderInfo, allFactories);
+  selector.measureUnits(pageCount);
+  selector.findParetoFront(3);
+  selector.printReport(std::cout);
+
+  // Keep a copy of the report with the Finder's training files
+  const std::string trainingDir =
+      finderInfo->getFinderTrainingPaths()->getTrainingDirPath();
+  if(!Utils::existsDirectory(trainingDir)) {
+    Utils::exec(std::string("mkdir -p ") + trainingDir);
+  }
+  const std::string reportPath = Utils::checkTrailingSlash(trainingDir) + "FeatureCost";
+  std::ofstream reportStream(reportPath.c_str());
+  selector.printReport(reportStream);
+  reportStream.close();
+  std::cout << "The report was saved to " << reportPath << ".\n";
+
+  // Pick the fastest selection that meets the accuracy bar (or let the user pick)
+  const std::vector<FeatureSubsetPoint>& front = selector.getParetoFront();
+  if(front.empty()) {
+    std::cout << "None of the features improved the accuracy, so the selection "
+        << "was left as is.\n";
+    delete finderInfo;
+    return;
+  }
+  int frontIndex = selector.getFastestMeetingAccuracy(minAccuracy);
+  if(frontIndex == -1) {
+    std::cout << "None of the selections reached an accuracy of " << minAccuracy
+        << ". ";
+    frontIndex = front.size() - 1;
+  }
+  std::cout << "Selection [" << frontIndex << "] is the fastest one meeting the accuracy "
+      << "bar. Use it? If you answer no then you can pick another one from the front. ";
+  if(!Utils::promptYesNo()) {
+    std::vector<std::string> options;
+    for(int i = 0; i < front.size(); ++i) {
+      options.push_back(Utils::doubleToString(front[i].secondsPerPage * 1000., 3) +
+          " ms/page, accuracy " + Utils::doubleToString(front[i].getAccuracy(), 3));
+    }
+    frontIndex = Utils::promptSelectStrFromLabeledMatrix(options, 1);
+  }
+
+  // Hand the selection over to the menus so that it's used for training
+  const std::vector<BlobFeatureExtractorFactory*> selection =
+      selector.applyFrontPoint(frontIndex);
+  spatialMenu->setSelection(selection);
+  recMenu->setSelection(selection);
+  std::cout << "The following feature extractors (and flags) have been selected "
+      << "and will be written to the Finder's info file when it's trained:\n";
+  const std::vector<std::string> uniqueNames =
+      DoTrainingMenu::getFeatureExtractorUniqueNames(selection);
+  for(int i = 0; i < uniqueNames.size(); ++i) {
+    std::cout << uniqueNames[i] << std::endl;
+  }
+  delete finderInfo;
+}
+
+double CostFeatMenu::promptNumber(const std::string& promptText,
+    const double min, const double max) {
+  while(true) {
+    std::cout << promptText << " ";
+    std::string input;
+    Utils::getline(input);
+    const double value = atof(input.c_str());
+    if(input != "" && value >= min && value <= max) {
+      return value;
+    }
+    std::cout << "Please enter a number between " << min << " and " << max << ".\n";
+  }
+}
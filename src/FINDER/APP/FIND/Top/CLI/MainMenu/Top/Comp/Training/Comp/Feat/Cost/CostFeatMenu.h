@@ -0,0 +1,49 @@
+/*
+ * CostFeatMenu.h
+ */
+
+#ifndef COSTFEATMENU_H_
+#define COSTFEATMENU_H_
+
+#include <MenuBase.h>
+
+#include <string>
+
+class FeatureSelectionMenuMain;
+class SpatialFeatureMenu;
+class RecognitionFeatureMenu;
+class TrainingMenu;
+
+/**
+ * Selects the features automatically by measuring how long each one takes
+ * to extract and how much it helps the detection accuracy on the chosen
+ * groundtruth (see CostAwareFeatureSelector). The fastest selection meeting
+ * an accuracy bar is picked and handed to the spatial and recognition menus
+ * so that it gets used for training.
+ */
+class CostFeatMenu : public virtual MenuBase {
+
+ public:
+
+  CostFeatMenu(SpatialFeatureMenu* const spatialMenu,
+      RecognitionFeatureMenu* const recMenu,
+      TrainingMenu* const trainingMenu,
+      FeatureSelectionMenuMain* const back);
+
+  std::string getName() const;
+
+  void doTask();
+
+ private:
+
+  // prompts until a number in the given range is entered
+  double promptNumber(const std::string& promptText,
+      const double min, const double max);
+
+  SpatialFeatureMenu* spatialMenu;
+  RecognitionFeatureMenu* recMenu;
+  TrainingMenu* trainingMenu;
+};
+
+
+#endif /* COSTFEATMENU_H_ */
@@ -129,6 +129,26 @@ void FeatureSelectionMenuBase::selectAllFactories() {
   }
 }
 
+std::vector<BlobFeatureExtractorFactory*> FeatureSelectionMenuBase::getAllFactories() {
+  return getCategory()->getFeatureExtractorFactories();
+}
+
+void FeatureSelectionMenuBase::setSelection(
+    const std::vector<BlobFeatureExtractorFactory*>& factories) {
+  const std::vector<BlobFeatureExtractorFactory*> allFactories =
+      getCategory()->getFeatureExtractorFactories();
+  std::vector<BlobFeatureExtractorFactory*>& selectedFactories = getSelectedFactories();
+  selectedFactories.clear();
+  for(int i = 0; i < factories.size(); ++i) {
+    for(int j = 0; j < allFactories.size(); ++j) {
+      if(factories[i] == allFactories[j]) {
+        addFactoryToSelection(factories[i], &selectedFactories);
+        break;
+      }
+    }
+  }
+}
+
 void FeatureSelectionMenuBase::promptToAddFactoryToSelection(
     BlobFeatureExtractorFactory* const factoryToAdd,
     std::vector<BlobFeatureExtractorFactory*>* const selection) {
@@ -31,6 +31,13 @@ class FeatureSelectionMenuBase : public virtual MenuBase {
   // Selects all of the factories
   void selectAllFactories();
 
+  // Gets all of the factories in this menu's category
+  std::vector<BlobFeatureExtractorFactory*> getAllFactories();
+
+  // Replaces the selection with the given factories that are in this menu's
+  // category (others are ignored), keeping whatever flags they have selected
+  void setSelection(const std::vector<BlobFeatureExtractorFactory*>& factories);
+
  protected:
 
   virtual BlobFeatureExtractorCategory* getCategory() = 0;
@@ -13,6 +13,7 @@
 #include <RecMenu.h>
 #include <AboutFeatMenu.h>
 #include <AllFeatMenu.h>
+#include <CostFeatMenu.h>
 
 #include <BlobFeatExtFac.h>
 
@@ -32,6 +33,11 @@ FeatureSelectionMenuMain::FeatureSelectionMenuMain(
   this->subMenus.push_back(this->spatialMenu);
   this->subMenus.push_back(this->recognitionMenu);
   if(trainingMain != NULL) {
+    this->subMenus.push_back(
+        new CostFeatMenu(this->spatialMenu,
+            this->recognitionMenu,
+            trainingMain,
+            this));
     this->subMenus.push_back(trainingMain);
   }
 }
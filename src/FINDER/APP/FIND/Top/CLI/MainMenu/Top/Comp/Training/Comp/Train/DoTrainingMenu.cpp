@@ -123,6 +123,18 @@ void DoTrainingMenu::doTask() {
     }
   }
 
+  // Speckle and pictures are left off of the grids for training and finding
+  // alike, so they're chosen along with the rest of the finder
+  std::cout << "Leave speckle and other noise (dust, scanner specks and the "
+      << "like) off of the grids for this finder? This is best for noisy scans "
+      << "but can drop small marks from clean ones. ";
+  const bool speckleFilterEnabled = Utils::promptYesNo();
+  std::cout << "Leave the components within photographs, halftones and other "
+      << "pictures off of the grids for this finder (and hide them from "
+      << "Tesseract)? This speeds up pages with figures but can drop math "
+      << "that sits right next to a picture. ";
+  const bool pictureFilterEnabled = Utils::promptYesNo();
+
   // Build the finder info
   FinderInfo* finderInfo = FinderInfoBuilder().setFinderName(finderName)
       ->setFeatureExtractorUniqueNames(getFeatureExtractorUniqueNames(featureFactories))
@@ -134,6 +146,8 @@ void DoTrainingMenu::doTask() {
       ->setGroundtruthFilePath(groundtruthFilePath)
       ->setFinderTrainingPaths(FinderTrainingPathsFactory().createFinderTrainingPaths(finderName))
       ->setGroundtruthImagePaths(groundtruthImagePaths)
+      ->setSpeckleFilterEnabled(speckleFilterEnabled)
+      ->setPictureFilterEnabled(pictureFilterEnabled)
       ->build();
 
   if(!TrainingInfoFileParser().writeInfoToFile(finderInfo)) {
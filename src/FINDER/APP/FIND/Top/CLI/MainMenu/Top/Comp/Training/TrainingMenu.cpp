@@ -81,6 +81,10 @@ void TrainingMenu::doTask() {
       << "Select from the following options:\n";
 }
 
+NameSelectionMenu* TrainingMenu::getNameSelectionMenu() {
+  return nameMenu;
+}
+
 FeatureSelectionMenuMain* TrainingMenu::getFeatureSelectionMenu() {
   return featureSelectionMenu;
 }
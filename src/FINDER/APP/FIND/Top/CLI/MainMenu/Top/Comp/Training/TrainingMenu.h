@@ -36,6 +36,7 @@ class TrainingMenu : public virtual MenuBase {
 
   void doTask();
 
+  NameSelectionMenu* getNameSelectionMenu();
   FeatureSelectionMenuMain* getFeatureSelectionMenu();
   DetectorSelectionMenu* getDetectorSelectionMenu();
   SegmentorSelectionMenu* getSegmentorSelectionMenu();
@@ -15,9 +15,85 @@ void MathExpressionFinderUsage::printUsage() {
       << "run as follows:\n"
       << "MathFinder [path]\n"
       << "Where [path] is the path either to a single image or a directory "
-      << "containing multiple images.\n\n"
+      << "containing multiple images. Each page of a multi-page TIFF is run "
+      << "as a page of its own (its results are named after the file followed "
+      << "by _p and the page index), with its pages read in one at a time "
+      << "through the pipeline described below.\n\n"
       << "To run with just detection and not segmentation run as follows:\n"
       << "MathFinder -d [path]\n\n"
+      << "To split a directory of images over several processes (or machines "
+      << "sharing a filesystem), run each one with a shard number i (counting "
+      << "from 0) out of N shards as follows:\n"
+      << "MathFinder --shard i/N [path]\n"
+      << "Each shard writes its results to its own directory. Once all of them "
+      << "have finished, merge them into the results a single run would have "
+      << "written as follows:\n"
+      << "MathFinder --merge N [path]\n"
+      << "(-d can be added to either of these as well). The shards' memory and "
+      << "cache stats are merged too. The merge exits with a nonzero status if "
+      << "any shard's results are missing or incomplete.\n\n"
+      << "Anything left in the results directory by an earlier run is removed "
+      << "before the run starts.\n\n"
+      << "The memory used by each stage of each page is written to "
+      << "memory_stats.tsv in the results directory (along with the hit rates "
+      << "of the word lookup cache in word_cache_stats.tsv and of the detector's "
+      << "prediction cache in prediction_cache_stats.tsv). To skip any page that "
+      << "needs more than M megabytes on top of what the process was already "
+      << "using (rather than having the whole run killed when the system runs "
+      << "out) add:\n"
+      << "MathFinder --max-rss-mb M [path]\n"
+      << "The ceiling is enforced while the page is processed by capping the "
+      << "process's address space, so it counts virtual memory as well.\n\n"
+      << "To evaluate the finder on a groundtruth directory without writing out "
+      << "the result images, run it on the groundtruth images and pass the "
+      << "groundtruth directory as follows (only the metrics are written):\n"
+      << "MathFinder --eval [groundtruth path] [groundtruth path]\n\n"
+      << "To overlap the stages of consecutive pages (reading in, Tesseract, "
+      << "feature extraction through segmentation, and writing out) run with "
+      << "R reading, G Tesseract, and W writing workers (and optionally up to "
+      << "Q pages waiting between stages) as follows:\n"
+      << "MathFinder --pipeline R,G,W[,Q] [path]\n"
+      << "Feature extraction through segmentation always has one worker. "
+      << "Tesseract hasn't been checked for thread safety with more than one "
+      << "Tesseract worker, so G above 1 is at your own risk. Pages that fail "
+      << "in the pipeline are left out of the results. Memory stats aren't "
+      << "written and --max-rss-mb can't be used in this mode.\n\n"
+      << "To bring pages scanned at well over D dpi (as estimated from the "
+      << "height of their characters) down to D dpi before they're processed, "
+      << "which speeds up high resolution scans, add:\n"
+      << "MathFinder --dpi D [path]\n"
+      << "The results are mapped back onto the original pages. Each page's "
+      << "estimated resolution, the scale it was processed at, and the time it "
+      << "took are written to resolution_stats.tsv in the results directory. "
+      << "Running with and without --dpi (along with --eval) shows how much "
+      << "time is saved and what it costs in accuracy.\n\n"
+      << "To save the state of each page once detection is done on it to the "
+      << "[path name]_detection_state directory, add:\n"
+      << "MathFinder --save-detection [path]\n"
+      << "Segmentation can then be run again from the saved states without "
+      << "running Tesseract, feature extraction, or detection, which is much "
+      << "faster when only the segmentor has changed:\n"
+      << "MathFinder --replay [path]\n"
+      << "The same --dpi has to be given to both. --pipeline can't be used with "
+      << "--replay (with -d it gives the saved detection results).\n\n"
+      << "The detector's raw score for each blob is saved along with it, so the "
+      << "blobs can be detected again at another threshold T when replaying "
+      << "(the SVM detector's default is 0):\n"
+      << "MathFinder --replay --threshold T [path]\n"
+      << "To evaluate every threshold from LO to HI in steps of STEP against the "
+      << "groundtruth (add -d to evaluate just detection) run:\n"
+      << "MathFinder --replay --sweep LO:HI:STEP --eval [groundtruth path] "
+      << "[groundtruth path]\n"
+      << "The metrics at each threshold are written to its own threshold_T "
+      << "directory and the recall and precision at all of them to "
+      << "threshold_sweep.tsv in the results directory.\n\n"
+      << "Whether speckle and other noise, and the components within pictures, "
+      << "are left off of the grids is chosen when the finder is trained. To "
+      << "turn either filter on or off for one run add:\n"
+      << "MathFinder --speckle-filter on|off --picture-filter on|off [path]\n"
+      << "The finder's features are only extracted the same way they were in "
+      << "training if these match the finder's settings. They can't be used "
+      << "with --merge or --replay.\n\n"
       << "For all other options including training, evaluation, groundtruth "
       << "generation, and documentation, there is an interactive menu which can "
       << "be run as follows:\n"
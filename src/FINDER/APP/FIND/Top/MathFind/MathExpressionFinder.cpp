@@ -6,13 +6,17 @@
  */
 #include <MathExpressionFinder.h>
 
+#include <chrono>
+#include <new>
+
 //#define SHOW_GRID
 
 MathExpressionFinder::MathExpressionFinder(
     MathExpressionFeatureExtractor* const mathExpressionFeatureExtractor,
     MathExpressionDetector* const mathExpressionDetector,
     MathExpressionSegmentor* const mathExpressionSegmentor,
-    FinderInfo* const finderInfo) : init(false) {
+    FinderInfo* const finderInfo) : init(false), memoryCeilingKB(0),
+    targetDpi(0), detectionStateDirName("") {
   this->mathExpressionFeatureExtractor = mathExpressionFeatureExtractor;
   this->mathExpressionDetector = mathExpressionDetector;
   this->mathExpressionSegmentor = mathExpressionSegmentor;
@@ -38,10 +42,196 @@ std::vector<MathExpressionFinderResults*> MathExpressionFinder
   return getResultsInRunMode(FIND, images, imageNames);
 }
 
+std::vector<MathExpressionFinderResults*> MathExpressionFinder
+::getResultsPipelined(
+    RunMode runMode,
+    const std::vector<PageSource>& pageSources,
+    const std::vector<std::string>& imageNames,
+    const PagePipelineConfig& pipelineConfig,
+    const std::string& resultsDirName,
+    Pixa* const keptImages) {
+  if(!(runMode == FIND || runMode == DETECT)) {
+    std::cout << "Error: Unexpected run mode.\n";
+    return std::vector<MathExpressionFinderResults*>();
+  }
+  if(!init) {
+    mathExpressionFeatureExtractor->doFinderInitialization();
+    init = true;
+  }
+  memoryStats.clear();
+  resolutionStats.clear();
+  if(targetDpi > 0) {
+    // filled in by the pipeline's workers as they get to each page
+    resolutionStats.resize(pageSources.size());
+  }
+  PagePipeline pipeline(this, runMode, pipelineConfig);
+  const std::vector<MathExpressionFinderResults*> results =
+      pipeline.run(pageSources, imageNames, resultsDirName, keptImages);
+  pipelineFailedPages = pipeline.getFailedPages();
+  return results;
+}
+
+MathExpressionFinderResults* MathExpressionFinder::analyzeGrid(
+    RunMode runMode, BlobDataGrid* const blobDataGrid) {
+  mathExpressionFeatureExtractor->extractFeatures(blobDataGrid);
+  mathExpressionDetector->detectMathExpressions(blobDataGrid);
+  saveDetectionState(blobDataGrid);
+  if(runMode == DETECT) {
+    return blobDataGrid->getDetectionResults(finderInfo->getFinderName());
+  }
+  mathExpressionSegmentor->runSegmentation(blobDataGrid);
+  return blobDataGrid->getSegmentationResults(finderInfo->getFinderName());
+}
+
+std::vector<MathExpressionFinderResults*> MathExpressionFinder
+::replayFromDetectionState(
+    RunMode runMode,
+    Pixa* const images,
+    std::vector<std::string> imageNames,
+    const std::string& detectionStateDirName,
+    const double* const detectionThreshold) {
+  if(!(runMode == FIND || runMode == DETECT)) {
+    std::cout << "Error: Unexpected run mode.\n";
+    return std::vector<MathExpressionFinderResults*>();
+  }
+  assert(pixaGetCount(images) == imageNames.size());
+
+  // Nothing needs to be initialized since the feature extractors aren't run
+  std::vector<MathExpressionFinderResults*> results;
+  memoryStats.clear();
+  resolutionStats.clear();
+  int scoredBlobs = 0;
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+
+  for(int i = 0; i < images->n; ++i) {
+    std::cout << "Replaying image " << imageNames[i] << ".\n";
+    const std::chrono::steady_clock::time_point pageStart =
+        std::chrono::steady_clock::now();
+
+    // The state was saved from the normalized page if there was a target
+    // resolution, so the page has to be normalized the same way again
+    Pix* image = pixaGetPix(images, i, L_CLONE);
+    double scale = 1;
+    if(targetDpi > 0) {
+      PageResolution pageResolution;
+      pageResolution.pageName = imageNames[i];
+      Pix* normalizedImage =
+          ResolutionNormalizer(targetDpi).normalize(image, &pageResolution);
+      pixDestroy(&image);
+      image = normalizedImage;
+      scale = pageResolution.scale;
+      resolutionStats.push_back(pageResolution);
+    }
+
+    // The grid is deleted along with the detection state
+    DetectionState detectionState;
+    BlobDataGrid* const blobDataGrid = detectionState.read(
+        DetectionState::getPath(detectionStateDirName,
+            Utils::getNameFromPath(imageNames[i])), image);
+    if(detectionThreshold != NULL) {
+      scoredBlobs += blobDataGrid->applyDetectionThreshold(*detectionThreshold);
+    }
+    if(runMode == DETECT) {
+      results.push_back(blobDataGrid->getDetectionResults(finderInfo->getFinderName()));
+    } else {
+      mathExpressionSegmentor->runSegmentation(blobDataGrid);
+      results.push_back(blobDataGrid->getSegmentationResults(finderInfo->getFinderName()));
+    }
+    mapToOriginalImage(results.back(), images, i, scale);
+    pixDestroy(&image);
+    if(targetDpi > 0) {
+      resolutionStats.back().seconds = std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - pageStart).count();
+    }
+  }
+
+  if(detectionThreshold != NULL && scoredBlobs == 0) {
+    std::cout << "None of the blobs have a saved detection score (the detector "
+        << "doesn't give one), so they keep their saved detection results.\n";
+  }
+  std::cout << "Replayed " << images->n << " pages in "
+      << std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - start).count() << " seconds.\n";
+  return results;
+}
+
+void MathExpressionFinder::setDetectionStateDir(
+    const std::string& detectionStateDirName) {
+  this->detectionStateDirName = detectionStateDirName;
+  if(!detectionStateDirName.empty()) {
+    Utils::exec("mkdir -p " + detectionStateDirName);
+  }
+}
+
+void MathExpressionFinder::saveDetectionState(
+    BlobDataGrid* const blobDataGrid) {
+  if(detectionStateDirName.empty()) {
+    return;
+  }
+  DetectionState::write(blobDataGrid, DetectionState::getPath(
+      detectionStateDirName, blobDataGrid->getImageName()));
+}
+
 MathExpressionFeatureExtractor* MathExpressionFinder::getFeatureExtractor() {
   return mathExpressionFeatureExtractor;
 }
 
+MathExpressionDetector* MathExpressionFinder::getDetector() {
+  return mathExpressionDetector;
+}
+
+void MathExpressionFinder::setMemoryCeiling(const long ceilingKB) {
+  memoryCeilingKB = ceilingKB;
+}
+
+std::vector<PageMemoryStats>& MathExpressionFinder::getMemoryStats() {
+  return memoryStats;
+}
+
+std::vector<int>& MathExpressionFinder::getPipelineFailedPages() {
+  return pipelineFailedPages;
+}
+
+void MathExpressionFinder::setTargetResolution(const int targetDpi) {
+  this->targetDpi = targetDpi;
+}
+
+int MathExpressionFinder::getTargetResolution() {
+  return targetDpi;
+}
+
+std::vector<PageResolution>& MathExpressionFinder::getResolutionStats() {
+  return resolutionStats;
+}
+
+void MathExpressionFinder::mapToOriginalImage(
+    MathExpressionFinderResults* const pageResults, Pixa* const images,
+    const int index, const double scale) {
+  if(scale == 1) {
+    return;
+  }
+  Pix* originalImage = pixaGetPix(images, index, L_CLONE);
+  pageResults->mapToOriginalImage(originalImage, scale);
+  pixDestroy(&originalImage);
+}
+
+bool MathExpressionFinder::abandonIfOverCeiling(PageMemoryStats& pageMemoryStats,
+    BlobDataGrid* const blobDataGrid, Pix** image) {
+  if(!pageMemoryStats.isOverCeiling()) {
+    return false;
+  }
+  std::cout << "WARNING: " << pageMemoryStats.getPageName() << " went over the memory "
+      << "ceiling of " << memoryCeilingKB << " KB during "
+      << pageMemoryStats.getStages().back().stage << " (peak of "
+      << pageMemoryStats.getStages().back().peakRssKB << " KB from a baseline of "
+      << pageMemoryStats.getBaselineRssKB() << " KB). Skipping it.\n";
+  pageMemoryStats.setFailed();
+  delete blobDataGrid;
+  pixDestroy(image);
+  return true;
+}
+
 std::vector<MathExpressionFinderResults*> MathExpressionFinder
 ::getResultsInRunMode(
     RunMode runMode,
@@ -64,6 +254,8 @@ std::vector<MathExpressionFinderResults*> MathExpressionFinder
 
   // Initialize the results vector
   std::vector<MathExpressionFinderResults*> results;
+  memoryStats.clear();
+  resolutionStats.clear();
 
   /**
    * Get the results for each image, appending them to the vector
@@ -73,72 +265,142 @@ std::vector<MathExpressionFinderResults*> MathExpressionFinder
     std::cout << "Processing image " << imageNames[i] << ".\n";
 
     Pix* image = pixaGetPix(images, i, L_CLONE);
+    memoryStats.push_back(PageMemoryStats(imageNames[i], memoryCeilingKB));
+    PageMemoryStats& pageMemoryStats = memoryStats.back();
+    const std::chrono::steady_clock::time_point pageStart =
+        std::chrono::steady_clock::now();
 
-    /**
-     * ---------------
-     * Stage 1: Run Tesseract OCR and get the data
-     * ---------------
-     * Create a grid containing the connected components in the image and
-     * their character results from running Tesseract's OCR with auto page
-     * segmentation.
-     */
-    std::cout << "Creating blob grid.\n";
+    // An allocation that would take the page over the ceiling fails (with
+    // std::bad_alloc) as soon as it's made rather than being caught after
+    // the stage it's made in, by which time the OS may have killed the run
     tesseract::TessBaseAPI api;
-    BlobDataGrid* const blobDataGrid =
-        BlobDataGridFactory().createBlobDataGrid(image, &api, Utils::getNameFromPath(imageNames[i]));
+    BlobDataGrid* blobDataGrid = NULL;
+    const int resultCount = results.size();
+    PageMemoryLimit pageMemoryLimit(memoryCeilingKB);
+    try {
+      // Bring the page down to the target resolution if it's well over it.
+      // Everything from here on works on the reduced page until the results
+      // are mapped back onto the original.
+      double scale = 1;
+      if(targetDpi > 0) {
+        PageResolution pageResolution;
+        pageResolution.pageName = imageNames[i];
+        pageResolution.seconds = -1;
+        Pix* normalizedImage =
+            ResolutionNormalizer(targetDpi).normalize(image, &pageResolution);
+        pixDestroy(&image);
+        image = normalizedImage;
+        scale = pageResolution.scale;
+        resolutionStats.push_back(pageResolution);
+        pageMemoryStats.endStage("normalize");
+      }
+
+      /**
+       * ---------------
+       * Stage 1: Run Tesseract OCR and get the data
+       * ---------------
+       * Create a grid containing the connected components in the image and
+       * their character results from running Tesseract's OCR with auto page
+       * segmentation (or just its layout analysis if none of the feature
+       * extractors need the character results).
+       */
+      std::cout << "Creating blob grid.\n";
+      blobDataGrid =
+          finderInfo->getGridFactory().createBlobDataGrid(image, &api,
+              Utils::getNameFromPath(imageNames[i]), &pageMemoryStats,
+              mathExpressionFeatureExtractor->getGridOcrLevel());
+      if(abandonIfOverCeiling(pageMemoryStats, blobDataGrid, &image)) {
+        continue;
+      }
 #ifdef SHOW_GRID
-    blobDataGrid->show();
+      blobDataGrid->show();
 #endif
 
-    /**
-     * ---------------
-     * Stage 2: Extract my features from each blob based upon that data
-     * ---------------
-     * Now that I have a grid containing the raw connected components, their basic
-     * data, and recognition data from Tesseract, I am ready to carry out my own
-     * feature extraction. My feature extractor will iterate over each blob and
-     * run whatever feature extractors were set from the command line for them.
-     * The results of the feature extraction are stored within the blob's grid entry
-     * within the grid that is passed into the extraction method.
-     */
-    std::cout << "Extracting features.\n";
-    mathExpressionFeatureExtractor->extractFeatures(blobDataGrid);
-
-    /**
-     * ---------------
-     * Stage 3: Detect low-level math expressions within the blobs using extracted
-     *          features
-     * ---------------
-     * Using the features extracted in the previous stage (along with any other data
-     * already stored in each entry that might be helpful) I now classify each
-     * individual blob as either being math or non-math. Depending on the detector
-     * being used I may also further categorize a blob as being a displayed math,
-     * embedded math, or a label for math.
-     */
-    std::cout << "Running detection.\n";
-    mathExpressionDetector->detectMathExpressions(blobDataGrid);
-    if(runMode == DETECT) {
-      results.push_back(blobDataGrid->getDetectionResults(finderInfo->getFinderName()));
-    }
+      /**
+       * ---------------
+       * Stage 2: Extract my features from each blob based upon that data
+       * ---------------
+       * Now that I have a grid containing the raw connected components, their basic
+       * data, and recognition data from Tesseract, I am ready to carry out my own
+       * feature extraction. My feature extractor will iterate over each blob and
+       * run whatever feature extractors were set from the command line for them.
+       * The results of the feature extraction are stored within the blob's grid entry
+       * within the grid that is passed into the extraction method.
+       */
+      std::cout << "Extracting features.\n";
+      mathExpressionFeatureExtractor->extractFeatures(blobDataGrid);
+      pageMemoryStats.endStage("features");
+      if(abandonIfOverCeiling(pageMemoryStats, blobDataGrid, &image)) {
+        continue;
+      }
 
-    /**
-     * ---------------
-     * Stage 4: Segment the detection results into math expressions (also uses
-     *          features extracted)
-     * ---------------
-     * Starting from the detection results from the previous stage, in this stage
-     * I figure out how each result should be segmented into math expressions (or
-     * labels for them if applicable). This involves combining neighboring blobs
-     * into single math expressions which will be the output of the program.
-     */
-    std::cout << "Running segmentation.\n";
-    if(runMode == FIND) {
-      mathExpressionSegmentor->runSegmentation(blobDataGrid);
-      results.push_back(blobDataGrid->getSegmentationResults(finderInfo->getFinderName()));
+      /**
+       * ---------------
+       * Stage 3: Detect low-level math expressions within the blobs using extracted
+       *          features
+       * ---------------
+       * Using the features extracted in the previous stage (along with any other data
+       * already stored in each entry that might be helpful) I now classify each
+       * individual blob as either being math or non-math. Depending on the detector
+       * being used I may also further categorize a blob as being a displayed math,
+       * embedded math, or a label for math.
+       */
+      std::cout << "Running detection.\n";
+      mathExpressionDetector->detectMathExpressions(blobDataGrid);
+      pageMemoryStats.endStage("detection");
+      if(abandonIfOverCeiling(pageMemoryStats, blobDataGrid, &image)) {
+        continue;
+      }
+      saveDetectionState(blobDataGrid);
+      if(runMode == DETECT) {
+        results.push_back(blobDataGrid->getDetectionResults(finderInfo->getFinderName()));
+        mapToOriginalImage(results.back(), images, i, scale);
+        pageMemoryStats.endStage("results");
+      }
+
+      /**
+       * ---------------
+       * Stage 4: Segment the detection results into math expressions (also uses
+       *          features extracted)
+       * ---------------
+       * Starting from the detection results from the previous stage, in this stage
+       * I figure out how each result should be segmented into math expressions (or
+       * labels for them if applicable). This involves combining neighboring blobs
+       * into single math expressions which will be the output of the program.
+       */
+      std::cout << "Running segmentation.\n";
+      if(runMode == FIND) {
+        mathExpressionSegmentor->runSegmentation(blobDataGrid);
+        pageMemoryStats.endStage("segmentation");
+        if(abandonIfOverCeiling(pageMemoryStats, blobDataGrid, &image)) {
+          continue;
+        }
+        results.push_back(blobDataGrid->getSegmentationResults(finderInfo->getFinderName()));
+        mapToOriginalImage(results.back(), images, i, scale);
+        pageMemoryStats.endStage("results");
+      }
+    } catch(std::bad_alloc&) {
+      // the page's memory is freed first since the limit is still in place
+      delete blobDataGrid;
+      pixDestroy(&image);
+      while(results.size() > resultCount) {
+        delete results.back();
+        results.pop_back();
+      }
+      pageMemoryStats.endStage("out_of_memory");
+      pageMemoryStats.setFailed();
+      std::cout << "WARNING: " << imageNames[i] << " ran out of memory under "
+          << "the ceiling of " << memoryCeilingKB << " KB. Skipping it.\n";
+      continue;
     }
 
     delete blobDataGrid;
     pixDestroy(&image);
+    pageMemoryStats.endStage("cleanup");
+    if(targetDpi > 0) {
+      resolutionStats.back().seconds = std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - pageStart).count();
+    }
   }
 
   return results;
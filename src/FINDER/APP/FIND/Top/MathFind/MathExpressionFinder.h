@@ -19,6 +19,11 @@
 #include <BlobDataGrid.h>
 
 #include <M_Utils.h>
+#include <MemStats.h>
+#include <ResolutionNormalizer.h>
+#include <PageSource.h>
+#include <PagePipeline.h>
+#include <DetectionState.h>
 
 #include <vector>
 #include <string>
@@ -40,7 +45,8 @@ class MathExpressionFinder {
    * same index in its array). "Detecting" the math expressions involves just
    * running the detector algorithm and returning those results (without running
    * segmentation). Prints error message returns empty vector if something went
-   * wrong.
+   * wrong. Pages abandoned for going over the memory ceiling have no results
+   * (see getMemoryStats).
    */
   std::vector<MathExpressionFinderResults*> detectMathExpressions(
       Pixa* const images,
@@ -52,14 +58,112 @@ class MathExpressionFinder {
    * image ones (i.e., the result at the first index is for the image at that
    * same index in its array). "Finding" the math expressions involves running
    * the detector algorithm followed by the segmentation one. Prints error
-   * message and returns empty vector if something went wrong.
+   * message and returns empty vector if something went wrong. Pages abandoned
+   * for going over the memory ceiling have no results (see getMemoryStats).
    */
   std::vector<MathExpressionFinderResults*> findMathExpressions(
       Pixa* const images,
       std::vector<std::string> imageNames);
 
+  /**
+   * Same as detectMathExpressions or findMathExpressions (depending on the
+   * run mode) except the images are read in from the given page sources and
+   * run through a PagePipeline so that consecutive pages can be in different
+   * stages at the same time. If a results directory is given then the result
+   * images for each page are written there as soon as the page is done. If
+   * kept images are given then the binarized images are added to it in the
+   * same order as the results. Memory isn't tracked per page in this mode
+   * (since several pages are in memory at once), so getMemoryStats is left
+   * empty and the memory ceiling isn't checked. Pages that failed in the
+   * pipeline have no results (see getPipelineFailedPages).
+   */
+  std::vector<MathExpressionFinderResults*> getResultsPipelined(
+      RunMode runMode,
+      const std::vector<PageSource>& pageSources,
+      const std::vector<std::string>& imageNames,
+      const PagePipelineConfig& pipelineConfig,
+      const std::string& resultsDirName,
+      Pixa* const keptImages=NULL);
+
+  /**
+   * Runs feature extraction, detection, and segmentation (if the run mode is
+   * FIND) on a grid that's already been created and gets its results. The
+   * grid isn't deleted. Only one grid can be analyzed at a time since the
+   * feature extractors keep data for the page they're on.
+   */
+  MathExpressionFinderResults* analyzeGrid(RunMode runMode,
+      BlobDataGrid* const blobDataGrid);
+
+  /**
+   * Gets the detection (or segmentation) results for the pages from the
+   * detection states saved for them in the given directory (see
+   * setDetectionStateDir) instead of running Tesseract, feature extraction and
+   * detection on them again. The images have to be the same ones the states
+   * were saved from (and are normalized the same way if a target resolution is
+   * set). If a detection threshold is given then the blobs with saved
+   * detection scores are detected again at that threshold first (see
+   * BlobDataGrid::applyDetectionThreshold), otherwise the saved detection
+   * results are used as they are. The memory stats are left empty.
+   */
+  std::vector<MathExpressionFinderResults*> replayFromDetectionState(
+      RunMode runMode,
+      Pixa* const images,
+      std::vector<std::string> imageNames,
+      const std::string& detectionStateDirName,
+      const double* const detectionThreshold=NULL);
+
+  /**
+   * Sets the directory each page's detection state is saved to once detection
+   * has been run on it (see DetectionState), creating it if it doesn't exist.
+   * An empty name (the default) means the states aren't saved.
+   */
+  void setDetectionStateDir(const std::string& detectionStateDirName);
+
   MathExpressionFeatureExtractor* getFeatureExtractor();
 
+  MathExpressionDetector* getDetector();
+
+  /**
+   * Sets how much memory (in kilobytes) a page may add to what the process
+   * was using when the page was started before it's abandoned. It's enforced
+   * while each stage runs (see PageMemoryLimit) as well as checked after it,
+   * so pages that go over the ceiling are cleaned up and left out of the
+   * results rather than taking down the whole run. A ceiling of 0 (the
+   * default) means there isn't one.
+   */
+  void setMemoryCeiling(const long ceilingKB);
+
+  /**
+   * Sets the resolution (in dpi) pages are brought down to before they're
+   * processed if they're estimated to be well over it (see
+   * ResolutionNormalizer). The results are mapped back onto the original
+   * pages. A target of 0 (the default) leaves the pages as they are.
+   */
+  void setTargetResolution(const int targetDpi);
+
+  int getTargetResolution();
+
+  /**
+   * Gets the estimated resolution, the scale each page was processed at, and
+   * the time it took for each page processed by the last call to
+   * detectMathExpressions, findMathExpressions or getResultsPipelined (one
+   * entry per image, in the same order). Empty if pages aren't normalized.
+   */
+  std::vector<PageResolution>& getResolutionStats();
+
+  /**
+   * Gets the memory used by each stage of each page processed by the last
+   * call to detectMathExpressions or findMathExpressions (one entry per image,
+   * in the same order, including the ones that were abandoned).
+   */
+  std::vector<PageMemoryStats>& getMemoryStats();
+
+  /**
+   * Gets the indexes of the pages that failed (and so have no results) in
+   * the last call to getResultsPipelined
+   */
+  std::vector<int>& getPipelineFailedPages();
+
   ~MathExpressionFinder();
 
  private:
@@ -70,6 +174,20 @@ class MathExpressionFinder {
       Pixa* const images,
       std::vector<std::string> imageNames);
 
+  // Maps the page's results back onto its original image if it was
+  // processed at a reduced scale
+  void mapToOriginalImage(MathExpressionFinderResults* const pageResults,
+      Pixa* const images, const int index, const double scale);
+
+  // Frees the page's grid and image if the last stage went over the memory
+  // ceiling (i.e., without running out of memory under the page's limit).
+  // Returns true if the page was abandoned.
+  bool abandonIfOverCeiling(PageMemoryStats& pageMemoryStats,
+      BlobDataGrid* const blobDataGrid, Pix** image);
+
+  // Saves the grid's detection state if a directory was set for it
+  void saveDetectionState(BlobDataGrid* const blobDataGrid);
+
   MathExpressionFeatureExtractor* mathExpressionFeatureExtractor;
   MathExpressionDetector* mathExpressionDetector;
   MathExpressionSegmentor* mathExpressionSegmentor;
@@ -77,6 +195,12 @@ class MathExpressionFinder {
 
   // internal variables/flags
   bool init;
+  long memoryCeilingKB;
+  std::vector<PageMemoryStats> memoryStats;
+  std::vector<int> pipelineFailedPages;
+  int targetDpi;
+  std::vector<PageResolution> resolutionStats;
+  std::string detectionStateDirName;
 };
 
 
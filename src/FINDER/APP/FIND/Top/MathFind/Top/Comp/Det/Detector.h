@@ -44,6 +44,46 @@ class MathExpressionDetector {
    */
   virtual bool doTraining(const std::vector<std::vector<BLSample*> >& samples)=0;
 
+  /**
+   * Updates a previously trained detector with the samples from pages added
+   * since it was trained. The samples for all of the pages are given, with
+   * the new ones starting at index firstNewImage. Detectors which can't be
+   * updated incrementally are just retrained on all of the samples. If
+   * compareToFullRetrain is true the update is also checked against a
+   * detector trained from scratch on the same samples.
+   * Returns true if the update succeeded, false if it failed.
+   */
+  virtual bool doIncrementalTraining(
+      const std::vector<std::vector<BLSample*> >& samples,
+      const int firstNewImage, const bool compareToFullRetrain) {
+    return doTraining(samples);
+  }
+
+  /**
+   * True if the detector can be trained straight from the sample file with
+   * doTrainingFromFile rather than from samples already read into memory.
+   */
+  virtual bool canTrainFromFile() {
+    return false;
+  }
+
+  /**
+   * Trains the detector on the samples in the given sample file (see
+   * SampleFileParser for its format) without reading them all into memory
+   * as BLSamples first. Only called if canTrainFromFile is true. Returns
+   * true if the training succeeded, false if it failed.
+   */
+  virtual bool doTrainingFromFile(const std::string& samplePath) {
+    return false;
+  }
+
+  /**
+   * Prints any stats the detector keeps about its predictions (e.g., how well
+   * they were cached) and writes them to the given results directory. Does
+   * nothing for detectors which don't keep any.
+   */
+  virtual void writeStats(const std::string& resultsDirName) {}
+
   virtual ~MathExpressionDetector(){};
 
  };
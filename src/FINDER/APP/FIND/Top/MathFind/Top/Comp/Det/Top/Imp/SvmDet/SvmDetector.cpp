@@ -7,6 +7,14 @@
 
 #include <SvmDetector.h>
 
+#include <SvmPrediction.h>
+#include <SparseSample.h>
+#include <SparseBench.h>
+#include <DistanceCache.h>
+#include <PredictionCache.h>
+#include <NormalizerStats.h>
+#include <SampleChunkReader.h>
+
 #include <BlobDataGrid.h>
 #include <BlobData.h>
 #include <M_Utils.h>
@@ -26,24 +34,77 @@
 #include <vector>
 #include <assert.h>
 #include <ios>
+#include <chrono>
+#include <ctime>
+#include <cmath>
+#include <algorithm>
+#include <utility>
 
 //#define SHOW_GRID
+//#define DBG_BENCHMARK_PREDICTION
+//#define DBG_BENCHMARK_SPARSE // compares dense and sparse samples before training
 
 #define PROGRESS_TO_FILE
 //#define RUNNING_BACKGROUND
 
+// number of samples held in memory at a time when training from the sample file
+#define SAMPLE_CHUNK_SIZE 100000
+
+double cross_validation_objective::operator() (
+    const dlib::matrix<double>& params) const {
+  // Pull out the two SVM model parameters.  Note that, in this case,
+  // I have setup the parameter search to operate in log scale so we have
+  // to remember to call exp() to put the parameters back into a normal scale.
+  const double C = std::exp(params(0));
+#ifdef RBF_KERNEL
+  const double gamma    = std::exp(params(1));
+
+  // Perform 10-fold cross validation on an SVM with these parameters (on the
+  // shared distances if there are some) and then print and return the results.
+  dlib::matrix<double> result = SampleDistanceCache::crossValidateRBF(cache,
+      C, gamma, samples, *sampleIndices, labels, folds);
+  outputProgress(std::string("C: ") + Utils::doubleToString(C, 11) +
+      std::string("  gamma: ") + Utils::doubleToString(gamma, 11) +
+      std::string("  cross validation accuracy: ") +
+      Utils::doubleToString(result(0, 0), 11) + std::string(", ") +
+      Utils::doubleToString(result(0, 1), 11) + std::string("\n"));
+#endif
+#ifdef LINEAR_KERNEL
+  dlib::svm_c_trainer<LinearKernel> trainer;
+  trainer.set_c(C);
+  cout << "Running cross validation on Linear Kernel SVM with ";
+  cout << "C: " << setw(11) << C << endl;
+  dlib::matrix<double> result = dlib::cross_validate_trainer_threaded(trainer, samples, labels, folds, folds);
+  std::cout << "C: " << std::setw(11) << C
+      << "   cross validation accuracy:  " << result;
+#endif
+
+  // Here I'm just summing the accuracy on each class.  However, you could do something else.
+  // For example, your application might require a 90% accuracy on class +1 and so you could
+  // heavily penalize results that didn't obtain the desired accuracy.  Or similarly, you
+  // might use the roc_c1_trainer() function to adjust the trainer output so that it always
+  // obtained roughly a 90% accuracy on class +1.  In that case returning the sum of the two
+  // class accuracies might be appropriate.
+  return sum(result);
+}
+
 // ***********
 // Note see http://dlib.net/svm_ex.cpp.html
 // Much of this is copied from that example.
 // ************
 TrainedSvmDetector::TrainedSvmDetector(
-    const std::string& detectorDirPath) {
+    const std::string& detectorDirPath) : distanceCache(NULL),
+        successiveHalvingSearch(false), predictionFunction(NULL),
+        predictionCache(new SvmPredictionCache()) {
   std::string classifierName =
 #ifdef RBF_KERNEL
       (std::string)"RBFSVM";
 #endif
 #ifdef LINEAR_KERNEL
       (std::string)"LinearSVM";
+#endif
+#ifdef SPARSE_SAMPLES
+  classifierName = std::string("Sparse") + classifierName;
 #endif
   predictorPath = std::string(Utils::checkTrailingSlash(detectorDirPath)) + classifierName + "Predictor";
   progressFilePath = std::string(Utils::checkTrailingSlash(detectorDirPath)) + classifierName + "Progress";
@@ -66,15 +127,23 @@ TrainedSvmDetector::TrainedSvmDetector(
 void TrainedSvmDetector::detectMathExpressions(
     BlobDataGrid* const blobDataGrid) {
 
-  // Start up the predictor
-  loadPredictor();
+  // Start up the predictor (only needs to be done for the first page)
+  if(predictionFunction == NULL) {
+    loadPredictor();
+  }
+#ifdef DBG_BENCHMARK_PREDICTION
+  dbgBenchmarkPrediction(blobDataGrid);
+#endif
 
-  // Run the predictor on each blob
+  // Run the predictor on each blob, keeping its decision value so the blob
+  // can be detected again at another threshold without the predictor
   BlobData* blob = NULL;
   BlobDataGridSearch bdgs(blobDataGrid);
   bdgs.StartFullSearch();
   while((blob = bdgs.NextFullSearch()) != NULL) {
-    blob->setMathExpressionDetectionResult(predict(blob->getExtractedFeatures()));
+    const double score = getDecisionScore(blob->getExtractedFeatures());
+    blob->setMathExpressionDetectionScore(score);
+    blob->setMathExpressionDetectionResult(score >= SVM_DECISION_THRESHOLD);
   }
 
 #ifdef SHOW_GRID
@@ -107,6 +176,10 @@ bool TrainedSvmDetector::doTraining(const std::vector<std::vector<BLSample*> >&
     }
 #endif
 
+#ifdef DBG_BENCHMARK_SPARSE
+  SparseSampleBenchmark::run(samples, std::cout);
+#endif
+
   // Convert the samples into format suitable for DLib
   std::cout << "started libSVM's doTraining\n";
   int num_features = samples[0][0]->features.size();
@@ -114,14 +187,8 @@ bool TrainedSvmDetector::doTraining(const std::vector<std::vector<BLSample*> >&
     for(int j = 0; j < samples[i].size(); ++j) { // iterates the samples in the image
       BLSample* const s = samples[i][j];
       // add the sample (the feature vector)
-      std::vector<DoubleFeature*> features = s->features;
-      assert(features.size() == num_features);
-      sample_type sample;
-      sample.set_size(num_features, 1);
-      for(int k = 0; k < num_features; ++k) {
-        sample(k) = features[k]->getFeature();
-      }
-      training_samples.push_back(sample);
+      assert(s->features.size() == num_features);
+      training_samples.push_back(toDlibSample(s->features));
       // add the corresponding label
       if(s->label)
         labels.push_back(+1);
@@ -138,7 +205,7 @@ bool TrainedSvmDetector::doTraining(const std::vector<std::vector<BLSample*> >&
   // *** see http://dlib.net/svm_ex.cpp.html for a better explanation.
   // *** basically need to randomize the ordering of the samples to avoid
   // *** screwing up cross validation
-  randomize_samples(training_samples, labels);
+  dlib::randomize_samples(training_samples, labels);
   outputProgress("done randomizing samples\n");
 
   // Here we normalize all the samples by subtracting their mean and dividing by their
@@ -147,7 +214,11 @@ bool TrainedSvmDetector::doTraining(const std::vector<std::vector<BLSample*> >&
   // others.  Doing this doesn't matter much in this example so I'm just doing this here
   // so you can see an easy way to accomplish this with the library.
   // let the normalizer learn the mean and standard deviation of the samples
+#ifdef SPARSE_SAMPLES
+  normalizer.train(training_samples, num_features);
+#else
   normalizer.train(training_samples);
+#endif
   outputProgress("done setting up normalizing\n");
 
   // now normalize each sample
@@ -155,6 +226,77 @@ bool TrainedSvmDetector::doTraining(const std::vector<std::vector<BLSample*> >&
     training_samples[i] = normalizer(training_samples[i]);
   outputProgress("done normalizing each sample\n");
 
+  return trainOnNormalizedSamples();
+}
+
+// Loads the samples straight from the sample file in two passes over it, a
+// chunk at a time. The first pass only accumulates the mean and variance of
+// each feature to set up the normalizer, and the second converts each chunk
+// into normalized dlib samples. Nothing but the final samples and one chunk
+// of the file is ever held in memory, where doTraining needs the BLSamples
+// (and all of their DoubleFeatures) along with the dlib samples.
+bool TrainedSvmDetector::doTrainingFromFile(const std::string& samplePath) {
+
+#ifdef PROGRESS_TO_FILE
+    progressFile.open(progressFilePath.c_str());
+    if(!progressFile.is_open()) {
+      std::cout << "ERROR: Failed to open " << progressFilePath << std::endl <<
+          "Training failed.\n";
+      return false;
+    }
+#endif
+
+  std::cout << "started libSVM's doTrainingFromFile\n";
+  SampleChunkReader reader(samplePath, SAMPLE_CHUNK_SIZE);
+  std::vector<LabeledFeatures> chunk;
+  NormalizerStats stats;
+  while(reader.nextChunk(&chunk)) {
+    for(int i = 0; i < chunk.size(); ++i) {
+      stats.add(chunk[i]);
+    }
+  }
+  if(stats.getSampleCount() == 0) {
+    std::cout << "ERROR: There are no samples in " << samplePath
+        << ". Training failed.\n";
+    return false;
+  }
+  stats.toNormalizer(&normalizer);
+  outputProgress(std::string("done setting up normalizing from the ") +
+      Utils::intToString(stats.getSampleCount()) + std::string(" samples in ") +
+      samplePath + std::string("\n"));
+
+  training_samples.clear();
+  labels.clear();
+  training_samples.reserve(stats.getSampleCount());
+  labels.reserve(stats.getSampleCount());
+  reader.rewind();
+  while(reader.nextChunk(&chunk)) {
+    for(int i = 0; i < chunk.size(); ++i) {
+#ifdef SPARSE_SAMPLES
+      training_samples.push_back(normalizer(chunk[i].nonzeros));
+#else
+      sample_type sample;
+      sample.set_size(stats.getDimension());
+      sample = 0;
+      for(int j = 0; j < chunk[i].nonzeros.size(); ++j) {
+        sample(chunk[i].nonzeros[j].first) = chunk[i].nonzeros[j].second;
+      }
+      training_samples.push_back(normalizer(sample));
+#endif
+      labels.push_back(chunk[i].label ? +1 : -1);
+    }
+  }
+  assert(training_samples.size() == stats.getSampleCount());
+  outputProgress("done pushing back normalized samples\n");
+
+  // see doTraining for why
+  dlib::randomize_samples(training_samples, labels);
+  outputProgress("done randomizing samples\n");
+
+  return trainOnNormalizedSamples();
+}
+
+bool TrainedSvmDetector::trainOnNormalizedSamples() {
   // Now ready to find the optimal C and Gamma parameters through a coarse
   // grid search then through a finer one. Once the "optimal" C and Gamma
   // parameters are found, the SVM is trained on these to give the final
@@ -175,8 +317,18 @@ bool TrainedSvmDetector::doTraining(const std::vector<std::vector<BLSample*> >&
 #endif
   }
   if(doParamCalc) {
+#ifndef RUNNING_BACKGROUND
+    std::cout << "Would you like the coarse parameter search to use successive "
+        << "halving? Most of the (C, gamma) pairs are then only cross validated "
+        << "on part of the samples, which is much faster on large training sets "
+        << "but can occasionally miss the pair the exhaustive search would pick. "
+        << "If you answer no, every pair is cross validated on all of the samples. ";
+    successiveHalvingSearch = Utils::promptYesNo();
+#endif
+    createDistanceCache();
     doCoarseCVTraining(10);
     doFineCVTraining(10);
+    destroyDistanceCache();
     saveOptParams();
   }
   outputProgress("about to do training\n");
@@ -189,6 +341,124 @@ bool TrainedSvmDetector::doTraining(const std::vector<std::vector<BLSample*> >&
   return true;
 }
 
+// Updates the saved predictor with the samples from the pages added since it
+// was trained. Only the support vectors of an SVM have any say in its decision
+// function, so they stand in for all of the old pages' samples: the SVM is
+// retrained on them together with the new pages' samples using the C and gamma
+// found by the original parameter search. The support vectors are stored
+// already normalized, so the original normalizer is kept as is and the new
+// samples are normalized with it. The coarse and fine cross validation
+// searches are skipped entirely, which is where nearly all of the time of a
+// full retrain goes. To report how well the update does on samples it wasn't
+// trained on, it's first done without 1/INCREMENTAL_HOLDOUT_FOLDS of the new
+// samples and tested on those, then redone on all of them for the predictor
+// that's saved.
+bool TrainedSvmDetector::doIncrementalTraining(
+    const std::vector<std::vector<BLSample*> >& samples,
+    const int firstNewImage, const bool compareToFullRetrain) {
+  if(!Utils::existsFile(predictorPath) || !loadOptParams()) {
+    std::cout << "There is no saved predictor and parameters at " << predictorPath
+        << " to update, so the detector will be trained from scratch.\n";
+    return doTraining(samples);
+  }
+
+#ifdef PROGRESS_TO_FILE
+  progressFile.open(progressFilePath.c_str(), std::ios::app);
+  if(!progressFile.is_open()) {
+    std::cout << "ERROR: Failed to open " << progressFilePath << std::endl <<
+        "Updating the detector failed.\n";
+    return false;
+  }
+#endif
+
+  loadPredictor();
+  normalizer = final_predictor.normalizer;
+
+  // the old support vectors, labeled by the sign of their weights
+  std::vector<sample_type> supportVectors;
+  std::vector<double> supportVectorLabels;
+  const long supportVectorCount = final_predictor.function.basis_vectors.size();
+  for(long i = 0; i < supportVectorCount; ++i) {
+    supportVectors.push_back(final_predictor.function.basis_vectors(i));
+    supportVectorLabels.push_back(
+        (final_predictor.function.alpha(i) > 0) ? +1 : -1);
+  }
+
+  // the samples from the new pages (kept unnormalized for testing), shuffled
+  // so the first heldOutCount of them are a random subset to test on
+  std::vector<sample_type> newSamples;
+  std::vector<double> newLabels;
+  for(int i = firstNewImage; i < samples.size(); ++i) {
+    for(int j = 0; j < samples[i].size(); ++j) {
+      BLSample* const s = samples[i][j];
+      assert(s->features.size() == normalizer.in_vector_size());
+      newSamples.push_back(toDlibSample(s->features));
+      newLabels.push_back(s->label ? +1 : -1);
+    }
+  }
+  dlib::randomize_samples(newSamples, newLabels);
+  const int heldOutCount = newSamples.size() / INCREMENTAL_HOLDOUT_FOLDS;
+  outputProgress(std::string("Updating the detector with ") +
+      Utils::intToString(newSamples.size()) + std::string(" samples from ") +
+      Utils::intToString(samples.size() - firstNewImage) +
+      std::string(" new pages and the ") + Utils::intToString(supportVectorCount) +
+      std::string(" support vectors of the old predictor\n"));
+
+  if(heldOutCount > 0) {
+    const std::vector<sample_type> heldOutSamples(newSamples.begin(),
+        newSamples.begin() + heldOutCount);
+    const std::vector<double> heldOutLabels(newLabels.begin(),
+        newLabels.begin() + heldOutCount);
+    const double heldOutUpdateSeconds = updateFromSupportVectors(supportVectors,
+        supportVectorLabels, newSamples, newLabels, heldOutCount);
+    const dlib::matrix<double, 1, 2> heldOutAccuracy =
+        dlib::test_binary_decision_function(final_predictor, heldOutSamples,
+            heldOutLabels);
+    outputProgress(std::string("Updated the detector without ") +
+        Utils::intToString(heldOutCount) + std::string(" held out samples in ") +
+        Utils::doubleToString(heldOutUpdateSeconds) + std::string(" seconds. ") +
+        std::string("Accuracy on the held out samples (positive, negative): ") +
+        Utils::doubleToString(heldOutAccuracy(0, 0)) + std::string(", ") +
+        Utils::doubleToString(heldOutAccuracy(0, 1)) + std::string("\n"));
+    if(compareToFullRetrain) {
+      compareWithFullRetrain(samples, firstNewImage, newSamples, newLabels,
+          heldOutCount, heldOutUpdateSeconds);
+    }
+  } else {
+    outputProgress(std::string("There are too few new samples to hold any out, ") +
+        std::string("so the update's accuracy can't be measured\n"));
+  }
+
+  // the saved predictor is updated with all of the new samples
+  const double updateSeconds = updateFromSupportVectors(supportVectors,
+      supportVectorLabels, newSamples, newLabels, 0);
+  outputProgress(std::string("Updated the detector with all of the new samples in ")
+      + Utils::doubleToString(updateSeconds) + std::string(" seconds\n"));
+  savePredictor();
+  outputProgress(std::string("Update Complete! The predictor has been saved to ")
+       + predictorPath + std::string("\n"));
+  return true;
+}
+
+double TrainedSvmDetector::updateFromSupportVectors(
+    const std::vector<sample_type>& supportVectors,
+    const std::vector<double>& supportVectorLabels,
+    const std::vector<sample_type>& newSamples,
+    const std::vector<double>& newLabels, const int firstUsed) {
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  training_samples = supportVectors;
+  labels = supportVectorLabels;
+  for(int i = firstUsed; i < newSamples.size(); ++i) {
+    training_samples.push_back(normalizer(newSamples[i]));
+    labels.push_back(newLabels[i]);
+  }
+  dlib::randomize_samples(training_samples, labels);
+  trainFinalClassifier();
+  return std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
 // Much of the functionality of this training is inspired by:
 // [1] C.W. Hsu. "A practical guide to support vector classiﬁcation," Department of
 // Computer Science, Tech. rep. National Taiwan University, 2003.
@@ -222,6 +492,11 @@ void TrainedSvmDetector::doCoarseCVTraining(int folds) {
   outputProgress(std::string("Predictor Path: ") +
       predictorPath + std::string("\n"));
 
+  if(successiveHalvingSearch) {
+    doSuccessiveHalvingSearch(grid, folds);
+    return;
+  }
+
   //    Carry out course grid search. The grid is actually implemented as a
   //    2x100 matrix where row 1 is the C part of the grid pair and row 2
   //    is the corresponding gamma part. Each index represents a pair on the
@@ -235,16 +510,6 @@ void TrainedSvmDetector::doCoarseCVTraining(int folds) {
 #ifdef RBF_KERNEL
     const double gamma = grid(1, i);
 #endif
-    // set up C_SVC trainer using the current parameters
-
-#ifdef RBF_KERNEL
-    dlib::svm_c_trainer<RBFKernel> trainer;
-    trainer.set_kernel(RBFKernel(gamma));
-#endif
-#ifdef LINEAR_KERNEL
-    svm_c_trainer<LinearKernel> trainer;
-#endif
-    trainer.set_c(C);
     // do the cross validation
     outputProgress(std::string("Running cross validation for ") +
         std::string("C: ") + Utils::doubleToString(C, 11) +
@@ -255,15 +520,8 @@ void TrainedSvmDetector::doCoarseCVTraining(int folds) {
 #ifdef LINEAR_KERNEL
          std::string("\n"));
 #endif
-    dlib::matrix<double> result = cross_validate_trainer_threaded(trainer, training_samples,
-        labels, folds, folds); // last arg is the number of threads (using same as folds)
-    outputProgress(std::string("C: ") +  Utils::doubleToString(C, 11) +
-#ifdef RBF_KERNEL
-         std::string("  Gamma: ") + Utils::doubleToString(gamma, 11) +
-#endif
-         std::string("  cross validation accuracy (positive, negative): ") +
-         Utils::doubleToString(result(0,0), 11) + std::string(", ") +
-         Utils::doubleToString(result(0,1), 11) + std::string("\n"));
+    dlib::matrix<double> result = crossValidateGridPoint(grid, i,
+        training_samples, trainingSampleIndices, labels, folds); // prints the result
     if(sum(result) > sum(best_result)) {
       best_result = result;
 #ifdef RBF_KERNEL
@@ -285,6 +543,154 @@ void TrainedSvmDetector::doCoarseCVTraining(int folds) {
 #endif
 }
 
+// Successive halving (multi-fidelity) version of the coarse grid search. Most
+// of the grid is obviously bad after cross validating on a small fraction of
+// the samples, so only the most promising pairs are ever cross validated on
+// all of them. Sets C_optimal (and gamma_optimal) to the best pair of the
+// final round.
+void TrainedSvmDetector::doSuccessiveHalvingSearch(
+    const dlib::matrix<double>& grid, int folds) {
+  const int eta = SUCCESSIVE_HALVING_ETA;
+  const int minSamplesPerClass = 5 * folds; // keeps each fold from being tiny
+
+  // The samples were already shuffled, so taking the first so many of each
+  // class gives a random subsample with the same class proportions
+  std::vector<int> positives, negatives;
+  for(int i = 0; i < labels.size(); ++i) {
+    if(labels[i] > 0)
+      positives.push_back(i);
+    else
+      negatives.push_back(i);
+  }
+
+  // Figure out how many rounds it takes to get down to eta or fewer
+  // pairs. The last round is the one run on all of the samples.
+  std::vector<int> candidates;
+  for(int i = 0; i < grid.nc(); ++i)
+    candidates.push_back(i);
+  int rounds = 1;
+  for(int n = candidates.size(); n > eta; n = (n + eta - 1) / eta)
+    ++rounds;
+
+  outputProgress(std::string("Started successive halving search over ") +
+      Utils::intToString(candidates.size()) + std::string(" pairs in ") +
+      Utils::intToString(rounds) + std::string(" rounds.\n"));
+
+  const std::clock_t searchStart = std::clock();
+  double fullSetCpuTime = 0; // cpu time spent cross validating on all the samples
+  int fullSetEvaluations = 0;
+  dlib::matrix<double> best_result(2,1);
+  best_result = 0;
+  for(int round = 0; round < rounds; ++round) {
+    const double fraction = std::pow((double)eta, (double)(round - (rounds - 1)));
+    const int numPositives = std::min((int)positives.size(),
+        std::max(minSamplesPerClass, (int)std::ceil(fraction * positives.size())));
+    const int numNegatives = std::min((int)negatives.size(),
+        std::max(minSamplesPerClass, (int)std::ceil(fraction * negatives.size())));
+    const bool isFullSet = (numPositives == positives.size()
+        && numNegatives == negatives.size());
+    std::vector<sample_type> subsamples;
+    std::vector<unsigned long> subindices;
+    std::vector<double> sublabels;
+    for(int i = 0; i < numPositives; ++i) {
+      if(distanceCache == NULL)
+        subsamples.push_back(training_samples[positives[i]]);
+      subindices.push_back(positives[i]);
+      sublabels.push_back(labels[positives[i]]);
+    }
+    for(int i = 0; i < numNegatives; ++i) {
+      if(distanceCache == NULL)
+        subsamples.push_back(training_samples[negatives[i]]);
+      subindices.push_back(negatives[i]);
+      sublabels.push_back(labels[negatives[i]]);
+    }
+    outputProgress(std::string("Round ") + Utils::intToString(round + 1) +
+        std::string(": cross validating ") + Utils::intToString(candidates.size()) +
+        std::string(" pairs on ") + Utils::intToString(sublabels.size()) +
+        std::string(" samples.\n"));
+
+    std::vector<std::pair<double, int> > scores;
+    for(int i = 0; i < candidates.size(); ++i) {
+      const std::clock_t evalStart = std::clock();
+      dlib::matrix<double> result = crossValidateGridPoint(grid, candidates[i],
+          subsamples, subindices, sublabels, folds);
+      if(isFullSet) {
+        fullSetCpuTime += (double)(std::clock() - evalStart) / CLOCKS_PER_SEC;
+        ++fullSetEvaluations;
+      }
+      scores.push_back(std::make_pair(sum(result), candidates[i]));
+      if(round == rounds - 1 && sum(result) > sum(best_result)) {
+        best_result = result;
+        C_optimal = grid(0, candidates[i]);
+#ifdef RBF_KERNEL
+        gamma_optimal = grid(1, candidates[i]);
+#endif
+      }
+    }
+
+    // Keep the best 1/eta of the pairs for the next round
+    std::sort(scores.begin(), scores.end());
+    std::reverse(scores.begin(), scores.end());
+    const int numKept = (candidates.size() + eta - 1) / eta;
+    candidates.clear();
+    for(int i = 0; i < numKept; ++i)
+      candidates.push_back(scores[i].second);
+  }
+  const double searchCpuTime = (double)(std::clock() - searchStart) / CLOCKS_PER_SEC;
+
+#ifdef RBF_KERNEL
+  outputProgress(std::string("Best Result: (positive, negative)") +
+      Utils::doubleToString(best_result(0,0)) + std::string(", ") +
+      Utils::doubleToString(best_result(0,1)) + std::string("\n") +
+      std::string(". Gamma = ") + Utils::doubleToString(gamma_optimal, 11) +
+       std::string(". C = ") + Utils::doubleToString(C_optimal, 11) + std::string("\n"));
+#endif
+#ifdef LINEAR_KERNEL
+  std::cout << "Best Result: " << best_result
+       << ", C = " << std::setw(11) << C_optimal << std::endl;
+#endif
+
+  // The exhaustive grid would have cross validated every pair on all the
+  // samples, so estimate its cost from the pairs which actually were
+  if(fullSetEvaluations > 0) {
+    const double exhaustiveCpuTime = grid.nc() * (fullSetCpuTime / fullSetEvaluations);
+    outputProgress(std::string("Successive halving search took ") +
+        Utils::doubleToString(searchCpuTime) + std::string(" s of CPU time. ") +
+        std::string("The exhaustive grid would have taken about ") +
+        Utils::doubleToString(exhaustiveCpuTime) + std::string(" s, so about ") +
+        Utils::doubleToString(exhaustiveCpuTime - searchCpuTime) +
+        std::string(" s were saved.\n"));
+  }
+}
+
+dlib::matrix<double> TrainedSvmDetector::crossValidateGridPoint(
+    const dlib::matrix<double>& grid, const int gridIndex,
+    const std::vector<sample_type>& samples,
+    const std::vector<unsigned long>& sampleIndices,
+    const std::vector<double>& labels, int folds) {
+  const double C = grid(0, gridIndex);
+#ifdef RBF_KERNEL
+  const double gamma = grid(1, gridIndex);
+  dlib::matrix<double> result = SampleDistanceCache::crossValidateRBF(
+      distanceCache, C, gamma, samples, sampleIndices, labels, folds);
+#endif
+#ifdef LINEAR_KERNEL
+  dlib::svm_c_trainer<LinearKernel> trainer;
+  trainer.set_c(C);
+  dlib::matrix<double> result = dlib::cross_validate_trainer_threaded(trainer, samples,
+      labels, folds, folds); // last arg is the number of threads (using same as folds)
+#endif
+  outputProgress(std::string("C: ") +  Utils::doubleToString(C, 11) +
+#ifdef RBF_KERNEL
+       std::string("  Gamma: ") + Utils::doubleToString(gamma, 11) +
+#endif
+       std::string("  samples: ") + Utils::intToString(labels.size()) +
+       std::string("  cross validation accuracy (positive, negative): ") +
+       Utils::doubleToString(result(0,0), 11) + std::string(", ") +
+       Utils::doubleToString(result(0,1), 11) + std::string("\n"));
+  return result;
+}
+
 // assumes that C_optimal and gamma_optimal have already
 // been initialized either manually or through doCoarseCVTraining()
 // this carries out BOBYQA algorithm to find optimal C and Gamma parameters
@@ -322,7 +728,8 @@ void TrainedSvmDetector::doFineCVTraining(int folds) {
   upperbound = dlib::log(upperbound);
 
   double best_score = dlib::find_max_bobyqa(
-      cross_validation_objective(training_samples, labels, folds, &progressFile), // Function to maximize
+      cross_validation_objective(training_samples, labels, folds, &progressFile,
+          distanceCache, &trainingSampleIndices), // Function to maximize
       opt_params,                                      // starting point
       opt_params.size()*2 + 1,                         // See BOBYQA docs, generally size*2+1 is a good setting for this
       lowerbound,                                 // lower bound
@@ -353,11 +760,9 @@ void TrainedSvmDetector::doFineCVTraining(int folds) {
   outputProgress(std::string("Running cross validation again on optimal c and gamma") +
       std::string(" to get the true positive and true negative rate (should sum") +
       std::string(" up to the score above.\n"));
-  dlib::svm_c_trainer<RBFKernel> trainer;
-  trainer.set_kernel(RBFKernel(gamma_optimal));
-  trainer.set_c(C_optimal);
-  dlib::matrix<double> result = cross_validate_trainer_threaded(trainer, training_samples,
-      labels, folds, folds); // last arg is the number of threads (using same as folds)
+  dlib::matrix<double> result = SampleDistanceCache::crossValidateRBF(
+      distanceCache, C_optimal, gamma_optimal, training_samples,
+      trainingSampleIndices, labels, folds);
   outputProgress(std::string("C: ") +  Utils::doubleToString(C_optimal, 11) +
        std::string("  Gamma: ") + Utils::doubleToString(gamma_optimal, 11) +
        std::string("  cross validation accuracy (positive, negative): ") +
@@ -365,6 +770,44 @@ void TrainedSvmDetector::doFineCVTraining(int folds) {
        Utils::doubleToString(result(0,1)) + std::string("\n"));
 }
 
+// The distances between the samples don't depend on C or gamma, so they're
+// computed just once here for all of the cross validation done by both of
+// the parameter searches. Each fold's trainer then looks the distances up
+// rather than going over the features of the same pairs of samples again for
+// every fold of every (C, gamma) pair tried.
+void TrainedSvmDetector::createDistanceCache() {
+  trainingSampleIndices.clear();
+  for(unsigned long i = 0; i < training_samples.size(); ++i) {
+    trainingSampleIndices.push_back(i);
+  }
+#if defined(SHARED_DISTANCE_CACHE) && defined(RBF_KERNEL)
+  const size_t cacheMB = SampleDistanceCache::getBytesNeeded(
+      training_samples.size()) / (1024 * 1024);
+  if(!SampleDistanceCache::fitsInMemory(training_samples.size())) {
+    outputProgress(std::string("The distances between the ") +
+        Utils::intToString(training_samples.size()) + std::string(" samples ") +
+        std::string("would take up ") + Utils::intToString(cacheMB) +
+        std::string(" MB which won't fit in memory, so they'll be computed ") +
+        std::string("by each fold instead.\n"));
+    return;
+  }
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  distanceCache = new SampleDistanceCache(training_samples, 10);
+  outputProgress(std::string("Computed the distances between the ") +
+      Utils::intToString(training_samples.size()) + std::string(" samples (") +
+      Utils::intToString(cacheMB) + std::string(" MB) in ") +
+      Utils::doubleToString(std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - start).count()) +
+      std::string(" seconds.\n"));
+#endif
+}
+
+void TrainedSvmDetector::destroyDistanceCache() {
+  delete distanceCache;
+  distanceCache = NULL;
+}
+
 void TrainedSvmDetector::saveOptParams() {
   std::string param_path = predictorPath + (std::string)"_params";
   std::ofstream s(param_path.c_str());
@@ -420,6 +863,10 @@ void TrainedSvmDetector::trainFinalClassifier() {
   final_predictor.normalizer = normalizer;
   outputProgress("calling trainer.train()\n");
   final_predictor.function = trainer.train(training_samples, labels);
+  // the old prediction function (if any) was made from the old predictor
+  delete predictionFunction;
+  predictionFunction = NULL;
+  predictionCache->clear();
   outputProgress(std::string("The number of support vectors in the final learned function is: ") +
       Utils::intToString(final_predictor.function.basis_vectors.size()) +
       std::string("\n"));
@@ -438,19 +885,92 @@ void TrainedSvmDetector::loadPredictor() {
     assert(false);
   }
   deserialize(final_predictor, fin);
-  std::cout << "Predictor at " << predictorPath << " was successfully loaded!\n";
+  delete predictionFunction;
+  predictionFunction = SvmPredictionFunction::create(final_predictor);
+  predictionCache->clear();
+  std::cout << "Predictor at " << predictorPath << " was successfully loaded! ("
+      << predictionFunction->getName() << " prediction function)\n";
 }
 
-bool TrainedSvmDetector::predict(const std::vector<DoubleFeature*>& sample) {
-  sample_type sample_;
-  sample_.set_size(sample.size(), 1);
-  for(int i = 0; i < sample.size(); ++i)
-    sample_(i) = sample[i]->getFeature();
-  double result = final_predictor(sample_);
-  if(result < 0)
-    return false;
-  else
-    return true;
+sample_type TrainedSvmDetector::toDlibSample(
+    const std::vector<DoubleFeature*>& features) {
+#ifdef SPARSE_SAMPLES
+  return SparseSample::fromFeatures(features);
+#else
+  sample_type sample;
+  sample.set_size(features.size(), 1);
+  for(int k = 0; k < features.size(); ++k) {
+    sample(k) = features[k]->getFeature();
+  }
+  return sample;
+#endif
+}
+
+double TrainedSvmDetector::getDecisionScore(
+    const std::vector<DoubleFeature*>& sample) {
+#ifdef PREDICTION_CACHE
+  return predictionCache->predict(*predictionFunction, sample);
+#else
+  return (*predictionFunction)(sample);
+#endif
+}
+
+void TrainedSvmDetector::writeStats(const std::string& resultsDirName) {
+  std::cout << "Prediction cache:\n";
+  predictionCache->printStats(std::cout);
+  predictionCache->writeStatsFile(Utils::checkTrailingSlash(resultsDirName)
+      + "prediction_cache_stats.tsv");
+}
+
+// Times the loaded prediction function against the dynamically sized one
+// over all the blobs on the page and makes sure they agree (to within the
+// loaded one's error bound)
+void TrainedSvmDetector::dbgBenchmarkPrediction(BlobDataGrid* const blobDataGrid) {
+  DynamicSvmPrediction<decltype(final_predictor)> dynamicFunction(final_predictor);
+  std::vector<std::vector<DoubleFeature*> > pageSamples;
+  BlobDataGridSearch bdgs(blobDataGrid);
+  bdgs.StartFullSearch();
+  BlobData* blob = NULL;
+  while((blob = bdgs.NextFullSearch()) != NULL) {
+    pageSamples.push_back(blob->getExtractedFeatures());
+  }
+  const int reps = 20;
+  double dynamicSum = 0, loadedSum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(int r = 0; r < reps; ++r)
+    for(int i = 0; i < pageSamples.size(); ++i)
+      dynamicSum += dynamicFunction(pageSamples[i]);
+  std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+  for(int r = 0; r < reps; ++r)
+    for(int i = 0; i < pageSamples.size(); ++i)
+      loadedSum += (*predictionFunction)(pageSamples[i]);
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  const double dynamicMs = std::chrono::duration<double, std::milli>(mid - start).count();
+  const double loadedMs = std::chrono::duration<double, std::milli>(end - mid).count();
+  std::cout << "Prediction benchmark for " << blobDataGrid->getImageName() << " ("
+      << pageSamples.size() << " blobs x " << reps << "): dynamic " << dynamicMs
+      << " ms, " << predictionFunction->getName() << " " << loadedMs << " ms (speedup "
+      << (loadedMs > 0 ? dynamicMs / loadedMs : 0) << "x)\n";
+  for(int i = 0; i < pageSamples.size(); ++i) {
+    const double expected = dynamicFunction(pageSamples[i]);
+    const double actual = (*predictionFunction)(pageSamples[i]);
+    const double errorBound = predictionFunction->getErrorBound();
+    const bool agree = std::isinf(errorBound) ?
+        ((expected >= SVM_DECISION_THRESHOLD) == (actual >= SVM_DECISION_THRESHOLD)) :
+        (std::abs(expected - actual) <= errorBound + 1e-9 * (1 + std::abs(expected)));
+    if(!agree) {
+      std::cout << "ERROR: prediction functions disagree (" << expected
+          << " vs " << actual << ")\n";
+      assert(false);
+    }
+  }
+}
+
+TrainedSvmDetector::~TrainedSvmDetector() {
+  destroyDistanceCache();
+  delete predictionFunction;
+  predictionFunction = NULL;
+  delete predictionCache;
 }
 
 void TrainedSvmDetector::outputProgress(std::string progressStr) {
@@ -462,3 +982,86 @@ void TrainedSvmDetector::outputProgress(std::string progressStr) {
   progressFile.flush();
 #endif
 }
+
+// Trains a predictor from scratch with the same C and gamma on all of the old
+// pages' samples and the new ones that weren't held out (renormalizing them
+// all), then compares it against the incrementally updated one on the held
+// out samples, neither of which was trained on them
+void TrainedSvmDetector::compareWithFullRetrain(
+    const std::vector<std::vector<BLSample*> >& samples, const int firstNewImage,
+    const std::vector<sample_type>& newSamples,
+    const std::vector<double>& newLabels, const int heldOutCount,
+    const double updateSeconds) {
+  std::vector<sample_type> retrainSamples;
+  std::vector<double> retrainLabels;
+  for(int i = 0; i < firstNewImage; ++i) {
+    for(int j = 0; j < samples[i].size(); ++j) {
+      retrainSamples.push_back(toDlibSample(samples[i][j]->features));
+      retrainLabels.push_back(samples[i][j]->label ? +1 : -1);
+    }
+  }
+  retrainSamples.insert(retrainSamples.end(), newSamples.begin() + heldOutCount,
+      newSamples.end());
+  retrainLabels.insert(retrainLabels.end(), newLabels.begin() + heldOutCount,
+      newLabels.end());
+  const std::vector<sample_type> heldOutSamples(newSamples.begin(),
+      newSamples.begin() + heldOutCount);
+  const std::vector<double> heldOutLabels(newLabels.begin(),
+      newLabels.begin() + heldOutCount);
+
+  outputProgress(std::string("Retraining from scratch on ") +
+      Utils::intToString(retrainSamples.size()) +
+      std::string(" samples to compare against\n"));
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  sample_normalizer_type fullNormalizer;
+  fullNormalizer.train(retrainSamples);
+  std::vector<sample_type> normalizedSamples;
+  for(int i = 0; i < retrainSamples.size(); ++i) {
+    normalizedSamples.push_back(fullNormalizer(retrainSamples[i]));
+  }
+  dlib::randomize_samples(normalizedSamples, retrainLabels);
+#ifdef RBF_KERNEL
+  dlib::svm_c_trainer<RBFKernel> trainer;
+  trainer.set_kernel(RBFKernel(gamma_optimal));
+  RBFSVMNormalizedPredictor fullPredictor;
+#endif
+#ifdef LINEAR_KERNEL
+  dlib::svm_c_trainer<LinearKernel> trainer;
+  LinearSVMNormalizedPredictor fullPredictor;
+#endif
+  trainer.set_c(C_optimal);
+  fullPredictor.normalizer = fullNormalizer;
+  fullPredictor.function = trainer.train(normalizedSamples, retrainLabels);
+  const double fullSeconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+
+  int agreements = 0;
+  for(int i = 0; i < heldOutSamples.size(); ++i) {
+    if((final_predictor(heldOutSamples[i]) < 0)
+        == (fullPredictor(heldOutSamples[i]) < 0)) {
+      ++agreements;
+    }
+  }
+  const dlib::matrix<double, 1, 2> updatedAccuracy =
+      dlib::test_binary_decision_function(final_predictor, heldOutSamples,
+          heldOutLabels);
+  const dlib::matrix<double, 1, 2> fullAccuracy =
+      dlib::test_binary_decision_function(fullPredictor, heldOutSamples,
+          heldOutLabels);
+  outputProgress(std::string("Incremental update: ") +
+      Utils::doubleToString(updateSeconds) + std::string(" seconds, ") +
+      Utils::intToString(final_predictor.function.basis_vectors.size()) +
+      std::string(" support vectors, held out accuracy (positive, negative): ") +
+      Utils::doubleToString(updatedAccuracy(0, 0)) + std::string(", ") +
+      Utils::doubleToString(updatedAccuracy(0, 1)) + std::string("\n"));
+  outputProgress(std::string("Full retrain: ") +
+      Utils::doubleToString(fullSeconds) + std::string(" seconds, ") +
+      Utils::intToString(fullPredictor.function.basis_vectors.size()) +
+      std::string(" support vectors, held out accuracy (positive, negative): ") +
+      Utils::doubleToString(fullAccuracy(0, 0)) + std::string(", ") +
+      Utils::doubleToString(fullAccuracy(0, 1)) + std::string("\n"));
+  outputProgress(std::string("The two predictors agree on ") +
+      Utils::doubleToString(100. * (double)agreements / (double)heldOutSamples.size()) +
+      std::string("% of the held out samples\n"));
+}
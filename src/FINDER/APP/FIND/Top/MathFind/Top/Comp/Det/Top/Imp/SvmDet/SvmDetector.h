@@ -10,6 +10,7 @@
 
 #include <Detector.h>
 #include <BlobDataGrid.h>
+#include <SparseSample.h>
 
 #include <dlib/svm_threaded.h>
 
@@ -19,85 +20,97 @@
 
 #define PROGRESS_TO_FILE_OBJECTIVE
 
+// If chosen when training, the coarse grid search is done by successive
+// halving: every (C, gamma) pair is cross validated on a small stratified
+// subsample, the best 1/SUCCESSIVE_HALVING_ETA of them are kept and the
+// subsample is grown by the same factor until the survivors are cross
+// validated on all of the samples. Otherwise (and always when running in the
+// background) every pair is cross validated on all of the samples.
+#define SUCCESSIVE_HALVING_ETA 2
+
+// One in this many of the new pages' samples are held out of an incremental
+// update to measure its accuracy on
+#define INCREMENTAL_HOLDOUT_FOLDS 5
+
+// Blobs whose decision value is at least this are detected as math. The
+// decision values are kept on the blobs (and in saved detection states), so
+// other thresholds can be tried with --replay without running detection again.
+#define SVM_DECISION_THRESHOLD 0
+
+// When enabled the decision value for each feature vector is cached (see
+// SvmPredictionCache) so blobs with exactly the same features as one seen
+// before, on the same page or an earlier one, don't run the predictor again
+#define PREDICTION_CACHE
+
 // only one of the following should be enabled!
 // the chosen kernel is used for training
 #define RBF_KERNEL
 //#define LINEAR_KERNEL
 
+// When enabled the samples only hold their nonzero features (see
+// SparseSample.h) and dlib's sparse kernels are used for training and
+// prediction. This saves memory and time when most of the features are flags
+// or counts which are zero for nearly every blob (see SparseSampleBenchmark
+// for how much on a given set of samples). A predictor trained one way can't
+// be loaded the other way, so the sparse one is saved under its own name.
+//#define SPARSE_SAMPLES
+
+#ifdef SPARSE_SAMPLES
+typedef sparse_sample_type sample_type;
+typedef SparseScaleNormalizer sample_normalizer_type;
+typedef dlib::sparse_radial_basis_kernel<sample_type> RBFKernel;
+typedef dlib::sparse_linear_kernel<sample_type> LinearKernel;
+#else
 typedef dlib::matrix<double, 0, 1> sample_type;
+typedef dlib::vector_normalizer<sample_type> sample_normalizer_type;
+typedef dlib::radial_basis_kernel<sample_type> RBFKernel;
+typedef dlib::linear_kernel<sample_type> LinearKernel;
+#endif
 
 // RBF SVM Typedefs
-typedef dlib::radial_basis_kernel<sample_type> RBFKernel;
 typedef dlib::decision_function<RBFKernel> RBFSVMPredictor;
-typedef dlib::normalized_function<RBFSVMPredictor> RBFSVMNormalizedPredictor;
+typedef dlib::normalized_function<RBFSVMPredictor,
+    sample_normalizer_type> RBFSVMNormalizedPredictor;
 
 // Linear SVM Typedefs
-typedef dlib::linear_kernel<sample_type> LinearKernel;
 typedef dlib::decision_function<LinearKernel> LinearSVMPredictor;
-typedef dlib::normalized_function<LinearSVMPredictor> LinearSVMNormalizedPredictor;
+typedef dlib::normalized_function<LinearSVMPredictor,
+    sample_normalizer_type> LinearSVMNormalizedPredictor;
+
+class SampleDistanceCache;
+
+// When enabled (and the RBF kernel is being used) the squared distance
+// between every pair of training samples is computed once before the
+// parameter searches and shared by all of their cross validation, rather
+// than each fold of each (C, gamma) pair computing the kernel from scratch.
+// It's skipped if it wouldn't fit in memory (see SampleDistanceCache).
+#define SHARED_DISTANCE_CACHE
 
 // Copied from dlib's model_selection_ex.cpp with the following modifications:
 // - Divides the data into a variable number of subsets for cross validation.
 // - Uses C-SVM rather than Nu-SVM
 // - Uses multiple threads (one for each fold of cross validation)
+// - Uses the shared distance cache if one is given (RBF only)
 // - TODO: Modify cross validation return value to be maximized.
 class cross_validation_objective {
  public:
   cross_validation_objective (const std::vector<sample_type>& samples_,
       const std::vector<double>& labels_, int folds_,
-      std::ofstream* const progressFile) :
-        samples(samples_), labels(labels_), folds(folds_) {
+      std::ofstream* const progressFile,
+      const SampleDistanceCache* const cache_=NULL,
+      const std::vector<unsigned long>* const sampleIndices_=NULL) :
+        samples(samples_), labels(labels_), folds(folds_), cache(cache_),
+        sampleIndices(sampleIndices_) {
     this->progressFile = progressFile;
   }
 
-  double operator() (const dlib::matrix<double>& params) const {
-    // Pull out the two SVM model parameters.  Note that, in this case,
-    // I have setup the parameter search to operate in log scale so we have
-    // to remember to call exp() to put the parameters back into a normal scale.
-    const double C = std::exp(params(0));
-#ifdef RBF_KERNEL
-    const double gamma    = std::exp(params(1));
-
-    // Make an SVM trainer and tell it what the parameters are supposed to be.
-    dlib::svm_c_trainer<RBFKernel> trainer;
-    trainer.set_kernel(RBFKernel(gamma));
-#endif
-#ifdef LINEAR_KERNEL
-    dlib::svm_c_trainer<LinearKernel> trainer;
-#endif
-    trainer.set_c(C);
-
-    // Finally, perform 10-fold cross validation and then print and return the results.
-#ifdef LINEAR_KERNEL
-    cout << "Running cross validation on Linear Kernel SVM with ";
-    cout << "C: " << setw(11) << C << endl;
-#endif
-    dlib::matrix<double> result = dlib::cross_validate_trainer_threaded(trainer, samples, labels, folds, folds);
-#ifdef RBF_KERNEL
-    outputProgress(std::string("C: ") + Utils::doubleToString(C, 11) +
-        std::string("  gamma: ") + Utils::doubleToString(gamma, 11) +
-        std::string("  cross validation accuracy: ") +
-        Utils::doubleToString(result(0, 0), 11) + std::string(", ") +
-        Utils::doubleToString(result(0, 1), 11) + std::string("\n"));
-#endif
-#ifdef LINEAR_KERNEL
-    std::cout << "C: " << std::setw(11) << C
-        << "   cross validation accuracy:  " << result;
-#endif
-
-
-    // Here I'm just summing the accuracy on each class.  However, you could do something else.
-    // For example, your application might require a 90% accuracy on class +1 and so you could
-    // heavily penalize results that didn't obtain the desired accuracy.  Or similarly, you
-    // might use the roc_c1_trainer() function to adjust the trainer output so that it always
-    // obtained roughly a 90% accuracy on class +1.  In that case returning the sum of the two
-    // class accuracies might be appropriate.
-    return sum(result);
-  }
+  double operator() (const dlib::matrix<double>& params) const;
 
   const std::vector<sample_type>& samples;
   const std::vector<double>& labels;
   int folds;
+  const SampleDistanceCache* cache;
+  const std::vector<unsigned long>* sampleIndices; // into the cache
 
   std::ofstream* progressFile;
   void outputProgress(std::string progressStr) const {
@@ -109,6 +122,9 @@ class cross_validation_objective {
   }
 };
 
+class SvmPredictionFunction;
+class SvmPredictionCache;
+
 class TrainedSvmDetector : virtual public MathExpressionDetector {
  public:
 
@@ -124,28 +140,81 @@ class TrainedSvmDetector : virtual public MathExpressionDetector {
 
   bool doTraining(const std::vector<std::vector<BLSample*> >& samples);
 
+  bool canTrainFromFile() { return true; }
+
+  /**
+   * Streams the samples from the sample file in chunks (see SampleChunkReader),
+   * making one pass to set up the normalizer and another to load the
+   * normalized samples, then trains on them just like doTraining.
+   */
+  bool doTrainingFromFile(const std::string& samplePath);
+
+  /**
+   * Retrains the saved predictor on its own support vectors plus the samples
+   * from the new pages, reusing the saved C and gamma and the original
+   * normalizer, so neither the parameter search nor the old pages' samples
+   * have to be redone. Its accuracy is reported on a held out part of the new
+   * pages' samples (see INCREMENTAL_HOLDOUT_FOLDS) and, if asked, compared to
+   * that of a full retrain. Falls back on doTraining if nothing was saved yet.
+   */
+  bool doIncrementalTraining(const std::vector<std::vector<BLSample*> >& samples,
+      const int firstNewImage, const bool compareToFullRetrain);
+
+  /**
+   * Prints how well the predictions were cached (see SvmPredictionCache) and
+   * writes it to prediction_cache_stats.tsv in the results directory
+   */
+  void writeStats(const std::string& resultsDirName);
+
+  ~TrainedSvmDetector();
+
  private:
 
   void doCoarseCVTraining(int folds); // coarse grid search to find starting params for doFineCVTraining
+  void doSuccessiveHalvingSearch(const dlib::matrix<double>& grid,
+      int folds); // multi-fidelity version of the coarse grid search
+  dlib::matrix<double> crossValidateGridPoint(const dlib::matrix<double>& grid,
+      const int gridIndex, const std::vector<sample_type>& samples,
+      const std::vector<unsigned long>& sampleIndices,
+      const std::vector<double>& labels, int folds); // returns (positive, negative) accuracy
   void doFineCVTraining(int folds); // uses BOBYQA to get final optimized params
 
+  void createDistanceCache(); // for the cross validation of the training samples
+  void destroyDistanceCache();
+
   void saveOptParams(); // save optimal parameters for later use
   bool loadOptParams(); // load optimal paramaters for given predictor if they don't exist
                         // returns false
 
+  // everything in training after the samples are loaded and normalized
+  bool trainOnNormalizedSamples();
+
   void trainFinalClassifier();
 
   void savePredictor(); // serialize and save the predictor for later use
-  void loadPredictor(); // read in a previously serialized predictor
+  void loadPredictor(); // read in a previously serialized predictor and pick the
+                        // prediction function specialized to its feature dimension
+
+  // the SVM's decision value for the sample (math if at least SVM_DECISION_THRESHOLD)
+  double getDecisionScore(const std::vector<DoubleFeature*>& sample);
 
-  bool predict(const std::vector<DoubleFeature*>& sample);
+  sample_type toDlibSample(const std::vector<DoubleFeature*>& features);
 
   // the training samples and their corresponding labels
   // obviously these two vectors should be the same size
   std::vector<sample_type> training_samples;
   std::vector<double> labels;
 
-  dlib::vector_normalizer<sample_type> normalizer;
+  // distances between the training samples shared by the parameter searches
+  // (NULL if there isn't one) along with the index of each sample into it
+  SampleDistanceCache* distanceCache;
+  std::vector<unsigned long> trainingSampleIndices;
+
+  sample_normalizer_type normalizer;
+
+  // whether doCoarseCVTraining searches by successive halving rather than
+  // cross validating the whole grid on all of the samples
+  bool successiveHalvingSearch;
 
   // the optimal gamma and C parameters for the SVM
 #ifdef RBF_KERNEL
@@ -162,6 +231,31 @@ class TrainedSvmDetector : virtual public MathExpressionDetector {
   LinearSVMNormalizedPredictor final_predictor;
 #endif
 
+  // evaluates final_predictor, created when the predictor is loaded
+  // (NULL until then)
+  SvmPredictionFunction* predictionFunction;
+
+  // decision values already worked out by predictionFunction, kept for all
+  // of the pages and cleared whenever the predictor changes
+  SvmPredictionCache* predictionCache;
+
+  // Retrains final_predictor on the old predictor's support vectors and the
+  // new samples from firstUsed on, returns how many seconds it took
+  double updateFromSupportVectors(const std::vector<sample_type>& supportVectors,
+      const std::vector<double>& supportVectorLabels,
+      const std::vector<sample_type>& newSamples,
+      const std::vector<double>& newLabels, const int firstUsed);
+
+  // Compares the incrementally updated predictor with one trained from scratch
+  // on the held out samples (the first heldOutCount of newSamples)
+  void compareWithFullRetrain(const std::vector<std::vector<BLSample*> >& samples,
+      const int firstNewImage, const std::vector<sample_type>& newSamples,
+      const std::vector<double>& newLabels, const int heldOutCount,
+      const double updateSeconds);
+
+  // dbg
+  void dbgBenchmarkPrediction(BlobDataGrid* const blobDataGrid);
+
   std::string predictorPath;
 
   std::string progressFilePath;
@@ -0,0 +1,238 @@
+/*
+ * BoundedRBF.cpp
+ */
+
+#include <BoundedRBF.h>
+
+#include <Utils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+#include <assert.h>
+
+#if defined(RBF_KERNEL) && !defined(SPARSE_SAMPLES)
+
+BoundedErrorRBFPrediction::BoundedErrorRBFPrediction(
+    const RBFSVMNormalizedPredictor& predictor, const double tolerance)
+: tolerance(tolerance) {
+  dim = predictor.normalizer.in_vector_size();
+  means.resize(dim);
+  invStdDevs.resize(dim);
+  for(long i = 0; i < dim; ++i) {
+    means[i] = predictor.normalizer.means()(i);
+    invStdDevs[i] = predictor.normalizer.std_devs()(i); // already stored as 1/stddev
+  }
+  const RBFSVMPredictor& function = predictor.function;
+  gamma = function.kernel_function.gamma;
+  b = function.b;
+
+  const long numSupportVectors = function.basis_vectors.size();
+  std::vector<double> vectors(numSupportVectors * dim);
+  std::vector<double> vectorAlphas(numSupportVectors);
+  std::vector<long> order(numSupportVectors);
+  double totalAbsAlpha = 0;
+  for(long i = 0; i < numSupportVectors; ++i) {
+    for(long j = 0; j < dim; ++j) {
+      vectors[i * dim + j] = function.basis_vectors(i)(j);
+    }
+    vectorAlphas[i] = function.alpha(i);
+    totalAbsAlpha += std::abs(vectorAlphas[i]);
+    order[i] = i;
+  }
+
+  // every support vector past the radius together adds at most
+  // totalAbsAlpha * exp(-gamma * radius), which is the tolerance
+  radius = (totalAbsAlpha > tolerance) ?
+      std::log(totalAbsAlpha / tolerance) / gamma : 0;
+  radiusKernel = std::exp(-gamma * radius);
+
+  if(numSupportVectors > 0) {
+    buildTree(order, 0, numSupportVectors, vectors, vectorAlphas);
+  }
+
+  // lay the support vectors out in the order the leaves refer to them in
+  supportVectors.resize(numSupportVectors * dim);
+  alphas.resize(numSupportVectors);
+  for(long i = 0; i < numSupportVectors; ++i) {
+    std::copy(vectors.begin() + order[i] * dim,
+        vectors.begin() + (order[i] + 1) * dim, supportVectors.begin() + i * dim);
+    alphas[i] = vectorAlphas[order[i]];
+  }
+}
+
+long BoundedErrorRBFPrediction::buildTree(std::vector<long>& order,
+    const long begin, const long end, const std::vector<double>& vectors,
+    const std::vector<double>& vectorAlphas) {
+  const long nodeIndex = nodes.size();
+  Node node;
+  node.begin = begin;
+  node.end = end;
+  node.left = -1;
+  node.right = -1;
+  node.absAlphaSum = 0;
+  nodes.push_back(node);
+
+  // the node's bounding box
+  boxes.resize(boxes.size() + 2 * dim);
+  double* const lower = &boxes[nodeIndex * 2 * dim];
+  double* const upper = lower + dim;
+  std::copy(vectors.begin() + order[begin] * dim,
+      vectors.begin() + (order[begin] + 1) * dim, lower);
+  std::copy(lower, lower + dim, upper);
+  double absAlphaSum = 0;
+  for(long i = begin; i < end; ++i) {
+    const double* const v = &vectors[order[i] * dim];
+    for(long j = 0; j < dim; ++j) {
+      lower[j] = std::min(lower[j], v[j]);
+      upper[j] = std::max(upper[j], v[j]);
+    }
+    absAlphaSum += std::abs(vectorAlphas[order[i]]);
+  }
+  nodes[nodeIndex].absAlphaSum = absAlphaSum;
+  if(end - begin <= BOUNDED_RBF_LEAF_SIZE) {
+    return nodeIndex;
+  }
+
+  // split at the median of the dimension the box is widest in
+  long splitDim = 0;
+  for(long j = 1; j < dim; ++j) {
+    if(upper[j] - lower[j] > upper[splitDim] - lower[splitDim]) {
+      splitDim = j;
+    }
+  }
+  const long middle = begin + (end - begin) / 2;
+  std::nth_element(order.begin() + begin, order.begin() + middle,
+      order.begin() + end, [&vectors, splitDim, this](const long a, const long c) {
+    return vectors[a * dim + splitDim] < vectors[c * dim + splitDim];
+  });
+  // building the children grows the nodes and boxes, so this node can only be
+  // got at by its index from here on
+  const long left = buildTree(order, begin, middle, vectors, vectorAlphas);
+  const long right = buildTree(order, middle, end, vectors, vectorAlphas);
+  nodes[nodeIndex].left = left;
+  nodes[nodeIndex].right = right;
+  return nodeIndex;
+}
+
+double BoundedErrorRBFPrediction::boxDistance(const double* const x,
+    const long node) const {
+  const double* const lower = &boxes[node * 2 * dim];
+  const double* const upper = lower + dim;
+  double dist = 0;
+  for(long j = 0; j < dim; ++j) {
+    double diff = 0;
+    if(x[j] < lower[j]) {
+      diff = lower[j] - x[j];
+    } else if(x[j] > upper[j]) {
+      diff = x[j] - upper[j];
+    }
+    dist += diff * diff;
+  }
+  return dist;
+}
+
+// A node waiting to be visited along with its squared distance from the sample
+struct QueuedNode {
+  double dist;
+  long node;
+  bool operator>(const QueuedNode& other) const {
+    return dist > other.dist;
+  }
+};
+
+double BoundedErrorRBFPrediction::operator()(
+    const std::vector<DoubleFeature*>& features) const {
+  assert(features.size() == dim);
+  std::vector<double> x(dim);
+  for(long i = 0; i < dim; ++i) {
+    x[i] = (features[i]->getFeature() - means[i]) * invStdDevs[i];
+  }
+  if(nodes.empty()) {
+    return -b;
+  }
+
+  // the |alpha|s of the support vectors that haven't been evaluated, split
+  // into the ones waiting in the queue (which are all at least as far away as
+  // the nearest one in it) and the most the ones left out for being past the
+  // radius could add
+  double remainingAbsAlpha = nodes[0].absAlphaSum;
+  double skipped = 0;
+  std::priority_queue<QueuedNode, std::vector<QueuedNode>,
+      std::greater<QueuedNode> > queue;
+  QueuedNode root;
+  root.dist = boxDistance(&x[0], 0);
+  root.node = 0;
+  queue.push(root);
+
+  double result = 0;
+  while(!queue.empty()) {
+    const QueuedNode next = queue.top();
+    // everything left is at least as far away as this, so past the radius
+    // all of it together is within the tolerance
+    if(next.dist > radius) {
+      break;
+    }
+    const double remainingBound =
+        remainingAbsAlpha * std::exp(-gamma * next.dist) + skipped;
+    if(remainingBound <= tolerance) {
+      break;
+    }
+#ifdef BOUNDED_RBF_EARLY_STOP
+    if(std::abs(result - b - SVM_DECISION_THRESHOLD) > remainingBound) {
+      break;
+    }
+#endif
+    queue.pop();
+    const Node& node = nodes[next.node];
+    if(node.left < 0) {
+      remainingAbsAlpha -= node.absAlphaSum;
+      for(long i = node.begin; i < node.end; ++i) {
+        const double* const sv = &supportVectors[i * dim];
+        double dist = 0;
+        for(long j = 0; j < dim; ++j) {
+          const double diff = x[j] - sv[j];
+          dist += diff * diff;
+        }
+        if(dist > radius) {
+          skipped += std::abs(alphas[i]) * radiusKernel;
+        } else {
+          result += alphas[i] * std::exp(-gamma * dist);
+        }
+      }
+      continue;
+    }
+    const long children[2] = { node.left, node.right };
+    for(int i = 0; i < 2; ++i) {
+      QueuedNode child;
+      child.dist = boxDistance(&x[0], children[i]);
+      child.node = children[i];
+      if(child.dist > radius) {
+        remainingAbsAlpha -= nodes[child.node].absAlphaSum;
+        skipped += nodes[child.node].absAlphaSum * radiusKernel;
+      } else {
+        queue.push(child);
+      }
+    }
+  }
+  return result - b;
+}
+
+std::string BoundedErrorRBFPrediction::getName() const {
+  return std::string("bounded error (") + Utils::intToString((int)nodes.size())
+      + std::string(" node tree, tolerance ") + Utils::doubleToString(tolerance)
+      + std::string(")");
+}
+
+double BoundedErrorRBFPrediction::getErrorBound() const {
+#ifdef BOUNDED_RBF_EARLY_STOP
+  return HUGE_VAL; // only the side of the threshold is certain
+#else
+  return tolerance;
+#endif
+}
+
+#endif
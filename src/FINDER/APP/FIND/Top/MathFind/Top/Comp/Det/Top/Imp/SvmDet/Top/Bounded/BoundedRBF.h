@@ -0,0 +1,102 @@
+/*
+ * BoundedRBF.h
+ */
+
+#ifndef BOUNDEDRBF_H_
+#define BOUNDEDRBF_H_
+
+#include <SvmPrediction.h>
+#include <SvmDetector.h>
+
+#include <DoubleFeature.h>
+
+#include <string>
+#include <vector>
+
+// When enabled the loaded RBF predictor is evaluated by
+// BoundedErrorRBFPrediction rather than the fixed size prediction function.
+// Its decision values are only guaranteed to be within
+// PREDICTION_ERROR_TOLERANCE of the exact ones, so it's worth it when the
+// predictor has a lot of support vectors and most of them are far from any
+// given blob (run with DBG_BENCHMARK_PREDICTION to compare the two).
+//#define BOUNDED_ERROR_PREDICTION
+
+// Most a bounded error decision value may be off from the exact one by
+#define PREDICTION_ERROR_TOLERANCE 1e-6
+
+// Most support vectors in a leaf of the bounded error prediction's tree
+#define BOUNDED_RBF_LEAF_SIZE 8
+
+// When enabled a bounded error prediction stops as soon as it's certain which
+// side of SVM_DECISION_THRESHOLD the decision value is on. The value it gives
+// back is then on the right side but isn't within the tolerance, which throws
+// off the detection scores kept for trying other thresholds, so it's off.
+//#define BOUNDED_RBF_EARLY_STOP
+
+#if defined(RBF_KERNEL) && !defined(SPARSE_SAMPLES)
+/**
+ * RBF decision function which only evaluates the support vectors close
+ * enough to the sample to matter. A support vector at squared distance d from
+ * the sample adds at most |alpha| * exp(-gamma * d) to the decision value, so
+ * once every support vector left is farther than the radius at which even all
+ * of their alphas together couldn't add up to the tolerance, the rest can be
+ * skipped.
+ *
+ * The (normalized) support vectors are put in a k-d tree where each node
+ * keeps the bounding box and the sum of the |alpha|s of the support vectors
+ * under it. The nodes are visited nearest first, so the support vectors not
+ * evaluated yet are all at least as far away as the next node, which bounds
+ * how much they could still add to the decision value. The prediction stops
+ * as soon as that's within the tolerance or the next node is past the radius.
+ */
+class BoundedErrorRBFPrediction : public SvmPredictionFunction {
+ public:
+  BoundedErrorRBFPrediction(const RBFSVMNormalizedPredictor& predictor,
+      const double tolerance=PREDICTION_ERROR_TOLERANCE);
+
+  double operator()(const std::vector<DoubleFeature*>& features) const;
+
+  std::string getName() const;
+
+  double getErrorBound() const;
+
+ private:
+
+  struct Node {
+    long begin; // the range of support vectors (in tree order) under the node
+    long end;
+    long left; // child nodes (-1 for a leaf)
+    long right;
+    double absAlphaSum; // sum of the |alpha|s of the support vectors under it
+  };
+
+  // Builds the subtree over the given range of the support vector order,
+  // returns the index of its root node
+  long buildTree(std::vector<long>& order, const long begin, const long end,
+      const std::vector<double>& vectors, const std::vector<double>& vectorAlphas);
+
+  // Squared distance from the sample to the node's bounding box (0 if inside)
+  double boxDistance(const double* const x, const long node) const;
+
+  long dim;
+  std::vector<double> means;
+  std::vector<double> invStdDevs;
+  double gamma;
+  double b;
+  double tolerance;
+
+  // squared distance past which the support vectors are skipped, and the
+  // most any one of them can add per unit of |alpha| at that distance
+  double radius;
+  double radiusKernel;
+
+  // the support vectors (dim values each) and their alphas in tree order
+  std::vector<double> supportVectors;
+  std::vector<double> alphas;
+
+  std::vector<Node> nodes; // the root is the first
+  std::vector<double> boxes; // lower then upper corner of each node's box
+};
+#endif
+
+#endif /* BOUNDEDRBF_H_ */
@@ -0,0 +1,94 @@
+/*
+ * DistanceCache.cpp
+ */
+
+#include <DistanceCache.h>
+
+#include <SvmDetector.h>
+#include <SparseSample.h>
+
+#include <dlib/svm_threaded.h>
+#include <dlib/threads.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+SampleDistanceCache::SampleDistanceCache(
+    const std::vector<sample_type>& samples, const int numThreads)
+: samples(&samples), sampleCount(samples.size()) {
+  distances.resize(getBytesNeeded(sampleCount) / sizeof(float));
+  const int threads = (numThreads > 0) ? numThreads : 1;
+  dlib::thread_pool threadPool(threads);
+  for(long i = 0; i < threads; ++i) {
+    threadPool.add_task(*this, &SampleDistanceCache::computeRows, i, (long)threads);
+  }
+  threadPool.wait_for_all_tasks();
+  this->samples = NULL;
+}
+
+void SampleDistanceCache::computeRows(long firstRow, long rowStep) {
+  for(long a = firstRow; a < sampleCount; a += rowStep) {
+    // (distances is empty when there are fewer than two samples, so it can't
+    // be indexed into even for the empty first row)
+    float* const row = distances.data() + a * (a - 1) / 2;
+    const sample_type& sampleA = (*samples)[a];
+    for(long b = 0; b < a; ++b) {
+#ifdef SPARSE_SAMPLES
+      row[b] = dlib::distance_squared(sampleA, (*samples)[b]);
+#else
+      row[b] = dlib::length_squared(sampleA - (*samples)[b]);
+#endif
+    }
+  }
+}
+
+long SampleDistanceCache::getSampleCount() const {
+  return sampleCount;
+}
+
+bool SampleDistanceCache::fitsInMemory(const long numSamples) {
+  const double neededMB = getBytesNeeded(numSamples) / (1024. * 1024.);
+  if(neededMB > MAX_DISTANCE_CACHE_MB) {
+    return false;
+  }
+  // leave at least half of what's available for the SVM trainers
+  std::ifstream meminfo("/proc/meminfo");
+  std::string line;
+  while(std::getline(meminfo, line)) {
+    if(line.compare(0, 13, "MemAvailable:") == 0) {
+      std::istringstream lineStream(line.substr(13));
+      long availableKB = 0;
+      lineStream >> availableKB;
+      return neededMB < (availableKB / 1024.) / 2;
+    }
+  }
+  return true; // can't tell, so just go by the maximum
+}
+
+size_t SampleDistanceCache::getBytesNeeded(const long numSamples) {
+  if(numSamples < 2) {
+    return 0;
+  }
+  return (size_t)numSamples * (numSamples - 1) / 2 * sizeof(float);
+}
+
+dlib::matrix<double> SampleDistanceCache::crossValidateRBF(
+    const SampleDistanceCache* const cache, const double C,
+    const double gamma, const std::vector<sample_type>& samples,
+    const std::vector<unsigned long>& sampleIndices,
+    const std::vector<double>& labels, const int folds) {
+  if(cache == NULL) {
+    dlib::svm_c_trainer<RBFKernel> trainer;
+    trainer.set_kernel(RBFKernel(gamma));
+    trainer.set_c(C);
+    return dlib::cross_validate_trainer_threaded(trainer, samples, labels,
+        folds, folds); // last arg is the number of threads (using same as folds)
+  }
+  dlib::svm_c_trainer<CachedRBFKernel> trainer;
+  trainer.set_kernel(CachedRBFKernel(gamma, cache));
+  trainer.set_c(C);
+  return dlib::cross_validate_trainer_threaded(trainer, sampleIndices, labels,
+      folds, folds);
+}
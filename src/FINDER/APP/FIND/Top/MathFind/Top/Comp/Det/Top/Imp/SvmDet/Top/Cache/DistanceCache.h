@@ -0,0 +1,109 @@
+/*
+ * DistanceCache.h
+ */
+
+#ifndef DISTANCECACHE_H_
+#define DISTANCECACHE_H_
+
+#include <SvmDetector.h>
+
+#include <dlib/svm_threaded.h>
+
+#include <cmath>
+#include <vector>
+
+// Most memory (in megabytes) the distance cache is allowed to take up. It's
+// also never allowed more than half of the memory currently available.
+#define MAX_DISTANCE_CACHE_MB 4096
+
+/**
+ * The squared distance between every pair of the (normalized) training
+ * samples, computed once and then shared by every fold and every (C, gamma)
+ * pair of the cross validation searches. The RBF kernel only depends on
+ * the samples through this distance, so with the cache the kernel can be
+ * evaluated with a lookup and an exp rather than going over all of the
+ * features again in every fold of every grid point. Only the lower triangle
+ * is kept (as floats) so the cache takes up about 2n^2 bytes for n samples.
+ */
+class SampleDistanceCache {
+ public:
+
+  /**
+   * Computes the distances between all of the samples using the given
+   * number of threads. The samples aren't needed once it's done.
+   */
+  SampleDistanceCache(const std::vector<sample_type>& samples,
+      const int numThreads);
+
+  /**
+   * Squared distance between the samples at the given indexes
+   */
+  inline double operator()(const unsigned long a, const unsigned long b) const {
+    if(a == b) {
+      return 0;
+    }
+    return (a > b) ? distances[a * (a - 1) / 2 + b]
+        : distances[b * (b - 1) / 2 + a];
+  }
+
+  long getSampleCount() const;
+
+  /**
+   * True if the cache for the given number of samples fits within both
+   * MAX_DISTANCE_CACHE_MB and half of the memory currently available
+   */
+  static bool fitsInMemory(const long numSamples);
+
+  static size_t getBytesNeeded(const long numSamples);
+
+  /**
+   * Cross validates a C-SVM with an RBF kernel, running the folds on
+   * separate threads, and returns the (positive, negative) accuracy just
+   * like dlib's cross_validate_trainer_threaded. If a cache is given then
+   * the samples are stood in for by their indexes into it, otherwise the
+   * samples themselves are used.
+   */
+  static dlib::matrix<double> crossValidateRBF(
+      const SampleDistanceCache* const cache, const double C,
+      const double gamma, const std::vector<sample_type>& samples,
+      const std::vector<unsigned long>& sampleIndices,
+      const std::vector<double>& labels, const int folds);
+
+ private:
+
+  // Computes every numThreads'th row starting from the given one
+  void computeRows(long firstRow, long rowStep);
+
+  const std::vector<sample_type>* samples; // only set while computing
+  long sampleCount;
+  std::vector<float> distances;
+};
+
+/**
+ * RBF kernel whose samples are indexes into a SampleDistanceCache. Any
+ * decision function trained with it only makes sense with the same cache,
+ * so it's only used for cross validation.
+ */
+struct CachedRBFKernel {
+  typedef double scalar_type;
+  typedef unsigned long sample_type;
+  typedef dlib::default_memory_manager mem_manager_type;
+
+  CachedRBFKernel() : gamma(0.1), cache(NULL) {}
+  CachedRBFKernel(const double gamma, const SampleDistanceCache* const cache)
+    : gamma(gamma), cache(cache) {}
+
+  inline scalar_type operator()(const sample_type& a, const sample_type& b) const {
+    return std::exp(-gamma * (*cache)(a, b));
+  }
+
+  bool operator==(const CachedRBFKernel& k) const {
+    return gamma == k.gamma && cache == k.cache;
+  }
+
+  double gamma;
+  const SampleDistanceCache* cache;
+};
+
+
+#endif /* DISTANCECACHE_H_ */
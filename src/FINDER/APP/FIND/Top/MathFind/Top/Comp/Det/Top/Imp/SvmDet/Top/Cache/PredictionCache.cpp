@@ -0,0 +1,74 @@
+/*
+ * PredictionCache.cpp
+ */
+
+#include <PredictionCache.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <assert.h>
+#include <string.h>
+
+SvmPredictionCache::SvmPredictionCache() : resets(0), hits(0), misses(0),
+    missSeconds(0) {}
+
+double SvmPredictionCache::predict(const SvmPredictionFunction& function,
+    const std::vector<DoubleFeature*>& features) {
+  const std::string key = getKey(features);
+  std::unordered_map<std::string, double>::const_iterator it = entries.find(key);
+  if(it != entries.end()) {
+    ++hits;
+    return it->second;
+  }
+
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  const double score = function(features);
+  missSeconds += std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  ++misses;
+  if(entries.size() >= MAX_PREDICTION_CACHE_ENTRIES) {
+    entries.clear();
+    ++resets;
+  }
+  entries[key] = score;
+  return score;
+}
+
+void SvmPredictionCache::clear() {
+  entries.clear();
+}
+
+std::string SvmPredictionCache::getKey(
+    const std::vector<DoubleFeature*>& features) {
+  std::string key(features.size() * sizeof(double), '\0');
+  for(int i = 0; i < features.size(); ++i) {
+    const double feature = features[i]->getFeature();
+    memcpy(&key[i * sizeof(double)], &feature, sizeof(double));
+  }
+  return key;
+}
+
+void SvmPredictionCache::printStats(std::ostream& stream) {
+  const long total = hits + misses;
+  const double hitRate = (total > 0) ? (double)hits / total : 0;
+  // each hit saves about as long as the average miss took to predict
+  const double secondsSaved = (misses > 0) ? hits * (missSeconds / misses) : 0;
+  stream << "hits\tmisses\thit_rate\tpredict_seconds\tseconds_saved\n";
+  stream << hits << "\t" << misses << "\t" << hitRate << "\t" << missSeconds
+      << "\t" << secondsSaved << "\n";
+  stream << "# " << entries.size() << " feature vectors cached, cleared out "
+      << resets << " times after reaching " << MAX_PREDICTION_CACHE_ENTRIES << "\n";
+}
+
+void SvmPredictionCache::writeStatsFile(const std::string& path) {
+  std::ofstream stream(path.c_str());
+  if(!stream.is_open()) {
+    std::cout << "ERROR: Could not open " << path << " to write the prediction cache stats to\n";
+    assert(false);
+  }
+  printStats(stream);
+}
@@ -0,0 +1,73 @@
+/*
+ * PredictionCache.h
+ */
+
+#ifndef PREDICTIONCACHE_H_
+#define PREDICTIONCACHE_H_
+
+#include <SvmPrediction.h>
+
+#include <DoubleFeature.h>
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Most feature vectors the cache holds before it's cleared out and started over
+#define MAX_PREDICTION_CACHE_ENTRIES 100000
+
+/**
+ * Remembers the decision value for each feature vector the detector has run
+ * the predictor on. On text pages a lot of blobs (e.g., the lowercase letters
+ * of valid words on normal rows) end up with exactly the same features once
+ * they're made up of counts and flags, and they'd otherwise each go through
+ * the whole kernel expansion. The vectors are keyed by the bit patterns of
+ * their features, so a cached decision value is exactly the one the predictor
+ * would have given. The detector keeps one cache for all of the pages it's
+ * run on and clears it whenever its predictor changes. When it fills up (see
+ * MAX_PREDICTION_CACHE_ENTRIES) it's just emptied out, since the common
+ * vectors that matter most are quick to come back. Not thread safe (the
+ * detector only runs on one page at a time).
+ */
+class SvmPredictionCache {
+ public:
+
+  SvmPredictionCache();
+
+  /**
+   * Same as function(features), from the cache if the same features were
+   * seen before
+   */
+  double predict(const SvmPredictionFunction& function,
+      const std::vector<DoubleFeature*>& features);
+
+  /**
+   * Empties the cache (the stats are kept)
+   */
+  void clear();
+
+  /**
+   * Prints the hits, misses, and estimated time saved
+   */
+  void printStats(std::ostream& stream);
+
+  /**
+   * Writes the same stats as printStats to the given file
+   */
+  void writeStatsFile(const std::string& path);
+
+ private:
+
+  // the bit patterns of the features one after the other
+  static std::string getKey(const std::vector<DoubleFeature*>& features);
+
+  std::unordered_map<std::string, double> entries;
+  long resets;
+  long hits;
+  long misses;
+  double missSeconds; // total time spent running the predictor on misses
+};
+
+
+#endif /* PREDICTIONCACHE_H_ */
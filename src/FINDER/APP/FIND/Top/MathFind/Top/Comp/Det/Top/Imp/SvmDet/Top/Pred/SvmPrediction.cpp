@@ -0,0 +1,64 @@
+/*
+ * SvmPrediction.cpp
+ */
+
+#include <SvmPrediction.h>
+
+#include <SvmDetector.h>
+#include <BoundedRBF.h>
+
+#include <dlib/svm_threaded.h>
+
+#if defined(RBF_KERNEL) && !defined(SPARSE_SAMPLES)
+/**
+ * Walks down from N to 1 looking for the fixed size function matching
+ * the predictor's dimension. Returns NULL if there isn't one.
+ */
+template <long N>
+struct FixedDimRBFDispatch {
+  static SvmPredictionFunction* create(const RBFSVMNormalizedPredictor& predictor,
+      const long dim) {
+    if(dim == N) {
+      return new FixedDimRBFPrediction<N>(predictor);
+    }
+    return FixedDimRBFDispatch<N - 1>::create(predictor, dim);
+  }
+};
+
+template <>
+struct FixedDimRBFDispatch<0> {
+  static SvmPredictionFunction* create(const RBFSVMNormalizedPredictor& predictor,
+      const long dim) {
+    return NULL;
+  }
+};
+
+SvmPredictionFunction* SvmPredictionFunction::create(
+    const RBFSVMNormalizedPredictor& predictor) {
+#ifdef BOUNDED_ERROR_PREDICTION
+  return new BoundedErrorRBFPrediction(predictor);
+#endif
+  SvmPredictionFunction* fixed =
+      FixedDimRBFDispatch<MAX_FIXED_FEATURE_DIM>::create(predictor,
+          predictor.normalizer.in_vector_size());
+  if(fixed != NULL) {
+    return fixed;
+  }
+  return new DynamicSvmPrediction<RBFSVMNormalizedPredictor>(predictor);
+}
+#endif
+
+#if defined(RBF_KERNEL) && defined(SPARSE_SAMPLES)
+SvmPredictionFunction* SvmPredictionFunction::create(
+    const RBFSVMNormalizedPredictor& predictor) {
+  return new SparseRBFPrediction(predictor);
+}
+#endif
+
+#ifdef LINEAR_KERNEL
+SvmPredictionFunction* SvmPredictionFunction::create(
+    const LinearSVMNormalizedPredictor& predictor) {
+  // a linear predictor is already just one dot product so it isn't specialized
+  return new DynamicSvmPrediction<LinearSVMNormalizedPredictor>(predictor);
+}
+#endif
@@ -0,0 +1,235 @@
+/*
+ * SvmPrediction.h
+ */
+
+#ifndef SVMPREDICTION_H_
+#define SVMPREDICTION_H_
+
+#include <SvmDetector.h>
+#include <SparseSample.h>
+
+#include <DoubleFeature.h>
+#include <Utils.h>
+
+#include <dlib/svm_threaded.h>
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <assert.h>
+
+// Largest feature dimension for which a fixed size prediction function is
+// compiled. Finders with more features than this use the dynamic one.
+#define MAX_FIXED_FEATURE_DIM 32
+
+/**
+ * Evaluates a trained SVM's decision function on a blob's features. The
+ * predictor deserialized by the detector works on dynamically sized samples
+ * which means every prediction allocates its sample (and the normalized copy)
+ * on the heap and loops over runtime sized vectors for every support vector.
+ * Since the number of features is fixed once a finder has been trained, the
+ * detector instead asks create() for an implementation specialized to that
+ * number when it loads its predictor.
+ */
+class SvmPredictionFunction {
+ public:
+
+  /**
+   * Returns the raw value of the decision function for the given features
+   * (positive means math)
+   */
+  virtual double operator()(const std::vector<DoubleFeature*>& features) const = 0;
+
+  /**
+   * Short description of the implementation for progress and debug output
+   */
+  virtual std::string getName() const = 0;
+
+  /**
+   * Most the decision value can be off from the exact one by (0 for the ones
+   * which compute it exactly, up to rounding)
+   */
+  virtual double getErrorBound() const {
+    return 0;
+  }
+
+  virtual ~SvmPredictionFunction() {}
+
+#ifdef RBF_KERNEL
+  /**
+   * Creates the fastest available prediction function for the given
+   * predictor. This is a fixed size one whenever the predictor's feature
+   * dimension is between 1 and MAX_FIXED_FEATURE_DIM and the dynamic
+   * one otherwise (or the sparse one if SPARSE_SAMPLES is defined, or the
+   * bounded error one if BOUNDED_ERROR_PREDICTION is). The caller owns the
+   * returned function.
+   */
+  static SvmPredictionFunction* create(const RBFSVMNormalizedPredictor& predictor);
+#endif
+#ifdef LINEAR_KERNEL
+  static SvmPredictionFunction* create(const LinearSVMNormalizedPredictor& predictor);
+#endif
+};
+
+/**
+ * Fallback which just runs the dlib predictor on a dynamically sized sample
+ */
+template <typename NormalizedPredictor>
+class DynamicSvmPrediction : public SvmPredictionFunction {
+ public:
+  DynamicSvmPrediction(const NormalizedPredictor& predictor)
+    : predictor(predictor) {}
+
+  double operator()(const std::vector<DoubleFeature*>& features) const {
+#ifdef SPARSE_SAMPLES
+    return predictor(SparseSample::fromFeatures(features));
+#else
+    sample_type sample;
+    sample.set_size(features.size(), 1);
+    for(int i = 0; i < features.size(); ++i)
+      sample(i) = features[i]->getFeature();
+    return predictor(sample);
+#endif
+  }
+
+  std::string getName() const {
+    return "dynamic";
+  }
+
+ private:
+  // dlib's normalizer writes to a member when it's run so keep a
+  // copy which isn't shared with anything else
+  mutable NormalizedPredictor predictor;
+};
+
+#if defined(RBF_KERNEL) && !defined(SPARSE_SAMPLES)
+/**
+ * RBF decision function for samples with exactly N features. The
+ * normalization parameters and support vectors are copied into fixed size
+ * (stack allocated) vectors so that no allocation is done during a
+ * prediction and the compiler can unroll the distance computation.
+ */
+template <long N>
+class FixedDimRBFPrediction : public SvmPredictionFunction {
+ public:
+  typedef dlib::matrix<double, N, 1> fixed_sample_type;
+
+  FixedDimRBFPrediction(const RBFSVMNormalizedPredictor& predictor) {
+    assert(predictor.normalizer.in_vector_size() == N);
+    for(long i = 0; i < N; ++i) {
+      means(i) = predictor.normalizer.means()(i);
+      invStdDevs(i) = predictor.normalizer.std_devs()(i); // already stored as 1/stddev
+    }
+    const RBFSVMPredictor& function = predictor.function;
+    gamma = function.kernel_function.gamma;
+    b = function.b;
+    const long numSupportVectors = function.basis_vectors.size();
+    supportVectors.resize(numSupportVectors);
+    alphas.resize(numSupportVectors);
+    for(long i = 0; i < numSupportVectors; ++i) {
+      for(long j = 0; j < N; ++j)
+        supportVectors[i](j) = function.basis_vectors(i)(j);
+      alphas[i] = function.alpha(i);
+    }
+  }
+
+  double operator()(const std::vector<DoubleFeature*>& features) const {
+    assert(features.size() == N);
+    fixed_sample_type x;
+    for(long i = 0; i < N; ++i)
+      x(i) = (features[i]->getFeature() - means(i)) * invStdDevs(i);
+    double result = 0;
+    for(long i = 0; i < supportVectors.size(); ++i) {
+      const fixed_sample_type& sv = supportVectors[i];
+      double dist = 0;
+      for(long j = 0; j < N; ++j) {
+        const double diff = x(j) - sv(j);
+        dist += diff * diff;
+      }
+      result += alphas[i] * std::exp(-gamma * dist);
+    }
+    return result - b;
+  }
+
+  std::string getName() const {
+    return std::string("fixed dimension ") + Utils::intToString((int)N);
+  }
+
+ private:
+  fixed_sample_type means;
+  fixed_sample_type invStdDevs;
+  double gamma;
+  double b;
+  std::vector<fixed_sample_type> supportVectors;
+  std::vector<double> alphas;
+};
+#endif
+
+#if defined(RBF_KERNEL) && defined(SPARSE_SAMPLES)
+/**
+ * RBF decision function on sparse samples. The blob's scaled features are
+ * put into a dense scratch vector once, then the distance to each support
+ * vector is worked out from the squared norms (computed up front for the
+ * support vectors) and a dot product which only loops over the support
+ * vector's nonzero features.
+ */
+class SparseRBFPrediction : public SvmPredictionFunction {
+ public:
+  SparseRBFPrediction(const RBFSVMNormalizedPredictor& predictor)
+    : invStdDevs(predictor.normalizer.inv_std_devs()) {
+    const RBFSVMPredictor& function = predictor.function;
+    gamma = function.kernel_function.gamma;
+    b = function.b;
+    const long numSupportVectors = function.basis_vectors.size();
+    supportVectors.resize(numSupportVectors);
+    supportVectorNorms.resize(numSupportVectors);
+    alphas.resize(numSupportVectors);
+    long nonzeros = 0;
+    for(long i = 0; i < numSupportVectors; ++i) {
+      supportVectors[i] = function.basis_vectors(i);
+      supportVectorNorms[i] = SparseSample::squaredNorm(supportVectors[i]);
+      alphas[i] = function.alpha(i);
+      nonzeros += supportVectors[i].size();
+    }
+    averageNonzeros = (numSupportVectors > 0) ?
+        (double)nonzeros / (double)numSupportVectors : 0;
+  }
+
+  double operator()(const std::vector<DoubleFeature*>& features) const {
+    assert(features.size() == invStdDevs.size());
+    std::vector<double> x(features.size());
+    double xNorm = 0;
+    for(int i = 0; i < features.size(); ++i) {
+      x[i] = features[i]->getFeature() * invStdDevs[i];
+      xNorm += x[i] * x[i];
+    }
+    double result = 0;
+    for(long i = 0; i < supportVectors.size(); ++i) {
+      const sparse_sample_type& sv = supportVectors[i];
+      double dot = 0;
+      for(long j = 0; j < sv.size(); ++j)
+        dot += x[sv[j].first] * sv[j].second;
+      const double dist = std::max(0.0, xNorm + supportVectorNorms[i] - 2 * dot);
+      result += alphas[i] * std::exp(-gamma * dist);
+    }
+    return result - b;
+  }
+
+  std::string getName() const {
+    return std::string("sparse (") + Utils::doubleToString(averageNonzeros)
+        + std::string(" nonzero features per support vector)");
+  }
+
+ private:
+  std::vector<double> invStdDevs;
+  double gamma;
+  double b;
+  std::vector<sparse_sample_type> supportVectors;
+  std::vector<double> supportVectorNorms;
+  std::vector<double> alphas;
+  double averageNonzeros;
+};
+#endif
+
+#endif /* SVMPREDICTION_H_ */
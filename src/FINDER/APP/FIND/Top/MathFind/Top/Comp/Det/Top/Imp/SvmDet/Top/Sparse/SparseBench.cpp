@@ -0,0 +1,221 @@
+/*
+ * SparseBench.cpp
+ */
+
+#include <SparseBench.h>
+
+#include <SparseSample.h>
+#include <Sample.h>
+#include <Utils.h>
+
+#include <dlib/svm_threaded.h>
+#include <dlib/rand.h>
+
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// the kernel is timed on a square block of this many samples and the SVMs
+// are trained on at most this many (the rest are only used for prediction)
+#define BENCH_KERNEL_SAMPLES 500
+#define BENCH_TRAINING_SAMPLES 2000
+#define BENCH_SYNTHETIC_SAMPLES 4000
+
+typedef dlib::radial_basis_kernel<SparseSampleBenchmark::dense_sample_type> DenseKernel;
+typedef dlib::sparse_radial_basis_kernel<sparse_sample_type> SparseKernel;
+
+static double msSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+void SparseSampleBenchmark::run(
+    const std::vector<std::vector<BLSample*> >& samples,
+    std::ostream& out) {
+  std::vector<dense_sample_type> denseSamples;
+  std::vector<double> labels;
+  for(int i = 0; i < samples.size(); ++i) {
+    for(int j = 0; j < samples[i].size(); ++j) {
+      const std::vector<DoubleFeature*>& features = samples[i][j]->features;
+      dense_sample_type sample;
+      sample.set_size(features.size(), 1);
+      for(int k = 0; k < features.size(); ++k) {
+        sample(k) = features[k]->getFeature();
+      }
+      denseSamples.push_back(sample);
+      labels.push_back(samples[i][j]->label ? +1 : -1);
+    }
+  }
+  long dimension = 64;
+  if(!denseSamples.empty()) {
+    runOnSamples("training samples", denseSamples, labels, out);
+    dimension = denseSamples[0].size();
+  }
+
+  const double densities[] = { 0.02, 0.1, 0.3, 1.0 };
+  for(int i = 0; i < sizeof(densities) / sizeof(densities[0]); ++i) {
+    std::vector<dense_sample_type> syntheticSamples;
+    std::vector<double> syntheticLabels;
+    makeSyntheticSamples(BENCH_SYNTHETIC_SAMPLES, dimension, densities[i],
+        &syntheticSamples, &syntheticLabels);
+    runOnSamples(std::string("synthetic samples at density ")
+        + Utils::doubleToString(densities[i]), syntheticSamples,
+        syntheticLabels, out);
+  }
+}
+
+void SparseSampleBenchmark::runOnSamples(const std::string& name,
+    const std::vector<dense_sample_type>& denseSamples,
+    const std::vector<double>& labels, std::ostream& out) {
+  const long n = denseSamples.size();
+  const long dimension = denseSamples[0].size();
+
+  // Normalize both ways. The sparse samples are only scaled, which gives
+  // the same kernel values as the dense ones being centered and scaled.
+  std::vector<sparse_sample_type> rawSparseSamples;
+  for(long i = 0; i < n; ++i) {
+    sparse_sample_type sample;
+    for(long k = 0; k < dimension; ++k) {
+      if(denseSamples[i](k) != 0) {
+        sample.push_back(std::make_pair((unsigned long)k, denseSamples[i](k)));
+      }
+    }
+    rawSparseSamples.push_back(sample);
+  }
+  dlib::vector_normalizer<dense_sample_type> denseNormalizer;
+  denseNormalizer.train(denseSamples);
+  SparseScaleNormalizer sparseNormalizer;
+  sparseNormalizer.train(rawSparseSamples, dimension);
+  std::vector<dense_sample_type> dense;
+  std::vector<sparse_sample_type> sparse;
+  size_t denseBytes = 0, sparseBytes = 0;
+  long nonzeros = 0;
+  for(long i = 0; i < n; ++i) {
+    dense.push_back(denseNormalizer(denseSamples[i]));
+    sparse.push_back(sparseNormalizer(rawSparseSamples[i]));
+    denseBytes += SparseSample::denseBytes(dimension);
+    sparseBytes += SparseSample::sparseBytes(sparse.back());
+    nonzeros += rawSparseSamples[i].size();
+  }
+  out << "----- Sparse sample benchmark on " << name << " -----\n"
+      << n << " samples with " << dimension << " features, "
+      << (100. * nonzeros / (double)(n * dimension)) << "% nonzero\n"
+      << "memory: dense " << (denseBytes / 1024.) << " KB, sparse "
+      << (sparseBytes / 1024.) << " KB\n";
+
+  // Kernel evaluations on a square block of samples
+  const double gamma = 1.0 / dimension;
+  const DenseKernel denseKernel(gamma);
+  const SparseKernel sparseKernel(gamma);
+  const long m = std::min(n, (long)BENCH_KERNEL_SAMPLES);
+  double denseSum = 0, sparseSum = 0, maxDifference = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(long i = 0; i < m; ++i)
+    for(long j = 0; j < m; ++j)
+      denseSum += denseKernel(dense[i], dense[j]);
+  const double denseKernelMs = msSince(start);
+  start = std::chrono::steady_clock::now();
+  for(long i = 0; i < m; ++i)
+    for(long j = 0; j < m; ++j)
+      sparseSum += sparseKernel(sparse[i], sparse[j]);
+  const double sparseKernelMs = msSince(start);
+  for(long i = 0; i < m; ++i) {
+    for(long j = i; j < m; j += 7) {
+      maxDifference = std::max(maxDifference,
+          std::abs(denseKernel(dense[i], dense[j]) - sparseKernel(sparse[i], sparse[j])));
+    }
+  }
+  out << "kernel (" << m << "x" << m << "): dense " << denseKernelMs
+      << " ms, sparse " << sparseKernelMs << " ms, largest difference "
+      << maxDifference << "\n";
+
+  // Train both ways on the same random subset
+  std::vector<long> order;
+  for(long i = 0; i < n; ++i)
+    order.push_back(i);
+  dlib::rand rnd;
+  for(long i = n - 1; i > 0; --i)
+    std::swap(order[i], order[rnd.get_random_32bit_number() % (i + 1)]);
+  const long numTraining = std::min(n, (long)BENCH_TRAINING_SAMPLES);
+  std::vector<dense_sample_type> denseTraining;
+  std::vector<sparse_sample_type> sparseTraining;
+  std::vector<double> trainingLabels;
+  bool hasPositive = false, hasNegative = false;
+  for(long i = 0; i < numTraining; ++i) {
+    denseTraining.push_back(dense[order[i]]);
+    sparseTraining.push_back(sparse[order[i]]);
+    trainingLabels.push_back(labels[order[i]]);
+    hasPositive = hasPositive || labels[order[i]] > 0;
+    hasNegative = hasNegative || labels[order[i]] < 0;
+  }
+  if(!hasPositive || !hasNegative) {
+    out << "training skipped since the samples are all of one class\n";
+    return;
+  }
+  dlib::svm_c_trainer<DenseKernel> denseTrainer;
+  denseTrainer.set_kernel(denseKernel);
+  denseTrainer.set_c(10);
+  dlib::svm_c_trainer<SparseKernel> sparseTrainer;
+  sparseTrainer.set_kernel(sparseKernel);
+  sparseTrainer.set_c(10);
+  start = std::chrono::steady_clock::now();
+  const dlib::decision_function<DenseKernel> denseFunction =
+      denseTrainer.train(denseTraining, trainingLabels);
+  const double denseTrainMs = msSince(start);
+  start = std::chrono::steady_clock::now();
+  const dlib::decision_function<SparseKernel> sparseFunction =
+      sparseTrainer.train(sparseTraining, trainingLabels);
+  const double sparseTrainMs = msSince(start);
+  out << "training (" << numTraining << " samples): dense " << denseTrainMs
+      << " ms (" << denseFunction.basis_vectors.size() << " support vectors), sparse "
+      << sparseTrainMs << " ms (" << sparseFunction.basis_vectors.size()
+      << " support vectors)\n";
+
+  // Predict on all of the samples
+  double denseResults = 0, sparseResults = 0;
+  start = std::chrono::steady_clock::now();
+  for(long i = 0; i < n; ++i)
+    denseResults += denseFunction(dense[i]);
+  const double densePredictMs = msSince(start);
+  start = std::chrono::steady_clock::now();
+  for(long i = 0; i < n; ++i)
+    sparseResults += sparseFunction(sparse[i]);
+  const double sparsePredictMs = msSince(start);
+  long agreements = 0;
+  for(long i = 0; i < n; ++i) {
+    if((denseFunction(dense[i]) < 0) == (sparseFunction(sparse[i]) < 0)) {
+      ++agreements;
+    }
+  }
+  out << "prediction (" << n << " samples): dense " << densePredictMs
+      << " ms, sparse " << sparsePredictMs << " ms, agreeing on "
+      << (100. * agreements / (double)n) << "% of them\n";
+}
+
+void SparseSampleBenchmark::makeSyntheticSamples(const int count,
+    const long dimension, const double density,
+    std::vector<dense_sample_type>* const samples,
+    std::vector<double>* const labels) {
+  dlib::rand rnd;
+  const long informative = std::min(dimension, 4L);
+  for(int i = 0; i < count; ++i) {
+    dense_sample_type sample;
+    sample.set_size(dimension, 1);
+    double score = 0;
+    for(long k = 0; k < dimension; ++k) {
+      // the nonzero features are a mix of flags and counts like the real ones
+      sample(k) = 0;
+      if(rnd.get_random_double() < density) {
+        sample(k) = (k % 2 == 0) ? 1 : 1 + (rnd.get_random_32bit_number() % 5);
+      }
+      if(k < informative) {
+        score += sample(k);
+      }
+    }
+    samples->push_back(sample);
+    labels->push_back((score > informative * density) ? +1 : -1);
+  }
+}
@@ -0,0 +1,55 @@
+/*
+ * SparseBench.h
+ */
+
+#ifndef SPARSEBENCH_H_
+#define SPARSEBENCH_H_
+
+#include <Sample.h>
+#include <SparseSample.h>
+
+#include <dlib/svm_threaded.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Compares dense and sparse samples on the memory they take up and on how
+ * long it takes to evaluate the RBF kernel, train an SVM, and predict with
+ * it. It's run on the given training samples and then on synthetic ones at
+ * a few densities so that the point where the sparse samples stop paying off
+ * can be seen. Both ways are trained on the same (subsampled) set with the
+ * same parameters so their predictions are also compared to make sure they
+ * agree. Meant to be run by hand when deciding whether to enable
+ * SPARSE_SAMPLES (see DBG_BENCHMARK_SPARSE in SvmDetector.cpp).
+ */
+namespace SparseSampleBenchmark {
+
+typedef dlib::matrix<double, 0, 1> dense_sample_type;
+
+/**
+ * Runs the benchmark on the training samples followed by the synthetic ones
+ */
+void run(const std::vector<std::vector<BLSample*> >& samples,
+    std::ostream& out);
+
+/**
+ * Runs the benchmark on the given samples (the labels are +1/-1)
+ */
+void runOnSamples(const std::string& name,
+    const std::vector<dense_sample_type>& denseSamples,
+    const std::vector<double>& labels, std::ostream& out);
+
+/**
+ * Makes random samples in which each feature is nonzero with the given
+ * probability. The label depends on the first few features so that there's
+ * something for the SVM to learn.
+ */
+void makeSyntheticSamples(const int count, const long dimension,
+    const double density, std::vector<dense_sample_type>* const samples,
+    std::vector<double>* const labels);
+}
+
+
+#endif /* SPARSEBENCH_H_ */
@@ -0,0 +1,116 @@
+/*
+ * SparseSample.cpp
+ */
+
+#include <SparseSample.h>
+
+#include <dlib/svm_threaded.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <assert.h>
+
+sparse_sample_type SparseSample::fromFeatures(
+    const std::vector<DoubleFeature*>& features) {
+  sparse_sample_type sample;
+  for(unsigned long i = 0; i < features.size(); ++i) {
+    const double feature = features[i]->getFeature();
+    if(feature != 0) {
+      sample.push_back(std::make_pair(i, feature));
+    }
+  }
+  return sample;
+}
+
+double SparseSample::squaredNorm(const sparse_sample_type& sample) {
+  double norm = 0;
+  for(int i = 0; i < sample.size(); ++i) {
+    norm += sample[i].second * sample[i].second;
+  }
+  return norm;
+}
+
+size_t SparseSample::sparseBytes(const sparse_sample_type& sample) {
+  return sizeof(sparse_sample_type)
+      + sample.capacity() * sizeof(sparse_sample_type::value_type);
+}
+
+size_t SparseSample::denseBytes(const long dimension) {
+  return sizeof(dlib::matrix<double, 0, 1>) + dimension * sizeof(double);
+}
+
+SparseScaleNormalizer::SparseScaleNormalizer() {}
+
+void SparseScaleNormalizer::train(const std::vector<sparse_sample_type>& samples,
+    const long dimension) {
+  long dim = dimension;
+  if(dim <= 0) {
+    for(int i = 0; i < samples.size(); ++i) {
+      if(!samples[i].empty() && (long)samples[i].back().first + 1 > dim) {
+        dim = samples[i].back().first + 1;
+      }
+    }
+  }
+
+  // the zeros aren't stored but still count towards each feature's mean and
+  // variance, so only the sums over the nonzero entries are needed
+  std::vector<double> sums(dim, 0);
+  std::vector<double> sumSquares(dim, 0);
+  for(int i = 0; i < samples.size(); ++i) {
+    for(int j = 0; j < samples[i].size(); ++j) {
+      const unsigned long index = samples[i][j].first;
+      if(index >= dim) {
+        std::cout << "ERROR: Sparse sample has a feature at index " << index
+            << " but the samples only have " << dim << " features.\n";
+        assert(false);
+      }
+      sums[index] += samples[i][j].second;
+      sumSquares[index] += samples[i][j].second * samples[i][j].second;
+    }
+  }
+
+  // same (unbiased) variance as vector_normalizer, and like it a feature
+  // with no variance gets 0 rather than dividing by 0
+  const double n = samples.size();
+  invStdDevs.assign(dim, 0);
+  if(n < 2) {
+    return;
+  }
+  for(long i = 0; i < dim; ++i) {
+    const double mean = sums[i] / n;
+    const double variance = (sumSquares[i] - n * mean * mean) / (n - 1);
+    if(variance > 0) {
+      invStdDevs[i] = 1.0 / std::sqrt(variance);
+    }
+  }
+}
+
+sparse_sample_type SparseScaleNormalizer::operator()(
+    const sparse_sample_type& sample) const {
+  sparse_sample_type scaled;
+  scaled.reserve(sample.size());
+  for(int i = 0; i < sample.size(); ++i) {
+    const unsigned long index = sample[i].first;
+    if(index < invStdDevs.size() && invStdDevs[index] != 0) {
+      scaled.push_back(std::make_pair(index, sample[i].second * invStdDevs[index]));
+    }
+  }
+  return scaled;
+}
+
+long SparseScaleNormalizer::in_vector_size() const {
+  return invStdDevs.size();
+}
+
+const std::vector<double>& SparseScaleNormalizer::inv_std_devs() const {
+  return invStdDevs;
+}
+
+void serialize(const SparseScaleNormalizer& item, std::ostream& out) {
+  dlib::serialize(item.invStdDevs, out);
+}
+
+void deserialize(SparseScaleNormalizer& item, std::istream& in) {
+  dlib::deserialize(item.invStdDevs, in);
+}
@@ -0,0 +1,90 @@
+/*
+ * SparseSample.h
+ */
+
+#ifndef SPARSESAMPLE_H_
+#define SPARSESAMPLE_H_
+
+#include <DoubleFeature.h>
+
+#include <dlib/svm_threaded.h>
+
+#include <iostream>
+#include <utility>
+#include <vector>
+
+/**
+ * A sample holding only its nonzero features as (index, value) pairs sorted
+ * by index, which is the sparse vector format dlib's sparse kernels expect.
+ * Most of the flag and count features are zero for nearly every blob, so
+ * these are usually much smaller than the dense samples.
+ */
+typedef std::vector<std::pair<unsigned long, double> > sparse_sample_type;
+
+namespace SparseSample {
+
+/**
+ * Makes a sparse sample out of a blob's features, leaving out the zeros
+ */
+sparse_sample_type fromFeatures(const std::vector<DoubleFeature*>& features);
+
+/**
+ * Sum of the squares of the sample's features
+ */
+double squaredNorm(const sparse_sample_type& sample);
+
+/**
+ * Size in bytes of a sparse sample and of a dense dlib sample with the
+ * given number of features (each including the vector or matrix itself)
+ */
+size_t sparseBytes(const sparse_sample_type& sample);
+size_t denseBytes(const long dimension);
+}
+
+/**
+ * Stands in for dlib's vector_normalizer on sparse samples. Subtracting
+ * the mean would turn every zero into something nonzero, so the features
+ * are only divided by their standard deviation. The RBF kernel only depends
+ * on the distance between two samples, which doesn't change when they're
+ * both shifted by the mean, so this gives the same kernel values as
+ * vector_normalizer does. For the linear kernel the shift is just absorbed
+ * into the bias.
+ */
+class SparseScaleNormalizer {
+ public:
+
+  SparseScaleNormalizer();
+
+  /**
+   * Learns the standard deviation of each feature. The dimension is the
+   * number of features each sample has (zero to take it from the highest
+   * index that appears in any of the samples).
+   */
+  void train(const std::vector<sparse_sample_type>& samples,
+      const long dimension=0);
+
+  /**
+   * Returns the scaled sample (features with no variance are left out)
+   */
+  sparse_sample_type operator()(const sparse_sample_type& sample) const;
+
+  long in_vector_size() const;
+
+  /**
+   * One over the standard deviation of each feature (0 if the feature
+   * never varies), same as vector_normalizer's std_devs()
+   */
+  const std::vector<double>& inv_std_devs() const;
+
+ private:
+  friend void serialize(const SparseScaleNormalizer& item, std::ostream& out);
+  friend void deserialize(SparseScaleNormalizer& item, std::istream& in);
+
+  std::vector<double> invStdDevs;
+};
+
+void serialize(const SparseScaleNormalizer& item, std::ostream& out);
+void deserialize(SparseScaleNormalizer& item, std::istream& in);
+
+
+#endif /* SPARSESAMPLE_H_ */
@@ -0,0 +1,85 @@
+/*
+ * NormalizerStats.cpp
+ */
+
+#include <NormalizerStats.h>
+
+#include <SvmDetector.h>
+#include <SampleChunkReader.h>
+#include <SparseSample.h>
+
+#include <dlib/svm_threaded.h>
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <assert.h>
+
+NormalizerStats::NormalizerStats() : sampleCount(0) {}
+
+void NormalizerStats::add(const LabeledFeatures& sample) {
+  if(sampleCount == 0) {
+    shifts.assign(sample.dimension, 0);
+    shiftedSums.assign(sample.dimension, 0);
+    shiftedSumSquares.assign(sample.dimension, 0);
+    nonzeroCounts.assign(sample.dimension, 0);
+  } else if(sample.dimension != shifts.size()) {
+    std::cout << "ERROR: A sample has " << sample.dimension << " features "
+        << "but the ones before it have " << shifts.size() << ".\n";
+    assert(false);
+  }
+  for(int i = 0; i < sample.nonzeros.size(); ++i) {
+    const unsigned long index = sample.nonzeros[i].first;
+    const double value = sample.nonzeros[i].second;
+    if(nonzeroCounts[index]++ == 0) {
+      shifts[index] = value;
+    }
+    const double shifted = value - shifts[index];
+    shiftedSums[index] += shifted;
+    shiftedSumSquares[index] += shifted * shifted;
+  }
+  ++sampleCount;
+}
+
+long NormalizerStats::getSampleCount() const {
+  return sampleCount;
+}
+
+long NormalizerStats::getDimension() const {
+  return shifts.size();
+}
+
+void NormalizerStats::toNormalizer(
+    sample_normalizer_type* const normalizer) const {
+  const long dimension = getDimension();
+  const double n = sampleCount;
+  dlib::matrix<double, 0, 1> means, invStdDevs;
+  means.set_size(dimension);
+  invStdDevs.set_size(dimension);
+  for(long i = 0; i < dimension; ++i) {
+    // each zero is -shift away from the shift
+    const double zeros = n - nonzeroCounts[i];
+    const double sum = shiftedSums[i] - zeros * shifts[i];
+    const double sumSquares = shiftedSumSquares[i] + zeros * shifts[i] * shifts[i];
+    means(i) = shifts[i] + ((n > 0) ? sum / n : 0);
+    // same (unbiased) variance as the normalizers use when they're trained,
+    // and like them a feature with no variance gets 0 rather than dividing by 0
+    const double variance = (n > 1) ? (sumSquares - sum * sum / n) / (n - 1) : 0;
+    invStdDevs(i) = (variance > 0) ? 1.0 / std::sqrt(variance) : 0;
+  }
+
+  // Neither normalizer can be given its statistics directly, but both can be
+  // deserialized from them, so they're serialized into a buffer the same way
+  // the normalizers serialize themselves and read back in from there.
+  std::stringstream buffer;
+#ifdef SPARSE_SAMPLES
+  std::vector<double> invStdDevVec(invStdDevs.begin(), invStdDevs.end());
+  dlib::serialize(invStdDevVec, buffer);
+#else
+  dlib::serialize(means, buffer);
+  dlib::serialize(invStdDevs, buffer);
+  dlib::serialize(dlib::matrix<double>(), buffer); // the (unused) pca matrix
+#endif
+  deserialize(*normalizer, buffer);
+}
@@ -0,0 +1,49 @@
+/*
+ * NormalizerStats.h
+ */
+
+#ifndef NORMALIZERSTATS_H_
+#define NORMALIZERSTATS_H_
+
+#include <SvmDetector.h>
+#include <SampleChunkReader.h>
+
+#include <vector>
+
+/**
+ * Accumulates the mean and (unbiased) variance of each feature one sample at
+ * a time, so the normalizer can be set up in a pass over the sample file
+ * without the samples all being in memory. The result is the same normalizer
+ * that training it on all of the samples at once would give.
+ */
+class NormalizerStats {
+ public:
+
+  NormalizerStats();
+
+  void add(const LabeledFeatures& sample);
+
+  long getSampleCount() const;
+
+  long getDimension() const;
+
+  /**
+   * Sets up the normalizer from the samples added so far
+   */
+  void toNormalizer(sample_normalizer_type* const normalizer) const;
+
+ private:
+
+  // Each feature's sums are taken relative to the first nonzero value seen
+  // for it, which keeps the variance from being lost to rounding when there
+  // are millions of samples. Only the nonzero values are added as they come
+  // in; the zeros are accounted for at the end from the counts.
+  long sampleCount;
+  std::vector<double> shifts;
+  std::vector<double> shiftedSums;
+  std::vector<double> shiftedSumSquares;
+  std::vector<long> nonzeroCounts;
+};
+
+
+#endif /* NORMALIZERSTATS_H_ */
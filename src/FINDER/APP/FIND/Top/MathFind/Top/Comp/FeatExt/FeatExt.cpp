@@ -21,6 +21,7 @@ MathExpressionFeatureExtractor::MathExpressionFeatureExtractor(
     std::vector<BlobFeatureExtractor*> blobFeatureExtractors) {
   this->finderInfo = finderInfo;
   this->blobFeatureExtractors = blobFeatureExtractors;
+  this->preprocessingScheduler = new PreprocessingScheduler(blobFeatureExtractors);
 }
 
 void MathExpressionFeatureExtractor::doFinderInitialization() {
@@ -46,19 +47,19 @@ void MathExpressionFeatureExtractor::doTrainerInitialization() {
 
 void MathExpressionFeatureExtractor::extractFeatures(BlobDataGrid* const blobDataGrid) {
 
-  // For each feature extractor, first do any necessary preprocessing
-  for(int i = 0; i < blobFeatureExtractors.size(); ++i) {
+  // For each feature extractor, first do any necessary preprocessing. Extractors
+  // that don't depend on each other's results are run at the same time.
 #ifdef DBG_FEAT_EXT
-    std::cout << "Running preprocessing for the " << blobFeatureExtractors[i]->getFeatureExtractorDescription()->getName() << " extractor.\n";
+  std::cout << "Running preprocessing for " << blobFeatureExtractors.size()
+      << " extractors on " << preprocessingScheduler->getNumThreads() << " thread(s).\n";
 #endif
-    blobFeatureExtractors[i]->doPreprocessing(blobDataGrid);
+  preprocessingScheduler->runPreprocessing(blobDataGrid);
 #ifdef DBG_FEAT_EXT
-    std::cout << "Done running preprocessing for the " << blobFeatureExtractors[i]->getFeatureExtractorDescription()->getName() << " extractor.\n";
+  std::cout << "Done running preprocessing.\n";
 #ifdef DBG_FEAT_EXT_WAIT
-    Utils::waitForInput();
+  Utils::waitForInput();
 #endif
 #endif
-  }
 
   // Now, for each blob on the grid, run all of the blob feature extraction logic
   BlobDataGridSearch search(blobDataGrid);
@@ -107,12 +108,22 @@ std::vector<BlobFeatureExtractor*> MathExpressionFeatureExtractor::getBlobFeatur
   return blobFeatureExtractors;
 }
 
+BlobDataGridFactory::OcrLevel MathExpressionFeatureExtractor::getGridOcrLevel() {
+  for(int i = 0; i < blobFeatureExtractors.size(); ++i) {
+    if(blobFeatureExtractors[i]->needsRecognition()) {
+      return BlobDataGridFactory::FULL_RECOGNITION;
+    }
+  }
+  return BlobDataGridFactory::LAYOUT_ONLY;
+}
+
 FinderInfo* MathExpressionFeatureExtractor::getFinderInfo() {
   return finderInfo;
 }
 
 
 MathExpressionFeatureExtractor::~MathExpressionFeatureExtractor() {
+  delete preprocessingScheduler; // joins the pool's threads before the extractors go away
   for(int i = 0; i < blobFeatureExtractors.size(); ++i) {
     delete blobFeatureExtractors[i];
   }
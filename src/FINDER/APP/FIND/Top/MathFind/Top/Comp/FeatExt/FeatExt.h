@@ -9,10 +9,12 @@
 #define MATHEXPRESSIONFEATUREEXTRACTOR_H_
 
 #include <BlobFeatExt.h>
+#include <PreprocSched.h>
 
 #include <FinderInfo.h>
 
 #include <BlobDataGrid.h>
+#include <BlobDataGridFactory.h>
 
 #include <vector>
 
@@ -52,12 +54,21 @@ class MathExpressionFeatureExtractor {
    * values in the expected order depending on which feature extraction technique is
    * used for the subsequent detection and segmentation phases. Other values
    * and data structures may be required depending on the detection and segmentation
-   * technique being utilized.
+   * technique being utilized. The preprocessing for extractors which don't
+   * share any page data is run in parallel (see PreprocessingScheduler).
    */
   void extractFeatures(BlobDataGrid* const blobDataGrid);
 
   std::vector<BlobFeatureExtractor*> getBlobFeatureExtractors();
 
+  /**
+   * Gets how much of Tesseract's results the grids given to extractFeatures
+   * need to be built from, which is just the layout unless one of the blob
+   * feature extractors needs recognition. Grids for training and for finding
+   * have to be built the same way for the features to mean the same thing.
+   */
+  BlobDataGridFactory::OcrLevel getGridOcrLevel();
+
   ~MathExpressionFeatureExtractor(); // delete the dependencies
 
   FinderInfo* getFinderInfo();
@@ -68,6 +79,8 @@ class MathExpressionFeatureExtractor {
 
   std::vector<BlobFeatureExtractor*> blobFeatureExtractors;
 
+  PreprocessingScheduler* preprocessingScheduler;
+
   //dbg
   void dbgShowFeatureOrdering(
       BlobData* const blobData);
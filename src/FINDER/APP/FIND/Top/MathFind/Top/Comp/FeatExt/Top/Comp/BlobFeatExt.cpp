@@ -16,22 +16,6 @@
 BlobFeatureExtractor::BlobFeatureExtractor() {}
 
 
-/**
- * Determines the index in each blob's variable data vector where this
- * feature extractor will place its data. This is done by just getting
- * the size of the first blob's vector (all of the vectors will have the
- * same amount of data in the same order). Each feature extractor holds
- * onto that index and uses it to look up its data. Once the data is retrieved
- * it is cast back into something the feature extractor can find useful
- * somehow.
- */
-int BlobFeatureExtractor::findOpenBlobDataIndex(BlobDataGrid* const blobDataGrid) {
-  BlobDataGridSearch gridSearch(blobDataGrid);
-  gridSearch.StartFullSearch();
-  BlobData* blob = gridSearch.NextFullSearch();
-  return blob->getVariableDataLength();
-}
-
 /**
  * Called once during initialization before using this extractor for training
  * purposes only.
@@ -44,6 +28,18 @@ void BlobFeatureExtractor::doTrainerInitialization() {}
  */
 void BlobFeatureExtractor::doFinderInitialization() {}
 
+int BlobFeatureExtractor::getPreprocessingReads() {
+  return ALL_RESOURCES;
+}
+
+int BlobFeatureExtractor::getPreprocessingWrites() {
+  return ALL_RESOURCES;
+}
+
+bool BlobFeatureExtractor::needsRecognition() {
+  return true;
+}
+
 std::vector<FeatureExtractorFlagDescription*> BlobFeatureExtractor::getEnabledFlagDescriptions() {
   return std::vector<FeatureExtractorFlagDescription*>();
 }
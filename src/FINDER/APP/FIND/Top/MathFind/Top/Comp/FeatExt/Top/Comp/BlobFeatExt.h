@@ -19,6 +19,23 @@ class BlobFeatureExtractor {
 
  public:
 
+  /**
+   * Page-level data which may be shared between extractors during
+   * preprocessing. Each extractor declares which of these it reads and
+   * writes so that preprocessing for extractors that don't conflict can be
+   * run at the same time. Data that an extractor keeps to itself (i.e., its
+   * own per-page columns) isn't listed here since no other extractor sees it.
+   */
+  enum PageResource {
+    GRID_BLOBS = 1,        // the grid's blobs and the OCR results attached when the grid was built
+    SENTENCE_NGRAMS = 2,   // n-gram counts and features stored in each recognized sentence
+    ROW_BASELINES = 4,     // average baseline distance stored in each recognized row
+    WORD_MATCHES = 8,      // math word and stop word flags stored in each recognized word
+    PAGE_ITALICS = 16,     // the grid's ratio of non-italicized blobs
+    BAD_REGION_CACHE = 32, // bad region status cached in each blob when first looked up
+    ALL_RESOURCES = 63
+  };
+
   BlobFeatureExtractor();
 
   /**
@@ -40,8 +57,31 @@ class BlobFeatureExtractor {
   virtual void doPreprocessing(BlobDataGrid* const blobDataGrid) = 0;
 
   /**
-   * Extracts the features from the given blob while persisting any data
-   * that may be needed later into the blob's variable data vector. The
+   * Gets the page resources read by doPreprocessing as a bitwise OR of
+   * PageResource values. The default is all of them so that extractors
+   * which don't declare anything are never run alongside any others.
+   */
+  virtual int getPreprocessingReads();
+
+  /**
+   * Gets the page resources written by doPreprocessing as a bitwise OR of
+   * PageResource values. The default is all of them.
+   */
+  virtual int getPreprocessingWrites();
+
+  /**
+   * True if this extractor looks at any of Tesseract's recognition results
+   * (recognized characters, words, sentences, or their confidences). If none
+   * of a finder's extractors do then its grids are built from the layout
+   * analysis alone (see BlobDataGridFactory::OcrLevel). The default is true
+   * so that extractors which don't say otherwise always get them.
+   */
+  virtual bool needsRecognition();
+
+  /**
+   * Extracts the features from the given blob. Any data that may be needed
+   * later is kept by the extractor itself in per-page columns indexed by
+   * the blob's index on its grid (see BlobData::getBlobIndex). The
    * feature extracted are formatted as a vector of double values normalized
    * for later use by a binary classifier in the detection stage. The persisted
    * data may be needed by the segmentation stage. Returns the extracted features
@@ -59,18 +99,6 @@ class BlobFeatureExtractor {
 
   virtual ~BlobFeatureExtractor();
 
- protected:
-  /**
-   * Determines the index in each blob's variable data vector where this
-   * feature extractor will place its data. This is done by just getting
-   * the size of the first blob's vector (all of the vectors will have the
-   * same amount of data in the same order). Each feature extractor holds
-   * onto that index and uses it to look up its data. Once the data is retrieved
-   * it is cast back into something the feature extractor finds useful
-   * somehow.
-   */
-  int findOpenBlobDataIndex(BlobDataGrid* const blobDataGrid);
-
 };
 
 
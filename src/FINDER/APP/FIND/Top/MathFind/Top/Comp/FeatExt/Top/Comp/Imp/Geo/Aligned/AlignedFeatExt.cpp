@@ -32,7 +32,7 @@ NumAlignedBlobsFeatureExtractor::NumAlignedBlobsFeatureExtractor(NumAlignedBlobs
 : rightwardFeatureEnabled(false),
   downwardFeatureEnabled(false),
   upwardFeatureEnabled(false),
-  blobDataKey(-1), indbg(false),
+  indbg(false),
   dbgdontcare(false),
   highCertaintyThresh(Utils::getCertaintyThresh() / 2),
   blobDataGrid(NULL) {
@@ -40,9 +40,8 @@ NumAlignedBlobsFeatureExtractor::NumAlignedBlobsFeatureExtractor(NumAlignedBlobs
 }
 
 void NumAlignedBlobsFeatureExtractor::doPreprocessing(BlobDataGrid* const blobDataGrid) {
-  // Get the key that will be used for retrieving data associated with
-  // this class for each blob.
-  blobDataKey = findOpenBlobDataIndex(blobDataGrid);
+  // Make room in this class's data for each blob on the page
+  pageData.reset(blobDataGrid->getBlobCount());
   this->blobDataGrid = blobDataGrid;
 
 #ifdef DBG_DRAW_RIGHTWARD
@@ -57,22 +56,18 @@ void NumAlignedBlobsFeatureExtractor::doPreprocessing(BlobDataGrid* const blobDa
   gridSearch.StartFullSearch();
   BlobData* blob = NULL;
   while((blob = gridSearch.NextFullSearch()) != NULL) {
-    NumAlignedBlobsData* const data = new NumAlignedBlobsData(description);
-    assert(blobDataKey == blob->appendNewVariableData(data));
+    const int blobIndex = blob->getBlobIndex();
     if(rightwardFeatureEnabled) {
-      const int count = countCoveredBlobs(blob, blobDataGrid, BlobSpatial::RIGHT);
-      data->setRhabcCount(count)
-          ->setRhabcFeature(M_Utils::expNormalize(count));
+      pageData.setCoveredCount(blobIndex, BlobSpatial::RIGHT,
+          countCoveredBlobs(blob, blobDataGrid, BlobSpatial::RIGHT));
     }
     if(upwardFeatureEnabled) {
-      const int count = countCoveredBlobs(blob, blobDataGrid, BlobSpatial::UP);
-      data->setUvabcCount(count)
-          ->setUvabcFeature(M_Utils::expNormalize(count));
+      pageData.setCoveredCount(blobIndex, BlobSpatial::UP,
+          countCoveredBlobs(blob, blobDataGrid, BlobSpatial::UP));
     }
     if(downwardFeatureEnabled) {
-      const int count = countCoveredBlobs(blob, blobDataGrid, BlobSpatial::DOWN);
-      data->setDvabcCount(count)
-          ->setDvabcFeature(M_Utils::expNormalize(count));
+      pageData.setCoveredCount(blobIndex, BlobSpatial::DOWN,
+          countCoveredBlobs(blob, blobDataGrid, BlobSpatial::DOWN));
     }
   }
 
@@ -84,14 +79,33 @@ void NumAlignedBlobsFeatureExtractor::doPreprocessing(BlobDataGrid* const blobDa
 #endif
 }
 
+int NumAlignedBlobsFeatureExtractor::getPreprocessingReads() {
+  return GRID_BLOBS | BAD_REGION_CACHE;
+}
+
+int NumAlignedBlobsFeatureExtractor::getPreprocessingWrites() {
+  // Looking up whether a neighbor is in a bad region caches the result in the
+  // neighbor and the blobs to its right
+  return BAD_REGION_CACHE;
+}
+
+// The recognition confidences and normal rows are only used to skip over
+// blobs that are confidently text, so every blob is considered without them.
+bool NumAlignedBlobsFeatureExtractor::needsRecognition() {
+  return false;
+}
+
 std::vector<DoubleFeature*> NumAlignedBlobsFeatureExtractor::extractFeatures(BlobData* const blob) {
 
-  NumAlignedBlobsData* const data = (NumAlignedBlobsData*)(blob->getVariableDataAt(blobDataKey));
+  const int blobIndex = blob->getBlobIndex();
+  const int rhabcCount = pageData.getCoveredCount(blobIndex, BlobSpatial::RIGHT);
+  const int uvabcCount = pageData.getCoveredCount(blobIndex, BlobSpatial::UP);
+  const int dvabcCount = pageData.getCoveredCount(blobIndex, BlobSpatial::DOWN);
 
 #ifdef DBG_FEATURE
-  double rhabc = (double)(data->getRhabcCount());
-  double uvabc = (double)(data->getUvabcCount());
-  double dvabc = (double)(data->getDvabcCount());
+  double rhabc = (double)rhabcCount;
+  double uvabc = (double)uvabcCount;
+  double dvabc = (double)dvabcCount;
   if(rhabc > 0 && rightwardFeatureEnabled)
     std::cout << "Displayed blob has rhabc = " << rhabc << std::endl;
   if(uvabc > 0 && upwardFeatureEnabled)
@@ -102,7 +116,23 @@ std::vector<DoubleFeature*> NumAlignedBlobsFeatureExtractor::extractFeatures(Blo
     M_Utils::dbgDisplayBlob(blob);
 #endif
 
-  return data->getExtractedFeatures();
+  std::vector<DoubleFeature*> features;
+  if(rightwardFeatureEnabled) {
+    features.push_back(new DoubleFeature(description,
+        M_Utils::expNormalize(rhabcCount),
+        description->getRightwardFlagDescription()));
+  }
+  if(upwardFeatureEnabled) {
+    features.push_back(new DoubleFeature(description,
+        M_Utils::expNormalize(uvabcCount),
+        description->getUpwardFlagDescription()));
+  }
+  if(downwardFeatureEnabled) {
+    features.push_back(new DoubleFeature(description,
+        M_Utils::expNormalize(dvabcCount),
+        description->getDownwardFlagDescription()));
+  }
+  return features;
 }
 
 
@@ -343,22 +373,12 @@ int NumAlignedBlobsFeatureExtractor::countCoveredBlobs(BlobData* const blob,
 #endif
 //  }
 #endif
-  NumAlignedBlobsData* const data = (NumAlignedBlobsData*)(blob->getVariableDataAt(blobDataKey));
-  if(dir == BlobSpatial::UP)
-    data->uvabc_blobs = covered_blobs;
-  else if(dir == BlobSpatial::DOWN)
-    data->dvabc_blobs = covered_blobs;
-  else if(dir == BlobSpatial::RIGHT) {
-    data->rhabc_blobs = covered_blobs;
+  pageData.getCoveredBlobs(blob->getBlobIndex(), dir) = covered_blobs;
 #ifdef DBG_DRAW_RIGHTWARD
-    if(covered_blobs.size() > 0) {
-      M_Utils::drawHlBlobDataRegion(blob, rightwardIm, LayoutEval::RED);
-    }
+  if(dir == BlobSpatial::RIGHT && covered_blobs.size() > 0) {
+    M_Utils::drawHlBlobDataRegion(blob, rightwardIm, LayoutEval::RED);
+  }
 #endif
-  } else if (dir == BlobSpatial::LEFT)
-    data->lhabc_blobs = covered_blobs;
-  else
-    assert(false);
   return count;
 }
 
@@ -554,15 +574,14 @@ std::vector<FeatureExtractorFlagDescription*> NumAlignedBlobsFeatureExtractor::g
 }
 
 void NumAlignedBlobsFeatureExtractor::doSegmentationInit(BlobDataGrid* blobDataGrid) {
-  if(blobDataKey < 0) {
-    blobDataKey = findOpenBlobDataIndex(blobDataGrid);
+  // Only need to make room if preprocessing wasn't already run on this page
+  if(pageData.getBlobCount() != blobDataGrid->getBlobCount()) {
+    pageData.reset(blobDataGrid->getBlobCount());
   }
+  this->blobDataGrid = blobDataGrid;
 }
 
-NumAlignedBlobsData* NumAlignedBlobsFeatureExtractor::getBlobFeatureData(BlobData* const blobData) {
-  if(blobDataKey < 0) {
-    return NULL;
-  }
-  return (NumAlignedBlobsData*)(blobData->getVariableDataAt(blobDataKey));
+NumAlignedBlobsData* NumAlignedBlobsFeatureExtractor::getPageFeatureData() {
+  return &pageData;
 }
 
@@ -29,6 +29,12 @@ class NumAlignedBlobsFeatureExtractor : public virtual BlobFeatureExtractor {
 
   void doPreprocessing(BlobDataGrid* const blobDataGrid);
 
+  int getPreprocessingReads();
+
+  int getPreprocessingWrites();
+
+  bool needsRecognition();
+
   std::vector<DoubleFeature*> extractFeatures(BlobData* const blob);
 
   BlobFeatureExtractorDescription* getFeatureExtractorDescription();
@@ -45,15 +51,16 @@ class NumAlignedBlobsFeatureExtractor : public virtual BlobFeatureExtractor {
 
   /**
    * Specialized initialization for when this feature extractor
-   * is used for segmentation purposes
+   * is used for segmentation purposes. Makes sure this extractor's
+   * per-page data has room for every blob on the grid.
    */
   void doSegmentationInit(BlobDataGrid* blobDataGrid);
 
   /**
-   * Gets the data associated with the given blob that is
-   * relevant to this feature extractor
+   * Gets this feature extractor's data for the current page. Entries
+   * are looked up by blob index.
    */
-  NumAlignedBlobsData* getBlobFeatureData(BlobData* blobData);
+  NumAlignedBlobsData* getPageFeatureData();
 
  private:
 
@@ -73,7 +80,7 @@ class NumAlignedBlobsFeatureExtractor : public virtual BlobFeatureExtractor {
   bool isNeighborCovered(BlobData* const neighbor, BlobData* const blob, const BlobSpatial::Direction& dir,
       const bool seg_mode, bool* tooFarAway, const int dbgSegId);
 
-  int blobDataKey;
+  NumAlignedBlobsData pageData;
 
   NumAlignedBlobsFeatureExtractorDescription* description;
   std::vector<FeatureExtractorFlagDescription*> enabledFlagDescriptions;
@@ -7,52 +7,87 @@
 
 #include <AlignedData.h>
 
-#include <DoubleFeature.h>
+#include <Direction.h>
 
-NumAlignedBlobsData::NumAlignedBlobsData(
-    NumAlignedBlobsFeatureExtractorDescription* const description) {
-  this->description = description;
-}
+#include <baseapi.h>
 
-NumAlignedBlobsData* NumAlignedBlobsData::setRhabcFeature(const double feature) {
-  appendExtractedFeature(new DoubleFeature(description, feature, description->getRightwardFlagDescription()));
-  return this;
-}
-NumAlignedBlobsData* NumAlignedBlobsData::setRhabcCount(const int rhabcCount) {
-  this->rhabcCount = rhabcCount;
-  return this;
-}
-int NumAlignedBlobsData::getRhabcCount() {
-  return rhabcCount;
-}
+#include <vector>
+#include <iostream>
+#include <assert.h>
+
+NumAlignedBlobsData::NumAlignedBlobsData() : blobCount(0) {}
 
-NumAlignedBlobsData* NumAlignedBlobsData::setUvabcFeature(const double feature) {
-  appendExtractedFeature(new DoubleFeature(description, feature, description->getUpwardFlagDescription()));
-  return this;
+void NumAlignedBlobsData::reset(const int blobCount) {
+  this->blobCount = blobCount;
+  rhabcCounts.assign(blobCount, 0);
+  lhabcCounts.assign(blobCount, 0);
+  uvabcCounts.assign(blobCount, 0);
+  dvabcCounts.assign(blobCount, 0);
+  rhabcBlobs.assign(blobCount, GenericVector<BlobData*>());
+  lhabcBlobs.assign(blobCount, GenericVector<BlobData*>());
+  uvabcBlobs.assign(blobCount, GenericVector<BlobData*>());
+  dvabcBlobs.assign(blobCount, GenericVector<BlobData*>());
 }
-NumAlignedBlobsData* NumAlignedBlobsData::setUvabcCount(const int uvabcCount) {
-  this->uvabcCount = uvabcCount;
-  return this;
+
+int NumAlignedBlobsData::getBlobCount() {
+  return blobCount;
 }
-int NumAlignedBlobsData::getUvabcCount() {
-  return uvabcCount;
+
+void NumAlignedBlobsData::setCoveredCount(const int blobIndex,
+    const BlobSpatial::Direction dir, const int count) {
+  assert(blobIndex >= 0 && blobIndex < blobCount);
+  getCountColumn(dir)[blobIndex] = count;
 }
 
-NumAlignedBlobsData* NumAlignedBlobsData::setDvabcFeature(const double feature) {
-  appendExtractedFeature(new DoubleFeature(description, feature, description->getDownwardFlagDescription()));
-  return this;
+int NumAlignedBlobsData::getCoveredCount(const int blobIndex,
+    const BlobSpatial::Direction dir) {
+  assert(blobIndex >= 0 && blobIndex < blobCount);
+  return getCountColumn(dir)[blobIndex];
 }
-NumAlignedBlobsData* NumAlignedBlobsData::setDvabcCount(const int dvabcCount) {
-  this->dvabcCount = dvabcCount;
-  return this;
+
+GenericVector<BlobData*>& NumAlignedBlobsData::getCoveredBlobs(
+    const int blobIndex, const BlobSpatial::Direction dir) {
+  assert(blobIndex >= 0 && blobIndex < blobCount);
+  switch(dir) {
+    case BlobSpatial::RIGHT:
+      return rhabcBlobs[blobIndex];
+    case BlobSpatial::LEFT:
+      return lhabcBlobs[blobIndex];
+    case BlobSpatial::UP:
+      return uvabcBlobs[blobIndex];
+    case BlobSpatial::DOWN:
+      return dvabcBlobs[blobIndex];
+    default:
+      std::cout << "ERROR: NumAlignedBlobsData only supports upward, downward, "
+          << "leftward, and rightward directions\n";
+      assert(false);
+  }
+  return rhabcBlobs[blobIndex];
 }
-int NumAlignedBlobsData::getDvabcCount() {
-  return dvabcCount;
+
+void NumAlignedBlobsData::clearBuffers(const int blobIndex) {
+  assert(blobIndex >= 0 && blobIndex < blobCount);
+  rhabcBlobs[blobIndex].clear();
+  lhabcBlobs[blobIndex].clear();
+  dvabcBlobs[blobIndex].clear();
+  uvabcBlobs[blobIndex].clear();
 }
 
-void NumAlignedBlobsData::clearBuffers() {
-  rhabc_blobs.clear();
-  lhabc_blobs.clear();
-  dvabc_blobs.clear();
-  uvabc_blobs.clear();
+std::vector<int>& NumAlignedBlobsData::getCountColumn(
+    const BlobSpatial::Direction dir) {
+  switch(dir) {
+    case BlobSpatial::RIGHT:
+      return rhabcCounts;
+    case BlobSpatial::LEFT:
+      return lhabcCounts;
+    case BlobSpatial::UP:
+      return uvabcCounts;
+    case BlobSpatial::DOWN:
+      return dvabcCounts;
+    default:
+      std::cout << "ERROR: NumAlignedBlobsData only supports upward, downward, "
+          << "leftward, and rightward directions\n";
+      assert(false);
+  }
+  return rhabcCounts;
 }
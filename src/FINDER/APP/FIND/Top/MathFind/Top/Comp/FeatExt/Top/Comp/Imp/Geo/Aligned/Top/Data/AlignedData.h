@@ -8,61 +8,71 @@
 #ifndef NUMALIGNEDBLOBSDATA_H_
 #define NUMALIGNEDBLOBSDATA_H_
 
-#include <BlobFeatExtData.h>
-#include <AlignedDesc.h>
-#include <BlobMergeData.h>
+#include <Direction.h>
 
 #include <baseapi.h>
 
-#include <string>
+#include <vector>
 
-class NumAlignedBlobsData : public BlobFeatureExtractionData {
+class BlobData;
 
- public:
+/**
+ * Per-page data for the aligned blobs feature extractor. Rather than
+ * hanging an object off of every blob, each piece of data is kept in
+ * a column with one entry per blob on the page. Entries are looked up by
+ * the blob's index on its grid (see BlobData::getBlobIndex).
+ */
+class NumAlignedBlobsData {
 
-  NumAlignedBlobsData(NumAlignedBlobsFeatureExtractorDescription* const description);
+ public:
 
-  NumAlignedBlobsData* setRhabcFeature(const double feature);
-  NumAlignedBlobsData* setRhabcCount(const int rhabcCount);
-  int getRhabcCount();
+  NumAlignedBlobsData();
 
-  NumAlignedBlobsData* setUvabcFeature(const double feature);
-  NumAlignedBlobsData* setUvabcCount(const int uvabcCount);
-  int getUvabcCount();
+  /**
+   * Clears out all the columns and resizes them to hold one zeroed
+   * entry for each of the blobs on the page
+   */
+  void reset(const int blobCount);
 
-  NumAlignedBlobsData* setDvabcFeature(const double feature);
-  NumAlignedBlobsData* setDvabcCount(const int dvabcCount);
-  int getDvabcCount();
+  int getBlobCount();
 
-  void clearBuffers();
+  void setCoveredCount(const int blobIndex,
+      const BlobSpatial::Direction dir, const int count);
+  int getCoveredCount(const int blobIndex, const BlobSpatial::Direction dir);
 
-  GenericVector<BlobData*> rhabc_blobs;
-  GenericVector<BlobData*> lhabc_blobs;
-  GenericVector<BlobData*> uvabc_blobs;
-  GenericVector<BlobData*> dvabc_blobs;
+  /**
+   * Gets the list of blobs covered by the blob at the given index in the
+   * given direction (left, right, up, or down)
+   */
+  GenericVector<BlobData*>& getCoveredBlobs(const int blobIndex,
+      const BlobSpatial::Direction dir);
 
- private:
   /**
-   * Features
+   * Clears the lists of covered blobs for the blob at the given index
    */
-  // righward horizontally adjacent blobs covered
-  int rhabcCount;
-  const std::string rhabcFeatureName;
+  void clearBuffers(const int blobIndex);
+
+ private:
+
+  std::vector<int>& getCountColumn(const BlobSpatial::Direction dir);
 
-  // leftward horizontally adjacent blobs covered
-  int lhabcCount;
-  const std::string lhabcFeatureName;
+  int blobCount;
+
+  // rightward horizontally adjacent blobs covered
+  std::vector<int> rhabcCounts;
+  std::vector<GenericVector<BlobData*> > rhabcBlobs;
+
+  // leftward horizontally adjacent blobs covered (only used for segmentation)
+  std::vector<int> lhabcCounts;
+  std::vector<GenericVector<BlobData*> > lhabcBlobs;
 
   // upward vertically adjacent blobs covered
-  int uvabcCount;
-  const std::string uvabcFeatureName;
+  std::vector<int> uvabcCounts;
+  std::vector<GenericVector<BlobData*> > uvabcBlobs;
 
   // downward vertically adjacent blobs covered
-  int dvabcFeatureIndex;
-  int dvabcCount;
-  const std::string dvabcFeatureName;
-
-  NumAlignedBlobsFeatureExtractorDescription* description;
+  std::vector<int> dvabcCounts;
+  std::vector<GenericVector<BlobData*> > dvabcBlobs;
 };
 
 
@@ -42,27 +42,16 @@ NumCompletelyNestedBlobsFeatureExtractor
 }
 
 void NumCompletelyNestedBlobsFeatureExtractor::doPreprocessing(BlobDataGrid* const blobDataGrid) {
-  blobDataKey = findOpenBlobDataIndex(blobDataGrid);
+  // Make room in this class's data for each blob on the page
+  pageData.reset(blobDataGrid->getBlobCount());
 
-  // Go ahead and extract this feature for each blob and store results in its data
+  // Go ahead and count the nested blobs for each blob and store the results
   BlobDataGridSearch gridSearch(blobDataGrid);
   gridSearch.StartFullSearch();
   BlobData* blob = NULL;
   while((blob = gridSearch.NextFullSearch()) != NULL) {
-
-    // Create this feature's data for this blob
-    NumCompletelyNestedBlobsData* const data = new NumCompletelyNestedBlobsData();
-
-    // Add the data to the blob's variable data array
-    assert(blobDataKey == blob->appendNewVariableData(data));
-
-    // Extract the feature put it in this feature's data (also adding any other necessary
-    // info to the feature's data).
-    data->appendExtractedFeature(
-        new DoubleFeature(description,
-            M_Utils::expNormalize(
-                countNestedBlobs(blob,
-                    blobDataGrid))));
+    pageData.setNestedBlobsCount(blob->getBlobIndex(),
+        countNestedBlobs(blob, blobDataGrid));
   }
 
 #ifdef DBG_WRITE_NESTED
@@ -71,9 +60,7 @@ void NumCompletelyNestedBlobsFeatureExtractor::doPreprocessing(BlobDataGrid* con
   PIX* dbgnested_im = pixCopy(NULL, blobDataGrid->getBinaryImage());
   dbgnested_im = pixConvertTo32(dbgnested_im);
   while((blob = gridSearch.NextFullSearch()) != NULL) {
-    NumCompletelyNestedBlobsData* const data =
-        (NumCompletelyNestedBlobsData*)blob->getVariableDataAt(blobDataKey);
-    if(data->getNestedBlobsCount() > 0) {
+    if(pageData.getNestedBlobsCount(blob->getBlobIndex()) > 0) {
       M_Utils::drawHlBlobDataRegion(blob, dbgnested_im, LayoutEval::RED);
     }
   }
@@ -93,9 +80,28 @@ void NumCompletelyNestedBlobsFeatureExtractor::doPreprocessing(BlobDataGrid* con
 #endif
 }
 
+int NumCompletelyNestedBlobsFeatureExtractor::getPreprocessingReads() {
+  return GRID_BLOBS;
+}
+
+int NumCompletelyNestedBlobsFeatureExtractor::getPreprocessingWrites() {
+  return 0;
+}
+
+// Only uses the recognition confidences to rule out blobs that are confidently
+// text, which none are on a layout only grid.
+bool NumCompletelyNestedBlobsFeatureExtractor::needsRecognition() {
+  return false;
+}
+
 std::vector<DoubleFeature*> NumCompletelyNestedBlobsFeatureExtractor::extractFeatures(BlobData* const blobData) {
-  // Already did the extraction during preprocessing, so just return result
-  return blobData->getVariableDataAt(blobDataKey)->getExtractedFeatures();
+  // Already counted the nested blobs during preprocessing, so just normalize the result
+  std::vector<DoubleFeature*> features;
+  features.push_back(
+      new DoubleFeature(description,
+          M_Utils::expNormalize(
+              pageData.getNestedBlobsCount(blobData->getBlobIndex()))));
+  return features;
 }
 
 int NumCompletelyNestedBlobsFeatureExtractor::countNestedBlobs(BlobData* const blob,
@@ -113,7 +119,6 @@ int NumCompletelyNestedBlobsFeatureExtractor::countNestedBlobs(BlobData* const b
     return 0;
   }
   // ----------------COMMENT AND/OR CODE IN QUESTION END----------------------
-  NumCompletelyNestedBlobsData* data = (NumCompletelyNestedBlobsData*)blob->getVariableDataAt(blobDataKey);
   BlobDataGridSearch bigs(blobDataGrid);
   bigs.StartRectSearch(blob->getBoundingBox());
   BlobData* nestblob = NULL;
@@ -166,8 +171,6 @@ int NumCompletelyNestedBlobsFeatureExtractor::countNestedBlobs(BlobData* const b
   }
 #endif
 
-  data->setNestedBlobsCount(nested);
-
   return nested;
 }
 
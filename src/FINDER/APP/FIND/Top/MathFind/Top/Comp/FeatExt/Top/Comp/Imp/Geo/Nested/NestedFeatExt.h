@@ -15,6 +15,7 @@
 #include <BlobFeatExtDesc.h>
 #include <DoubleFeature.h>
 #include <FinderInfo.h>
+#include <NestedData.h>
 
 #include <vector>
 
@@ -29,6 +30,12 @@ class NumCompletelyNestedBlobsFeatureExtractor
 
   void doPreprocessing(BlobDataGrid* const blobDataGrid);
 
+  int getPreprocessingReads();
+
+  int getPreprocessingWrites();
+
+  bool needsRecognition();
+
   virtual std::vector<DoubleFeature*> extractFeatures(BlobData* const blob);
 
   BlobFeatureExtractorDescription* getFeatureExtractorDescription();
@@ -37,7 +44,7 @@ class NumCompletelyNestedBlobsFeatureExtractor
 
   int countNestedBlobs(BlobData* const blob, BlobDataGrid* const blobDataGrid);
 
-  int blobDataKey;
+  NumCompletelyNestedBlobsData pageData;
 
   NumCompletelyNestedBlobsFeatureExtractorDescription* description;
 
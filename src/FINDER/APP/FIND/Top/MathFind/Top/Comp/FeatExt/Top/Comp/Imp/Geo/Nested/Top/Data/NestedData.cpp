@@ -7,15 +7,22 @@
 
 #include <NestedData.h>
 
-NumCompletelyNestedBlobsData::NumCompletelyNestedBlobsData() : nestedBlobsCount(0) {}
+#include <vector>
+#include <assert.h>
 
-NumCompletelyNestedBlobsData* NumCompletelyNestedBlobsData::setNestedBlobsCount(const int nestedBlobsCount) {
-  this->nestedBlobsCount = nestedBlobsCount;
-  return this;
-}
-int NumCompletelyNestedBlobsData::getNestedBlobsCount() {
-  return nestedBlobsCount;
-}
+NumCompletelyNestedBlobsData::NumCompletelyNestedBlobsData() {}
 
+void NumCompletelyNestedBlobsData::reset(const int blobCount) {
+  nestedBlobsCounts.assign(blobCount, 0);
+}
 
+void NumCompletelyNestedBlobsData::setNestedBlobsCount(const int blobIndex,
+    const int nestedBlobsCount) {
+  assert(blobIndex >= 0 && blobIndex < nestedBlobsCounts.size());
+  nestedBlobsCounts[blobIndex] = nestedBlobsCount;
+}
 
+int NumCompletelyNestedBlobsData::getNestedBlobsCount(const int blobIndex) {
+  assert(blobIndex >= 0 && blobIndex < nestedBlobsCounts.size());
+  return nestedBlobsCounts[blobIndex];
+}
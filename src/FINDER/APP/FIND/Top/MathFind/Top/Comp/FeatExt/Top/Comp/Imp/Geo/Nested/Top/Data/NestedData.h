@@ -8,27 +8,38 @@
 #ifndef NUMCOMPLETELYNESTEDBLOBSDATA_H_
 #define NUMCOMPLETELYNESTEDBLOBSDATA_H_
 
-#include <BlobFeatExtData.h>
+#include <vector>
 
-class NumCompletelyNestedBlobsData : public BlobFeatureExtractionData {
+/**
+ * Per-page data for the completely nested blobs feature extractor.
+ * Holds the nested blob count for each blob on the page, looked up by
+ * the blob's index on its grid (see BlobData::getBlobIndex).
+ */
+class NumCompletelyNestedBlobsData {
 
  public:
 
   NumCompletelyNestedBlobsData();
 
   /**
-   * Sets the number of nested blobs
+   * Clears out the counts and resizes them to hold one zeroed
+   * entry for each of the blobs on the page
+   */
+  void reset(const int blobCount);
+
+  /**
+   * Sets the number of nested blobs for the blob at the given index
    */
-  NumCompletelyNestedBlobsData* setNestedBlobsCount(const int nestedCount);
+  void setNestedBlobsCount(const int blobIndex, const int nestedCount);
 
   /**
-   * Gets the number of nested blobs
+   * Gets the number of nested blobs for the blob at the given index
    */
-  int getNestedBlobsCount();
+  int getNestedBlobsCount(const int blobIndex);
 
  private:
 
-  int nestedBlobsCount;
+  std::vector<int> nestedBlobsCounts;
 };
 
 #endif /* NUMCOMPLETELYNESTEDBLOBSDATA_H_ */
@@ -39,56 +39,37 @@ NumVerticallyStackedBlobsFeatureExtractor
 }
 
 void NumVerticallyStackedBlobsFeatureExtractor::doPreprocessing(BlobDataGrid* const blobDataGrid) {
-  blobDataKey = findOpenBlobDataIndex(blobDataGrid);
+  // Make room in this class's data for each blob on the page
+  pageData.reset(blobDataGrid->getBlobCount());
 
-  // Go ahead and extract the feature for each blob in the grid
+  // Go ahead and count the stacked blobs for each blob in the grid
   BlobDataGridSearch gridSearch(blobDataGrid);
   gridSearch.StartFullSearch();
   BlobData* blob = NULL;
   while((blob = gridSearch.NextFullSearch()) != NULL) {
-
-    // Create data entry for this feature extractor to add to the blob's variable data array
-    NumVerticallyStackedBlobsData* const data = new NumVerticallyStackedBlobsData();
-
-    // Add the data to the blob's variable data array
-    assert(blobDataKey == blob->appendNewVariableData(data));
-
-
-    if(data->hasBeenProcessed()) // this is probably no longer relevant but keeping anyway for now
-      continue;
-
     const int stacked_count =
         countStacked(blob, blobDataGrid, BlobSpatial::UP)
         + countStacked(blob, blobDataGrid, BlobSpatial::DOWN);
-
-    data->setHasBeenProcessed(true); // probably not relevant but keeping for now
-
-    data->setStackedBlobsCount(stacked_count);
-
-    data->appendExtractedFeature(
-        new DoubleFeature(
-            description,
-            M_Utils::expNormalize(
-                (double)stacked_count)));
+    pageData.setStackedBlobsCount(blob->getBlobIndex(), stacked_count);
   }
 #ifdef DBG_SHOW_STACKED_FEATURE
   gridSearch.StartFullSearch();
   Pix* dbgim2 = pixCopy(NULL, blobDataGrid->getBinaryImage());
   dbgim2 = pixConvertTo32(dbgim2);
   while((blob = gridSearch.NextFullSearch()) != NULL) {
-    NumVerticallyStackedBlobsData* const curBlobData = (NumVerticallyStackedBlobsData*)(blob->getVariableDataAt(blobDataKey));
-    if(curBlobData->getStackedBlobsCount() == 0)
+    const int stackedBlobsCount = pageData.getStackedBlobsCount(blob->getBlobIndex());
+    if(stackedBlobsCount == 0)
       continue;
-    if(curBlobData->getStackedBlobsCount() < 0) {
+    if(stackedBlobsCount < 0) {
       std::cout << "ERROR: stacked character count < 0 >:-[\n";
       assert(false);
     }
     LayoutEval::Color color;
-    if(curBlobData->getStackedBlobsCount() == 1)
+    if(stackedBlobsCount == 1)
       color = LayoutEval::RED;
-    if(curBlobData->getStackedBlobsCount() == 2)
+    if(stackedBlobsCount == 2)
       color = LayoutEval::GREEN;
-    if(curBlobData->getStackedBlobsCount() > 2)
+    if(stackedBlobsCount > 2)
       color = LayoutEval::BLUE;
     M_Utils::drawHlBlobDataRegion(blob, dbgim2, color);
   }
@@ -106,9 +87,29 @@ void NumVerticallyStackedBlobsFeatureExtractor::doPreprocessing(BlobDataGrid* co
 
 }
 
+int NumVerticallyStackedBlobsFeatureExtractor::getPreprocessingReads() {
+  return GRID_BLOBS;
+}
+
+int NumVerticallyStackedBlobsFeatureExtractor::getPreprocessingWrites() {
+  return 0;
+}
+
+// Recognition results are only used to leave out blobs that were confidently
+// recognized as text. Without them every blob is just counted.
+bool NumVerticallyStackedBlobsFeatureExtractor::needsRecognition() {
+  return false;
+}
+
 std::vector<DoubleFeature*> NumVerticallyStackedBlobsFeatureExtractor::extractFeatures(BlobData* const blobData) {
-  // Already did the extraction during preprocessing, so just return result
-  return blobData->getVariableDataAt(blobDataKey)->getExtractedFeatures();
+  // Already counted the stacked blobs during preprocessing, so just normalize the result
+  std::vector<DoubleFeature*> features;
+  features.push_back(
+      new DoubleFeature(
+          description,
+          M_Utils::expNormalize(
+              (double)pageData.getStackedBlobsCount(blobData->getBlobIndex()))));
+  return features;
 }
 
 int NumVerticallyStackedBlobsFeatureExtractor::countStacked(BlobData* const blob,
@@ -141,10 +142,8 @@ int NumVerticallyStackedBlobsFeatureExtractor::countStacked(BlobData* const blob
       (dir == BlobSpatial::UP) ? blob->getBoundingBox().top() : blob->getBoundingBox().bottom());
   BlobData* const central_blob = blob;
 
-  // Look up this feature's data entry for the current blob
-  NumVerticallyStackedBlobsData* const data = (NumVerticallyStackedBlobsData*)blob->getVariableDataAt(blobDataKey);
-
-  GenericVector<BlobData*>& stacked_blobs = data->getStackedBlobs();
+  // Look up this feature's stacked blob list for the current blob
+  GenericVector<BlobData*>& stacked_blobs = pageData.getStackedBlobs(blob->getBlobIndex());
   BlobData* stacked_blob = vsearch.NextVerticalSearch((dir == BlobSpatial::UP) ? false : true);
   BlobData* prev_stacked_blob = central_blob;
   while(true) {
@@ -271,16 +270,14 @@ bool NumVerticallyStackedBlobsFeatureExtractor::isAdjacent(
 }
 
 void NumVerticallyStackedBlobsFeatureExtractor::doSegmentationInit(BlobDataGrid* blobDataGrid) {
-  if(blobDataKey < 0) {
-    blobDataKey = findOpenBlobDataIndex(blobDataGrid);
+  // Only need to make room if preprocessing wasn't already run on this page
+  if(pageData.getBlobCount() != blobDataGrid->getBlobCount()) {
+    pageData.reset(blobDataGrid->getBlobCount());
   }
 }
 
-NumVerticallyStackedBlobsData* NumVerticallyStackedBlobsFeatureExtractor::getBlobFeatureData(BlobData* const blobData) {
-  if(blobDataKey < 0) {
-    return NULL;
-  }
-  return (NumVerticallyStackedBlobsData*)(blobData->getVariableDataAt(blobDataKey));
+NumVerticallyStackedBlobsData* NumVerticallyStackedBlobsFeatureExtractor::getPageFeatureData() {
+  return &pageData;
 }
 
 BlobFeatureExtractorDescription* NumVerticallyStackedBlobsFeatureExtractor::getFeatureExtractorDescription() {
@@ -40,6 +40,12 @@ class NumVerticallyStackedBlobsFeatureExtractor
 
   void doPreprocessing(BlobDataGrid* const blobDataGrid);
 
+  int getPreprocessingReads();
+
+  int getPreprocessingWrites();
+
+  bool needsRecognition();
+
   std::vector<DoubleFeature*> extractFeatures(BlobData* const blob);
 
   BlobFeatureExtractorDescription* getFeatureExtractorDescription();
@@ -53,9 +59,17 @@ class NumVerticallyStackedBlobsFeatureExtractor
   static bool isAdjacent(BlobData* const neighbor, BlobData* const curblob, const BlobSpatial::Direction dir,
       const bool seg_mode=false, TBOX* const dimblob=NULL);
 
+  /**
+   * Makes sure this extractor's per-page data has room for every blob
+   * on the grid when it is used for segmentation purposes
+   */
   void doSegmentationInit(BlobDataGrid* blobDataGrid);
 
-  NumVerticallyStackedBlobsData* getBlobFeatureData(BlobData* const blobData);
+  /**
+   * Gets this feature extractor's data for the current page. Entries
+   * are looked up by blob index.
+   */
+  NumVerticallyStackedBlobsData* getPageFeatureData();
 
  private:
 
@@ -64,7 +78,7 @@ class NumVerticallyStackedBlobsFeatureExtractor
    */
   int countStacked(BlobData* const blobData, BlobDataGrid* const blobDataGrid, const BlobSpatial::Direction dir);
 
-  int blobDataKey;
+  NumVerticallyStackedBlobsData pageData;
 
   NumVerticallyStackedBlobsFeatureExtractorDescription* description;
 
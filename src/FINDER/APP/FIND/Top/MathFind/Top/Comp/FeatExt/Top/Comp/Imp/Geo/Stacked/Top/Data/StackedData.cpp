@@ -7,28 +7,36 @@
 
 #include <StackedData.h>
 
-#include <BlobData.h>
-
 #include <baseapi.h>
 
+#include <vector>
+#include <assert.h>
+
 NumVerticallyStackedBlobsData::NumVerticallyStackedBlobsData()
-: hasBeenProcessed_(false) {}
+: blobCount(0) {}
 
-GenericVector<BlobData*>& NumVerticallyStackedBlobsData::getStackedBlobs() {
-  return stackedBlobs;
-}
-void NumVerticallyStackedBlobsData::setHasBeenProcessed(const bool hasBeenProcessed_) {
-  this->hasBeenProcessed_ = hasBeenProcessed_;
-}
-bool NumVerticallyStackedBlobsData::hasBeenProcessed() {
-  return hasBeenProcessed_;
-}
-void NumVerticallyStackedBlobsData::setStackedBlobsCount(const int stackedBlobsCount_) {
-  this->stackedBlobsCount_ = stackedBlobsCount_;
+void NumVerticallyStackedBlobsData::reset(const int blobCount) {
+  this->blobCount = blobCount;
+  stackedBlobsCounts.assign(blobCount, 0);
+  stackedBlobs.assign(blobCount, GenericVector<BlobData*>());
 }
-int NumVerticallyStackedBlobsData::getStackedBlobsCount() {
-  return stackedBlobsCount_;
+
+int NumVerticallyStackedBlobsData::getBlobCount() {
+  return blobCount;
 }
 
+GenericVector<BlobData*>& NumVerticallyStackedBlobsData::getStackedBlobs(const int blobIndex) {
+  assert(blobIndex >= 0 && blobIndex < blobCount);
+  return stackedBlobs[blobIndex];
+}
 
+void NumVerticallyStackedBlobsData::setStackedBlobsCount(const int blobIndex,
+    const int stackedBlobsCount) {
+  assert(blobIndex >= 0 && blobIndex < blobCount);
+  stackedBlobsCounts[blobIndex] = stackedBlobsCount;
+}
 
+int NumVerticallyStackedBlobsData::getStackedBlobsCount(const int blobIndex) {
+  assert(blobIndex >= 0 && blobIndex < blobCount);
+  return stackedBlobsCounts[blobIndex];
+}
@@ -8,31 +8,41 @@
 #ifndef NUMVERTICALLYSTACKEDBLOBSDATA_H_
 #define NUMVERTICALLYSTACKEDBLOBSDATA_H_
 
-#include <BlobFeatExtData.h>
-#include <BlobData.h>
-
 #include <baseapi.h>
 
-class NumVerticallyStackedBlobsData : public BlobFeatureExtractionData {
+#include <vector>
+
+class BlobData;
+
+/**
+ * Per-page data for the vertically stacked blobs feature extractor.
+ * Holds one entry per blob on the page in each column, looked up by
+ * the blob's index on its grid (see BlobData::getBlobIndex).
+ */
+class NumVerticallyStackedBlobsData {
 
  public:
 
   NumVerticallyStackedBlobsData();
 
-  GenericVector<BlobData*>& getStackedBlobs();
+  /**
+   * Clears out all the columns and resizes them to hold one zeroed
+   * entry for each of the blobs on the page
+   */
+  void reset(const int blobCount);
 
-  void setHasBeenProcessed(const bool hasBeenProcessed_);
+  int getBlobCount();
 
-  void setStackedBlobsCount(const int stackedBlobsCount_);
-  int getStackedBlobsCount();
+  GenericVector<BlobData*>& getStackedBlobs(const int blobIndex);
 
-  bool hasBeenProcessed();
+  void setStackedBlobsCount(const int blobIndex, const int stackedBlobsCount);
+  int getStackedBlobsCount(const int blobIndex);
 
  private:
 
-  int stackedBlobsCount_;
-  bool hasBeenProcessed_;
-  GenericVector<BlobData*> stackedBlobs;
+  int blobCount;
+  std::vector<int> stackedBlobsCounts;
+  std::vector<GenericVector<BlobData*> > stackedBlobs;
 };
 
 
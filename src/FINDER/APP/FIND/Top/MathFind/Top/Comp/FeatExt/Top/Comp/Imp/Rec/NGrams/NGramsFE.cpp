@@ -40,7 +40,8 @@ SentenceNGramsFeatureExtractor::SentenceNGramsFeatureExtractor(
      FinderInfo* const finderInfo)
 : isUnigramFlagEnabled(false),
   isBigramFlagEnabled(false),
-  isTrigramFlagEnabled(false) {
+  isTrigramFlagEnabled(false),
+  sentenceFeatures(FeatureScope::SENTENCE, 3) {
   this->finderInfo = finderInfo;
   this->description = description;
   this->stopwordHelper = description->getCategory()->getStopwordHelper();
@@ -129,22 +130,44 @@ void SentenceNGramsFeatureExtractor::doPreprocessing(
     cursentence->setNGramFeatures(ng_features);
   }
 
+  // -- finally, hand each sentence's features to all of the blobs in it
+  sentenceFeatures.reset(blobDataGrid->getBlobCount());
+  BlobDataGridSearch gridSearch(blobDataGrid);
+  gridSearch.StartFullSearch();
+  BlobData* blob = NULL;
+  while((blob = gridSearch.NextFullSearch()) != NULL) {
+    bool isNewSentence = false;
+    const int sentenceRow = sentenceFeatures.addBlob(blob, &isNewSentence);
+    if(isNewSentence) {
+      TesseractSentenceData* const blob_sentence =
+          ScopedFeatureTable::findBlobSentence(blob);
+      assert(blob_sentence->getNGramFeatures().size() != 0);
+      GenericVector<double> sentence_ngram_features = blob_sentence->getNGramFeatures();
+      for(int j = 0; j < 3; ++j)
+        sentenceFeatures.setUnitValue(sentenceRow, j, sentence_ngram_features[j]);
+    }
+  }
+
 #ifdef DBG_WRITE_EACH_SENTENCE_NGRAM_FEATURE
   dbgfs.close();
 #endif
 }
 
+int SentenceNGramsFeatureExtractor::getPreprocessingReads() {
+  return GRID_BLOBS;
+}
+
+int SentenceNGramsFeatureExtractor::getPreprocessingWrites() {
+  return SENTENCE_NGRAMS;
+}
+
 std::vector<DoubleFeature*> SentenceNGramsFeatureExtractor
 ::extractFeatures(BlobData* const blob) {
-  double unigram = (double)0, bigram = (double)0, trigram = (double)0;
-  TesseractSentenceData* blob_sentence = getBlobSentence(blob);
-  if(blob_sentence != NULL) {
-    assert(blob_sentence->getNGramFeatures().size() != 0);
-    GenericVector<double> sentence_ngram_features = blob_sentence->getNGramFeatures();
-    unigram = sentence_ngram_features[0];
-    bigram = sentence_ngram_features[1];
-    trigram = sentence_ngram_features[2];
-  }
+  // Sentence features were all computed up front (zero if not in a sentence)
+  const int blobIndex = blob->getBlobIndex();
+  const double unigram = sentenceFeatures.getBlobValue(blobIndex, 0);
+  const double bigram = sentenceFeatures.getBlobValue(blobIndex, 1);
+  const double trigram = sentenceFeatures.getBlobValue(blobIndex, 2);
 
   std::vector<DoubleFeature*> fv;
 
@@ -161,28 +184,6 @@ std::vector<DoubleFeature*> SentenceNGramsFeatureExtractor
   return fv;
 }
 
-TesseractSentenceData* SentenceNGramsFeatureExtractor::getBlobSentence(
-    BlobData* const blobData) {
-  TesseractBlockData* block  = blobData->getParentBlock();
-  if(block == NULL) {
-    return NULL;
-  }
-  TesseractWordData* word = blobData->getParentWord();
-  if(word == NULL) {
-    assert(false); // shouldn't be possible...
-    return NULL;
-  }
-  const int sentenceIndex = word->getSentenceIndex();
-  if(sentenceIndex < 0) {
-    return NULL;
-  }
-  if(sentenceIndex >= block->getRecognizedSentences().size()) {
-    std::cout << "ERROR: a tesseract word was assigned to a non-existent sentence.\n";
-    assert(false);
-  }
-  return block->getRecognizedSentences()[sentenceIndex];
-}
-
 BlobFeatureExtractorDescription* SentenceNGramsFeatureExtractor
 ::getFeatureExtractorDescription() {
   return description;
@@ -18,6 +18,7 @@
 #include <FeatExtFlagDesc.h>
 #include <NGram.h>
 #include <SentenceData.h>
+#include <ScopedFeatureTable.h>
 #include <NGramRanker.h>
 #include <StopwordHelper.h>
 #include <NGDesc.h>
@@ -41,6 +42,10 @@ class SentenceNGramsFeatureExtractor : public BlobFeatureExtractor {
 
   void doPreprocessing(BlobDataGrid* const blobDataGrid);
 
+  int getPreprocessingReads();
+
+  int getPreprocessingWrites();
+
   std::vector<DoubleFeature*> extractFeatures(BlobData* const blob);
 
   BlobFeatureExtractorDescription* getFeatureExtractorDescription();
@@ -68,9 +73,6 @@ class SentenceNGramsFeatureExtractor : public BlobFeatureExtractor {
       double ng_feat,
       RankedNGramVec profile);
 
-  TesseractSentenceData* getBlobSentence(
-      BlobData* const blobData);
-
   FinderInfo* finderInfo;
   NGramRanker* ngramRanker;
   StopwordFileReader* stopwordHelper;
@@ -83,6 +85,10 @@ class SentenceNGramsFeatureExtractor : public BlobFeatureExtractor {
   bool isBigramFlagEnabled;
   bool isTrigramFlagEnabled;
 
+  // The uni, bi, and trigram features of each sentence on the page,
+  // shared by all of the blobs in the sentence
+  ScopedFeatureTable sentenceFeatures;
+
   // debug
   std::ofstream dbgfs;
 };
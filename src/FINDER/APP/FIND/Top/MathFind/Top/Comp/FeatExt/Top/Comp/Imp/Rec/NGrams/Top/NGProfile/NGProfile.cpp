@@ -179,7 +179,7 @@ RankedNGramVecs NGramProfileGenerator::generateNewNGrams() {
     tesseract::TessBaseAPI api;
     std::string trainingImagePath = finderInfo->getGroundtruthImagePaths()[i];
     Pix* trainingImage = Utils::leptReadImg(trainingImagePath);
-    BlobDataGrid* blobDataGrid = BlobDataGridFactory().createBlobDataGrid(trainingImage, &api, Utils::getNameFromPath(trainingImagePath));
+    BlobDataGrid* blobDataGrid = finderInfo->getGridFactory().createBlobDataGrid(trainingImage, &api, Utils::getNameFromPath(trainingImagePath));
 
 #ifdef DBG_NGRAM_INIT
     bool showgrid = true;
@@ -13,6 +13,7 @@
 #include <BlobDataGrid.h>
 #include <BlobData.h>
 #include <WordData.h>
+#include <WordCache.h>
 #include <RowData.h>
 #include <M_Utils.h>
 #include <BlobFeatExtDesc.h>
@@ -43,13 +44,15 @@ OtherRecognitionFeatureExtractor
 ::OtherRecognitionFeatureExtractor(
     OtherRecognitionFeatureExtractorDescription* const description,
     FinderInfo* const finderInfo)
-: avg_blob_height(0), avg_whr(0), bad_page(false), avg_confidence(0),
+: wordFeatures(FeatureScope::WORD, NUM_WORD_FEATURES),
+  rowFeatures(FeatureScope::ROW, NUM_ROW_FEATURES),
   vdarbFlagEnabled(false), heightFlagEnabled(false),
   widthHeightFlagEnabled(false), isOcrMathFlagEnabled(false),
   isItalicFlagEnabled(false), confidenceFlagEnabled(false),
   isOcrValidFlagEnabled(false), isOnValidOcrRowFlagEnabled(false),
   isOnBadPageFlagEnabled(false), isInOcrStopwordFlagEnabled(false),
-  blobDataGrid(NULL) {
+  blobDataGrid(NULL), avg_blob_height(0), avg_whr(0), bad_page(false),
+  avg_confidence(0) {
   this->description = description;
   this->stopwordHelper = description->getCategory()->getStopwordHelper();
   this->otherFeatDir = Utils::checkTrailingSlash(
@@ -221,22 +224,23 @@ rows[i]->avg_baselinedist = avg_baseline_dist_;
   pixDestroy(&dbgim);
 #endif
 
-  // determine whether or not each blob belongs to a "math word"
+  // Word and row level features are computed once for each recognized word and
+  // row and then shared by all of the blobs belonging to them. This is also
+  // where each word is checked against the "math words" and stop words.
+  wordFeatures.reset(blobDataGrid->getBlobCount());
+  rowFeatures.reset(blobDataGrid->getBlobCount());
   bdgs.StartFullSearch();
   blob = NULL;
   while((blob = bdgs.NextFullSearch()) != NULL) {
-    if(blob->getParentWord() == NULL) {
-      continue;
+    bool isNewUnit = false;
+    const int wordRow = wordFeatures.addBlob(blob, &isNewUnit);
+    if(isNewUnit) {
+      setWordFeatures(blob->getParentWord(), wordRow);
     }
-    const char* wordStr = blob->getParentWordstr();
-    if(wordStr == NULL)
-      continue;
-    std::string blobword = (std::string)wordStr;
-    for(int i = 0; i < mathwords.length(); ++i) {
-      if(blobword == mathwords[i]) {
-        blob->getParentWord()->setResultMatchesMathWord(true);
-        break;
-      }
+    const int rowRow = rowFeatures.addBlob(blob, &isNewUnit);
+    if(isNewUnit) {
+      rowFeatures.setUnitValue(rowRow, IS_ON_VALID_OCR_ROW,
+          blob->getParentRow()->getHasValidTessWord() ? (double)1 : (double)0);
     }
   }
 #ifdef DBG_SHOW_MATHWORDS
@@ -323,29 +327,17 @@ rows[i]->avg_baselinedist = avg_baseline_dist_;
 #endif
 
 
-  // Find out which blobs belong to stop words
+  // Show which blobs belong to stop words (these were found along with the math words)
+#ifdef SHOW_STOP_WORDS
   bdgs.StartFullSearch();
   blob = NULL;
-#ifdef SHOW_STOP_WORDS
   assert(dbgim == NULL);
   dbgim = pixCopy(NULL, blobDataGrid->getBinaryImage());
   dbgim = pixConvertTo32(dbgim);
-#endif
   while((blob = bdgs.NextFullSearch()) != NULL) {
-    TesseractWordData* const parentWord = blob->getParentWord();
-    char* parentWordStr = (char*)(blob->getParentWordstr());
-    if(parentWord == NULL || parentWordStr == NULL) {
-      continue;
-    }
-    parentWord->setResultMatchesStopword(
-        stopwordHelper->isStopWord(
-            std::string(parentWordStr)));
-#ifdef SHOW_STOP_WORDS
     if(blob->belongsToRecognizedStopword())
       M_Utils::drawHlBlobDataRegion(blob, dbgim, LayoutEval::RED);
-#endif
   }
-#ifdef SHOW_STOP_WORDS
   pixWriteToDumpDir(std::string("stop_words_") +
       blobDataGrid->getImageName(),
     dbgim);
@@ -381,12 +373,51 @@ rows[i]->avg_baselinedist = avg_baseline_dist_;
 #endif
 }
 
+void OtherRecognitionFeatureExtractor::setWordFeatures(
+    TesseractWordData* const word, const int wordRow) {
+  const char* wordStr = word->wordstr();
+  if(wordStr != NULL) {
+    std::string blobword = (std::string)wordStr;
+    WordClassificationCache& wordCache = WordClassificationCache::getInstance();
+    if(wordCache.isMathWord(mathwords, blobword)) {
+      word->setResultMatchesMathWord(true);
+    }
+    word->setResultMatchesStopword(wordCache.isStopWord(stopwordHelper, blobword));
+  }
+  if(word->getResultMatchesMathWord()) {
+    wordFeatures.setUnitValue(wordRow, IS_OCR_MATH_WORD, (double)1);
+  }
+  if(word->getResultMatchesStopword()) {
+    wordFeatures.setUnitValue(wordRow, IS_OCR_STOPWORD, (double)1);
+  }
+  if(word->getIsValidTessWord()) {
+    wordFeatures.setUnitValue(wordRow, IS_OCR_VALID_WORD, (double)1);
+  }
+  if(word->getWordRes() != NULL) {
+    const FontInfo* fontInfo = word->getWordRes()->fontinfo;
+    if(fontInfo != NULL && fontInfo->is_italic()) {
+      wordFeatures.setUnitValue(wordRow, IS_ITALIC_WORD, (double)1);
+    }
+  }
+}
+
+int OtherRecognitionFeatureExtractor::getPreprocessingReads() {
+  return GRID_BLOBS;
+}
+
+int OtherRecognitionFeatureExtractor::getPreprocessingWrites() {
+  return ROW_BASELINES | WORD_MATCHES | PAGE_ITALICS;
+}
+
 
 
 std::vector<DoubleFeature*> OtherRecognitionFeatureExtractor::extractFeatures(BlobData* const blob) {
 
   std::vector<DoubleFeature*> fv;
 
+  // Word and row level features were computed during preprocessing
+  const int blobIndex = blob->getBlobIndex();
+
   /******** Height flag ********/
   if(heightFlagEnabled) {
     double h = (double)0;
@@ -440,27 +471,15 @@ std::vector<DoubleFeature*> OtherRecognitionFeatureExtractor::extractFeatures(Bl
 
   /******** Is OCR math word flag ********/
   if(isOcrMathFlagEnabled) {
-    double imw = (double)0;
-    if(blob->getParentWord() != NULL) {
-      if(blob->getParentWord()->getResultMatchesMathWord()) {
-        imw = (double)1;
-      }
-    }
+    const double imw = wordFeatures.getBlobValue(blobIndex, IS_OCR_MATH_WORD);
     fv.push_back(new DoubleFeature(description, imw, description->getIsOcrMathFlag()));
   }
 
   /******** Is italic flag ********/
   if(isItalicFlagEnabled) {
-    double is_italic = (double)0;
     assert(blobDataGrid->getNonItalicizedRatio() >= 0);
-    if(blob->getParentWord() != NULL) {
-      const FontInfo* fontInfo = blob->getParentWord()->getWordRes()->fontinfo;
-      if(fontInfo != NULL) {
-        if(fontInfo->is_italic()) {
-          is_italic = (double)1 * blobDataGrid->getNonItalicizedRatio();
-        }
-      }
-    }
+    const double is_italic = wordFeatures.getBlobValue(blobIndex, IS_ITALIC_WORD)
+        * blobDataGrid->getNonItalicizedRatio();
     fv.push_back(new DoubleFeature(description, is_italic, description->getIsItalicFlag()));
   }
 
@@ -477,25 +496,13 @@ std::vector<DoubleFeature*> OtherRecognitionFeatureExtractor::extractFeatures(Bl
 
   /******** Belongs to Valid OCR Row Flag ********/
   if(isOnValidOcrRowFlagEnabled) {
-    double in_valid_row = (double)0;
-    TesseractRowData* const rowData = blob->getParentRow();
-    if(rowData != NULL) {
-      if(rowData->getHasValidTessWord()) {
-        in_valid_row = (double)1;
-      }
-    }
+    const double in_valid_row = rowFeatures.getBlobValue(blobIndex, IS_ON_VALID_OCR_ROW);
     fv.push_back(new DoubleFeature(description, in_valid_row, description->getIsOnValidOcrRowFlag()));
   }
 
   /******** Belongs to Valid OCR Word Flag ********/
   if(isOcrValidFlagEnabled) {
-    double in_valid_word = (double)0;
-    TesseractWordData* const wordData = blob->getParentWord();
-    if(wordData != NULL) {
-      if(wordData->getIsValidTessWord()) {
-        in_valid_word = (double)1;
-      }
-    }
+    const double in_valid_word = wordFeatures.getBlobValue(blobIndex, IS_OCR_VALID_WORD);
     fv.push_back(new DoubleFeature(description, in_valid_word, description->getIsOcrValidFlag()));
   }
 
@@ -510,13 +517,7 @@ std::vector<DoubleFeature*> OtherRecognitionFeatureExtractor::extractFeatures(Bl
 
   /******** Belongs to Stopword Flag ********/
   if(isInOcrStopwordFlagEnabled) {
-    double stop_word = (double)0;
-    TesseractWordData* const wordData = blob->getParentWord();
-    if(wordData != NULL) {
-      if(wordData->getResultMatchesStopword()) {
-        stop_word = (double)1;
-      }
-    }
+    const double stop_word = wordFeatures.getBlobValue(blobIndex, IS_OCR_STOPWORD);
     fv.push_back(new DoubleFeature(description, stop_word, description->getIsInOcrStopwordFlag()));
   }
 
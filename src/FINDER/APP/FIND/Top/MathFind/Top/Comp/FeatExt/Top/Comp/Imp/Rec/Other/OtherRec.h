@@ -17,6 +17,8 @@
 #include <CharData.h>
 #include <FeatExtFlagDesc.h>
 #include <StopwordHelper.h>
+#include <ScopedFeatureTable.h>
+#include <WordData.h>
 
 #include <baseapi.h>
 
@@ -37,6 +39,10 @@ class OtherRecognitionFeatureExtractor : public virtual BlobFeatureExtractor {
 
   void doPreprocessing(BlobDataGrid* const blobDataGrid);
 
+  int getPreprocessingReads();
+
+  int getPreprocessingWrites();
+
   std::vector<DoubleFeature*> extractFeatures(BlobData* const blob);
 
   BlobFeatureExtractorDescription* getFeatureExtractorDescription();
@@ -58,6 +64,20 @@ class OtherRecognitionFeatureExtractor : public virtual BlobFeatureExtractor {
 
   double findBaselineDist(TesseractCharData* tesseractCharData);
 
+  /**
+   * Matches the word against the math words and stop words and fills in
+   * its row of word level features
+   */
+  void setWordFeatures(TesseractWordData* const word, const int wordRow);
+
+  // Features which are properties of a whole word or row, computed once
+  // per page for each of them and shared by all of their blobs
+  enum WordFeature {IS_OCR_MATH_WORD, IS_ITALIC_WORD, IS_OCR_VALID_WORD,
+    IS_OCR_STOPWORD, NUM_WORD_FEATURES};
+  enum RowFeature {IS_ON_VALID_OCR_ROW, NUM_ROW_FEATURES};
+  ScopedFeatureTable wordFeatures;
+  ScopedFeatureTable rowFeatures;
+
   bool vdarbFlagEnabled;
   bool heightFlagEnabled;
   bool widthHeightFlagEnabled;
@@ -42,20 +42,13 @@ SubOrSuperscriptsFeatureExtractor
 }
 
 void SubOrSuperscriptsFeatureExtractor::doPreprocessing(BlobDataGrid* const blobDataGrid) {
-  blobSubscriptDataKey = findOpenBlobDataIndex(blobDataGrid);
+  // Clear out the sub/superscript flags for each blob in the grid
+  pageData.reset(blobDataGrid->getBlobCount());
 
-  // Create the sub/superscript data for each blob in the grid
+  // Determine the enabled features for each blob in the grid
   BlobDataGridSearch gridSearch(blobDataGrid);
   gridSearch.StartFullSearch();
   BlobData* blobData = NULL;
-  while((blobData = gridSearch.NextFullSearch()) != NULL) {
-    SubOrSuperscriptsData* const data = new SubOrSuperscriptsData();
-    assert(blobSubscriptDataKey == blobData->appendNewVariableData(data));
-  }
-
-  // Determine the enabled features for each blob in the grid
-  gridSearch.StartFullSearch();
-  blobData = NULL;
   while((blobData = gridSearch.NextFullSearch()) != NULL) {
     // figure out whether or not the blob has sub/superscripts
     // and update data accordingly
@@ -71,12 +64,12 @@ void SubOrSuperscriptsFeatureExtractor::doPreprocessing(BlobDataGrid* const blob
    dbgss_im = pixConvertTo32(dbgss_im);
    gridSearch.StartFullSearch();
    while((blobData = gridSearch.NextFullSearch()) != NULL) {
-     SubOrSuperscriptsData* const ssData = (SubOrSuperscriptsData*)blobData->getVariableDataAt(blobSubscriptDataKey);
-     if(ssData->hasSuperscript || ssData->hasSubscript)
+     const int i = blobData->getBlobIndex();
+     if(pageData.hasSuperscript[i] || pageData.hasSubscript[i])
        M_Utils::drawHlBlobDataRegion(blobData, dbgss_im, LayoutEval::RED);
-     else if(ssData->isSuperscript)
+     else if(pageData.isSuperscript[i])
        M_Utils::drawHlBlobDataRegion(blobData, dbgss_im, LayoutEval::GREEN);
-     else if(ssData->isSubscript)
+     else if(pageData.isSubscript[i])
        M_Utils::drawHlBlobDataRegion(blobData, dbgss_im, LayoutEval::BLUE);
    }
    if(!(Utils::existsDirectory(subSupDir))) {
@@ -92,21 +85,29 @@ void SubOrSuperscriptsFeatureExtractor::doPreprocessing(BlobDataGrid* const blob
  #endif
 }
 
+int SubOrSuperscriptsFeatureExtractor::getPreprocessingReads() {
+  return GRID_BLOBS;
+}
+
+int SubOrSuperscriptsFeatureExtractor::getPreprocessingWrites() {
+  return 0;
+}
+
 std::vector<DoubleFeature*> SubOrSuperscriptsFeatureExtractor::extractFeatures(BlobData* const blobData) {
   double has_sup = (double)0, has_sub = (double)0,
       is_sup = (double)0, is_sub = (double)0;
 
   const double bin_val = (double)1;
 
-  SubOrSuperscriptsData* const blobSubOrSuperscriptData = (SubOrSuperscriptsData*)blobData->getVariableDataAt(blobSubscriptDataKey);
+  const int blobIndex = blobData->getBlobIndex();
 
-  if(blobSubOrSuperscriptData->hasSubscript)
+  if(pageData.hasSubscript[blobIndex])
     has_sub = bin_val;
-  if(blobSubOrSuperscriptData->isSubscript)
+  if(pageData.isSubscript[blobIndex])
     is_sub = bin_val;
-  if(blobSubOrSuperscriptData->hasSuperscript)
+  if(pageData.hasSuperscript[blobIndex])
     has_sup = bin_val;
-  if(blobSubOrSuperscriptData->isSuperscript)
+  if(pageData.isSuperscript[blobIndex])
     is_sup = bin_val;
 
 #ifdef DBG_FEAT3
@@ -118,8 +119,10 @@ std::vector<DoubleFeature*> SubOrSuperscriptsFeatureExtractor::extractFeatures(B
   }
 #endif
 
+  std::vector<DoubleFeature*> features;
+
   if(hasSubFeatureEnabled) {
-    blobSubOrSuperscriptData->appendExtractedFeature(
+    features.push_back(
         new DoubleFeature(
             description,
             has_sub,
@@ -127,7 +130,7 @@ std::vector<DoubleFeature*> SubOrSuperscriptsFeatureExtractor::extractFeatures(B
   }
 
   if(isSubFeatureEnabled) {
-    blobSubOrSuperscriptData->appendExtractedFeature(
+    features.push_back(
         new DoubleFeature(
             description,
             is_sub,
@@ -135,7 +138,7 @@ std::vector<DoubleFeature*> SubOrSuperscriptsFeatureExtractor::extractFeatures(B
   }
 
   if(hasSupFeatureEnabled) {
-    blobSubOrSuperscriptData->appendExtractedFeature(
+    features.push_back(
         new DoubleFeature(
             description,
             has_sup,
@@ -143,14 +146,14 @@ std::vector<DoubleFeature*> SubOrSuperscriptsFeatureExtractor::extractFeatures(B
   }
 
   if(isSupFeatureEnabled) {
-    blobSubOrSuperscriptData->appendExtractedFeature(
+    features.push_back(
         new DoubleFeature(
             description,
             is_sup,
             description->getIsSuperscriptDescription()));
   }
 
-  return blobSubOrSuperscriptData->getExtractedFeatures();
+  return features;
 }
 
 // Determines whether or not the blob in question has a super/subscript
@@ -188,8 +191,8 @@ void SubOrSuperscriptsFeatureExtractor::setBlobSubSuperScript(BlobData* const bl
 
   // ----------------COMMENT AND/OR CODE IN QUESTION END-----------------------
 
-  // Get pointer to relevant data in this blob
-  SubOrSuperscriptsData* const data = (SubOrSuperscriptsData*)blob->getVariableDataAt(blobSubscriptDataKey);
+  // Get the index of this blob's entries in the page data
+  const int blobIndex = blob->getBlobIndex();
 
   inT16 h_adj_thresh = blob->getBoundingBox().width() / 2;
   inT32 area_thresh = blob->getBoundingBox().area() / 8;
@@ -232,8 +235,8 @@ void SubOrSuperscriptsFeatureExtractor::setBlobSubSuperScript(BlobData* const bl
     }
     // ----------------COMMENT AND/OR CODE IN QUESTION START---------------------
 
-    // get the neighbor's relevant data so I can update it based on results
-    SubOrSuperscriptsData* const neighborData = (SubOrSuperscriptsData*)neighbor->getVariableDataAt(blobSubscriptDataKey);
+    // get the neighbor's index so I can update its entries based on results
+    const int neighborIndex = neighbor->getBlobIndex();
     if(subsuper == SUPER) {
       if(neighbor->getBoundingBox().bottom()
           > (blob_center_y -
@@ -243,8 +246,8 @@ void SubOrSuperscriptsFeatureExtractor::setBlobSubSuperScript(BlobData* const bl
 #ifdef DBG_SUB_SUPER
         dbgSubSuper(blob, neighbor, subsuper);
 #endif
-        data->hasSuperscript = true;
-        neighborData->isSuperscript = true;
+        pageData.hasSuperscript[blobIndex] = true;
+        pageData.isSuperscript[neighborIndex] = true;
         break;
       }
     }
@@ -253,8 +256,8 @@ void SubOrSuperscriptsFeatureExtractor::setBlobSubSuperScript(BlobData* const bl
 #ifdef DBG_SUB_SUPER
         dbgSubSuper(blob, neighbor, subsuper);
 #endif
-        data->hasSubscript = true;
-        neighborData->isSubscript = true;
+        pageData.hasSubscript[blobIndex] = true;
+        pageData.isSubscript[neighborIndex] = true;
         break;
       }
     }
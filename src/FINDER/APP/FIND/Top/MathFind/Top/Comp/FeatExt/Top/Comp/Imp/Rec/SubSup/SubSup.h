@@ -16,6 +16,7 @@
 #include <FeatExtFlagDesc.h>
 #include <BlobData.h>
 #include <FinderInfo.h>
+#include <SubSupData.h>
 
 #include <vector>
 
@@ -32,6 +33,10 @@ public:
 
   void doPreprocessing(BlobDataGrid* const blobDataGrid);
 
+  int getPreprocessingReads();
+
+  int getPreprocessingWrites();
+
   std::vector<DoubleFeature*> extractFeatures(BlobData* const blob);
 
   BlobFeatureExtractorDescription* getFeatureExtractorDescription();
@@ -51,7 +56,7 @@ public:
   void setBlobSubSuperScript(BlobData* const blob, BlobDataGrid* const blobDataGrid,
       const SubSuperScript subsuper);
 
-  int blobSubscriptDataKey;
+  SubOrSuperscriptsData pageData;
 
   SubOrSuperscriptsFeatureExtractorDescription* description;
   std::vector<FeatureExtractorFlagDescription*> enabledFlagDescriptions;
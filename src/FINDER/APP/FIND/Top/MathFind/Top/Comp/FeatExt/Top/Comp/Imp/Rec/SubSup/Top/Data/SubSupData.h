@@ -8,14 +8,32 @@
 #ifndef SUBORSUPERSCRIPTSDATA_H_
 #define SUBORSUPERSCRIPTSDATA_H_
 
-class SubOrSuperscriptsData : public BlobFeatureExtractionData {
+#include <vector>
+
+/**
+ * Per-page data for the sub/superscripts feature extractor. Each flag
+ * is kept in a column with one entry per blob on the page, looked up by
+ * the blob's index on its grid (see BlobData::getBlobIndex).
+ */
+class SubOrSuperscriptsData {
 
  public:
 
-  bool hasSuperscript;
-  bool isSuperscript;
-  bool hasSubscript;
-  bool isSubscript;
+  /**
+   * Clears out all the flags and resizes the columns to hold one
+   * entry for each of the blobs on the page
+   */
+  void reset(const int blobCount) {
+    hasSuperscript.assign(blobCount, false);
+    isSuperscript.assign(blobCount, false);
+    hasSubscript.assign(blobCount, false);
+    isSubscript.assign(blobCount, false);
+  }
+
+  std::vector<bool> hasSuperscript;
+  std::vector<bool> isSuperscript;
+  std::vector<bool> hasSubscript;
+  std::vector<bool> isSubscript;
 };
 
 #endif /* SUBORSUPERSCRIPTSDATA_H_ */
@@ -0,0 +1,17 @@
+/*
+ * FeatureScope.h
+ */
+
+#ifndef FEATURESCOPE_H_
+#define FEATURESCOPE_H_
+
+/**
+ * The unit a feature is a property of. Blob scoped features are computed
+ * for each blob while the others are computed once for each recognized word,
+ * row, or sentence and shared by all of the blobs belonging to it.
+ */
+namespace FeatureScope {
+  enum Scope {BLOB, WORD, ROW, SENTENCE};
+}
+
+#endif /* FEATURESCOPE_H_ */
@@ -0,0 +1,114 @@
+/*
+ * ScopedFeatureTable.cpp
+ */
+
+#include <ScopedFeatureTable.h>
+
+#include <BlobData.h>
+#include <WordData.h>
+#include <RowData.h>
+#include <BlockData.h>
+#include <SentenceData.h>
+
+#include <vector>
+#include <iostream>
+#include <assert.h>
+
+ScopedFeatureTable::ScopedFeatureTable(const FeatureScope::Scope scope,
+    const int numFeatures) : scope(scope), numFeatures(numFeatures) {
+  assert(numFeatures > 0);
+  if(scope == FeatureScope::BLOB) {
+    std::cout << "ERROR: Blob scoped features don't belong in a ScopedFeatureTable\n";
+    assert(false);
+  }
+}
+
+void ScopedFeatureTable::reset(const int blobCount) {
+  blobUnits.assign(blobCount, -1);
+  unitValues.clear();
+  unitRows.clear();
+}
+
+int ScopedFeatureTable::addBlob(BlobData* const blob, bool* const isNewUnit) {
+  const int blobIndex = blob->getBlobIndex();
+  assert(blobIndex >= 0 && blobIndex < blobUnits.size());
+  *isNewUnit = false;
+  const void* const unit = findUnit(blob, scope);
+  if(unit == NULL) {
+    blobUnits[blobIndex] = -1;
+    return -1;
+  }
+  std::unordered_map<const void*, int>::const_iterator found = unitRows.find(unit);
+  int unitRow = -1;
+  if(found == unitRows.end()) {
+    unitRow = getUnitCount();
+    unitRows[unit] = unitRow;
+    unitValues.resize(unitValues.size() + numFeatures, (double)0);
+    *isNewUnit = true;
+  } else {
+    unitRow = found->second;
+  }
+  blobUnits[blobIndex] = unitRow;
+  return unitRow;
+}
+
+void ScopedFeatureTable::setUnitValue(const int unitRow,
+    const int featureIndex, const double value) {
+  assert(unitRow >= 0 && unitRow < getUnitCount());
+  assert(featureIndex >= 0 && featureIndex < numFeatures);
+  unitValues[unitRow * numFeatures + featureIndex] = value;
+}
+
+double ScopedFeatureTable::getBlobValue(const int blobIndex,
+    const int featureIndex) {
+  assert(featureIndex >= 0 && featureIndex < numFeatures);
+  if(!belongsToUnit(blobIndex)) {
+    return (double)0;
+  }
+  return unitValues[blobUnits[blobIndex] * numFeatures + featureIndex];
+}
+
+bool ScopedFeatureTable::belongsToUnit(const int blobIndex) {
+  assert(blobIndex >= 0 && blobIndex < blobUnits.size());
+  return blobUnits[blobIndex] >= 0;
+}
+
+int ScopedFeatureTable::getUnitCount() {
+  return unitValues.size() / numFeatures;
+}
+
+const void* ScopedFeatureTable::findUnit(BlobData* const blob,
+    const FeatureScope::Scope scope) {
+  switch(scope) {
+    case FeatureScope::WORD:
+      return blob->getParentWord();
+    case FeatureScope::ROW:
+      return blob->getParentRow();
+    case FeatureScope::SENTENCE:
+      return findBlobSentence(blob);
+    default:
+      return NULL;
+  }
+}
+
+TesseractSentenceData* ScopedFeatureTable::findBlobSentence(
+    BlobData* const blob) {
+  TesseractBlockData* block  = blob->getParentBlock();
+  if(block == NULL) {
+    return NULL;
+  }
+  TesseractWordData* word = blob->getParentWord();
+  if(word == NULL) {
+    assert(false); // shouldn't be possible...
+    return NULL;
+  }
+  const int sentenceIndex = word->getSentenceIndex();
+  if(sentenceIndex < 0) {
+    return NULL;
+  }
+  if(sentenceIndex >= block->getRecognizedSentences().size()) {
+    std::cout << "ERROR: a tesseract word was assigned to a non-existent sentence.\n";
+    assert(false);
+  }
+  return block->getRecognizedSentences()[sentenceIndex];
+}
@@ -0,0 +1,81 @@
+/*
+ * ScopedFeatureTable.h
+ */
+
+#ifndef SCOPEDFEATURETABLE_H_
+#define SCOPEDFEATURETABLE_H_
+
+#include <FeatureScope.h>
+
+#include <BlobData.h>
+#include <SentenceData.h>
+
+#include <vector>
+#include <unordered_map>
+
+/**
+ * Per-page table of feature values which are properties of a recognized
+ * word, row, or sentence rather than of an individual blob. Each unit gets
+ * one row of values which is computed the first time one of its blobs is
+ * added and then broadcast to the rest of its blobs. Blobs are looked up by
+ * their index on the grid (see BlobData::getBlobIndex).
+ *
+ * Typical use during preprocessing is to add every blob on the page and fill
+ * in the values whenever addBlob reports a unit that hasn't been seen yet.
+ */
+class ScopedFeatureTable {
+
+ public:
+
+  ScopedFeatureTable(const FeatureScope::Scope scope, const int numFeatures);
+
+  /**
+   * Clears out the table and makes room for the given number of blobs
+   */
+  void reset(const int blobCount);
+
+  /**
+   * Assigns the blob to the unit it belongs to at this table's scope. If the
+   * unit hasn't been seen yet then it's given a new row of values (all zero)
+   * and isNewUnit is set to true so the caller knows to compute them.
+   * Returns the unit's row or -1 if the blob doesn't belong to a unit at
+   * this scope.
+   */
+  int addBlob(BlobData* const blob, bool* const isNewUnit);
+
+  void setUnitValue(const int unitRow, const int featureIndex,
+      const double value);
+
+  /**
+   * Gets the value of the given feature for the unit the blob at the given
+   * index belongs to, or zero if it doesn't belong to one
+   */
+  double getBlobValue(const int blobIndex, const int featureIndex);
+
+  bool belongsToUnit(const int blobIndex);
+
+  int getUnitCount();
+
+  /**
+   * Gets the word, row, or sentence the blob belongs to at the given scope.
+   * Returns NULL if it doesn't belong to one (or if the scope is BLOB).
+   */
+  static const void* findUnit(BlobData* const blob,
+      const FeatureScope::Scope scope);
+
+  /**
+   * Gets the sentence the blob belongs to or NULL if it isn't in one
+   */
+  static TesseractSentenceData* findBlobSentence(BlobData* const blob);
+
+ private:
+
+  FeatureScope::Scope scope;
+  int numFeatures;
+
+  std::vector<int> blobUnits; // each blob's row in the table (-1 if none)
+  std::vector<double> unitValues; // numFeatures values for each unit, one unit after another
+  std::unordered_map<const void*, int> unitRows;
+};
+
+#endif /* SCOPEDFEATURETABLE_H_ */
@@ -0,0 +1,168 @@
+/*
+ * PreprocSched.cpp
+ */
+
+#include <PreprocSched.h>
+
+#include <BlobFeatExt.h>
+#include <BlobDataGrid.h>
+
+#include <dlib/threads.h>
+
+#include <new>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <assert.h>
+
+//#define DBG_PREPROC_SCHED
+
+PreprocessingScheduler::PreprocessingScheduler(
+    std::vector<BlobFeatureExtractor*> blobFeatureExtractors,
+    int numThreads) : threadPool(NULL) {
+  this->blobFeatureExtractors = blobFeatureExtractors;
+  const int numExtractors = blobFeatureExtractors.size();
+  numDependencies.assign(numExtractors, 0);
+  dependents.assign(numExtractors, std::vector<int>());
+  for(int j = 0; j < numExtractors; ++j) {
+    for(int i = 0; i < j; ++i) {
+      if(conflicts(i, j)) {
+        ++numDependencies[j];
+        dependents[i].push_back(j);
+#ifdef DBG_PREPROC_SCHED
+        std::cout << blobFeatureExtractors[j]->getFeatureExtractorDescription()->getName()
+            << " preprocessing waits on "
+            << blobFeatureExtractors[i]->getFeatureExtractorDescription()->getName()
+            << std::endl;
+#endif
+      }
+    }
+  }
+  if(numThreads < 1) {
+    numThreads = (int)std::thread::hardware_concurrency();
+  }
+  if(numThreads > numExtractors) {
+    numThreads = numExtractors;
+  }
+  if(numThreads < 1) {
+    numThreads = 1;
+  }
+  this->numThreads = numThreads;
+  if(numThreads > 1) {
+    threadPool = new dlib::thread_pool(numThreads);
+  }
+}
+
+bool PreprocessingScheduler::conflicts(const int i, const int j) {
+  BlobFeatureExtractor* const first = blobFeatureExtractors[i];
+  BlobFeatureExtractor* const second = blobFeatureExtractors[j];
+  const int firstWrites = first->getPreprocessingWrites();
+  const int secondWrites = second->getPreprocessingWrites();
+  return ((firstWrites & (second->getPreprocessingReads() | secondWrites)) != 0)
+      || ((first->getPreprocessingReads() & secondWrites) != 0);
+}
+
+void PreprocessingScheduler::runPreprocessing(BlobDataGrid* const blobDataGrid) {
+  const int numExtractors = blobFeatureExtractors.size();
+
+  // Nothing to gain from the pool, so just go in order
+  if(threadPool == NULL) {
+    for(int i = 0; i < numExtractors; ++i) {
+      blobFeatureExtractors[i]->doPreprocessing(blobDataGrid);
+    }
+    return;
+  }
+
+  dlib::mutex finishedMutex;
+  dlib::signaler finishedSignaler(finishedMutex);
+  std::vector<int> finished;
+  bool outOfMemory = false;
+
+  std::vector<int> waitingOn = numDependencies;
+  std::vector<int> ready;
+  for(int i = 0; i < numExtractors; ++i) {
+    if(waitingOn[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+
+  // Hand off whatever is ready, then wait for something to finish and
+  // see what that frees up, until every extractor is done (or, once one has
+  // run out of memory, until the ones already handed off are done)
+  int numStarted = 0;
+  int numFinished = 0;
+  bool stopping = false;
+  while(numFinished < (stopping ? numStarted : numExtractors)) {
+    if(stopping) {
+      ready.clear();
+    }
+    for(int i = 0; i < ready.size(); ++i) {
+      PreprocessingTask task;
+      task.extractor = blobFeatureExtractors[ready[i]];
+      task.blobDataGrid = blobDataGrid;
+      task.index = ready[i];
+      task.finished = &finished;
+      task.outOfMemory = &outOfMemory;
+      task.finishedMutex = &finishedMutex;
+      task.finishedSignaler = &finishedSignaler;
+      threadPool->add_task_by_value(task);
+      ++numStarted;
+    }
+    ready.clear();
+
+    std::vector<int> justFinished;
+    finishedMutex.lock();
+    while(finished.empty()) {
+      finishedSignaler.wait();
+    }
+    justFinished.swap(finished);
+    stopping = outOfMemory;
+    finishedMutex.unlock();
+
+    for(int i = 0; i < justFinished.size(); ++i) {
+      const int index = justFinished[i];
+      ++numFinished;
+      for(int j = 0; j < dependents[index].size(); ++j) {
+        const int dependent = dependents[index][j];
+        --waitingOn[dependent];
+        assert(waitingOn[dependent] >= 0);
+        if(waitingOn[dependent] == 0) {
+          ready.push_back(dependent);
+        }
+      }
+    }
+  }
+  if(stopping) {
+    throw std::bad_alloc();
+  }
+  assert(ready.empty()); // sanity
+}
+
+void PreprocessingScheduler::PreprocessingTask::operator()() {
+#ifdef DBG_PREPROC_SCHED
+  std::cout << "Running preprocessing for the "
+      << extractor->getFeatureExtractorDescription()->getName() << " extractor.\n";
+#endif
+  bool ranOutOfMemory = false;
+  try {
+    extractor->doPreprocessing(blobDataGrid);
+  } catch(std::bad_alloc&) {
+    ranOutOfMemory = true;
+  }
+  finishedMutex->lock();
+  *outOfMemory = *outOfMemory || ranOutOfMemory;
+  finished->push_back(index);
+  finishedSignaler->signal();
+  finishedMutex->unlock();
+}
+
+int PreprocessingScheduler::getNumThreads() {
+  return numThreads;
+}
+
+PreprocessingScheduler::~PreprocessingScheduler() {
+  if(threadPool != NULL) {
+    delete threadPool;
+    threadPool = NULL;
+  }
+}
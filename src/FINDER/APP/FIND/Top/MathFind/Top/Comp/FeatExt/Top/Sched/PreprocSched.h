@@ -0,0 +1,85 @@
+/*
+ * PreprocSched.h
+ */
+
+#ifndef PREPROCSCHED_H_
+#define PREPROCSCHED_H_
+
+#include <BlobFeatExt.h>
+
+#include <BlobDataGrid.h>
+
+#include <dlib/threads.h>
+
+#include <vector>
+
+/**
+ * Runs the preprocessing for a set of blob feature extractors as a task graph
+ * on a pool of threads. Each extractor declares the page resources its
+ * preprocessing reads and writes (see BlobFeatureExtractor::PageResource).
+ * An extractor has to wait on every extractor listed before it that writes
+ * something it reads or writes, or that reads something it writes. Everything
+ * else is free to run at the same time, so the time spent preprocessing a page
+ * should approach that of the slowest extractor. Extractors which conflict
+ * are always run in the order they were given in.
+ */
+class PreprocessingScheduler {
+
+ public:
+
+  /**
+   * Builds the dependency graph for the given extractors. If the number of
+   * threads given is less than 1 then one thread is used for each core
+   * on the machine (up to one per extractor).
+   */
+  PreprocessingScheduler(std::vector<BlobFeatureExtractor*> blobFeatureExtractors,
+      int numThreads=0);
+
+  /**
+   * Runs the preprocessing for all of the extractors on the given grid and
+   * returns once all of them have finished. If an extractor runs out of
+   * memory on a pool thread (i.e., by going over a PageMemoryLimit) then no
+   * more extractors are started and std::bad_alloc is thrown on the calling
+   * thread once the ones already running have finished.
+   */
+  void runPreprocessing(BlobDataGrid* const blobDataGrid);
+
+  int getNumThreads();
+
+  ~PreprocessingScheduler();
+
+ private:
+
+  /**
+   * Whether the extractor at index j has to wait on the one at index i
+   */
+  bool conflicts(const int i, const int j);
+
+  /**
+   * Runs one extractor's preprocessing on a pool thread and then lets
+   * the scheduler know that it has finished (or ran out of memory, since an
+   * exception can't be let out of a pool thread)
+   */
+  struct PreprocessingTask {
+    BlobFeatureExtractor* extractor;
+    BlobDataGrid* blobDataGrid;
+    int index;
+    std::vector<int>* finished;
+    bool* outOfMemory;
+    dlib::mutex* finishedMutex;
+    dlib::signaler* finishedSignaler;
+    void operator()();
+  };
+
+  std::vector<BlobFeatureExtractor*> blobFeatureExtractors;
+
+  // For each extractor, the number of extractors it waits on and the
+  // indices of the extractors waiting on it
+  std::vector<int> numDependencies;
+  std::vector<std::vector<int> > dependents;
+
+  int numThreads;
+  dlib::thread_pool* threadPool; // NULL when everything is run on the calling thread
+};
+
+#endif /* PREPROCSCHED_H_ */
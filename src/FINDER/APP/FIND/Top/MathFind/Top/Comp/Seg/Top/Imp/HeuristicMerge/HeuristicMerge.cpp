@@ -185,13 +185,10 @@ void HeuristicMerge::runSegmentation(BlobDataGrid* const blobDataGrid) {
     bdgs.StartFullSearch();
     bdgs.SetUniqueMode(true);
     BlobData* curblob = NULL;
+    NumAlignedBlobsData* numAlignedBlobsData =
+        numAlignedBlobsFeatureExtractor->getPageFeatureData();
     while((curblob = bdgs.NextFullSearch()) != NULL) {
-      NumAlignedBlobsData* numAlignedBlobsData =
-          numAlignedBlobsFeatureExtractor->getBlobFeatureData(curblob);
-      numAlignedBlobsData->dvabc_blobs.clear();
-      numAlignedBlobsData->uvabc_blobs.clear();
-      numAlignedBlobsData->lhabc_blobs.clear();
-      numAlignedBlobsData->rhabc_blobs.clear();
+      numAlignedBlobsData->clearBuffers(curblob->getBlobIndex());
     }
   }
 
@@ -332,7 +329,7 @@ void HeuristicMerge::decideAndMerge(BlobData* blob,
         blob->getBoundingBox().right(),
         blob->getBoundingBox().top());
     RESULT_TYPE segRes;
-    if(blob->belongsToRecognizedNormalRow())
+    if(blob->belongsToNormalRow())
       segRes = EMBEDDED;
     else
       segRes = DISPLAYED;
@@ -503,8 +500,9 @@ void HeuristicMerge::mergeDecision(BlobData* blob, BlobSpatial::Direction dir) {
 //    : dir == BlobSpatial::RIGHT ? "right." : dir == BlobSpatial::UP ?
 //        "up." : "down.") << "\n";
   // Get the blob's data associated with the feature extractor
-  NumAlignedBlobsData* numAlignedBlobsData = numAlignedBlobsFeatureExtractor->getBlobFeatureData(blob);
-  numAlignedBlobsData->clearBuffers(); // only care about what is computed here (not on prev recursions)
+  NumAlignedBlobsData* numAlignedBlobsData = numAlignedBlobsFeatureExtractor->getPageFeatureData();
+  const int blobIndex = blob->getBlobIndex();
+  numAlignedBlobsData->clearBuffers(blobIndex); // only care about what is computed here (not on prev recursions)
 
   //GenericVector<BlobData*> stacked_merges;
 
@@ -516,17 +514,21 @@ void HeuristicMerge::mergeDecision(BlobData* blob, BlobSpatial::Direction dir) {
   if(dir == BlobSpatial::LEFT || dir == BlobSpatial::RIGHT) {
     assert(covered_merges.empty());
     if(dir == BlobSpatial::LEFT) {
-      covered_merges = filterAlreadyMerged(numAlignedBlobsData->lhabc_blobs);
+      covered_merges = filterAlreadyMerged(
+          numAlignedBlobsData->getCoveredBlobs(blobIndex, BlobSpatial::LEFT));
     } else {
-      covered_merges = filterAlreadyMerged(numAlignedBlobsData->rhabc_blobs);
+      covered_merges = filterAlreadyMerged(
+          numAlignedBlobsData->getCoveredBlobs(blobIndex, BlobSpatial::RIGHT));
     }
   }
   else { // vertical merge decision
     assert(covered_merges.empty());
     if(dir == BlobSpatial::DOWN)
-      covered_merges = filterAlreadyMerged(numAlignedBlobsData->dvabc_blobs);
+      covered_merges = filterAlreadyMerged(
+          numAlignedBlobsData->getCoveredBlobs(blobIndex, BlobSpatial::DOWN));
     else
-      covered_merges = filterAlreadyMerged(numAlignedBlobsData->uvabc_blobs);
+      covered_merges = filterAlreadyMerged(
+          numAlignedBlobsData->getCoveredBlobs(blobIndex, BlobSpatial::UP));
   }
 
 #ifdef DBG_SHOW_MERGE
@@ -0,0 +1,302 @@
+/*
+ * PagePipeline.cpp
+ */
+
+#include <PagePipeline.h>
+
+#include <MathExpressionFinder.h>
+#include <BlobDataGridFactory.h>
+#include <BlobDataGrid.h>
+#include <MFinderResults.h>
+#include <PageSource.h>
+#include <ResolutionNormalizer.h>
+#include <Utils.h>
+
+#include <dlib/pipe.h>
+#include <dlib/threads.h>
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <assert.h>
+
+//#define DBG_PAGE_PIPELINE
+
+PagePipelineConfig::PagePipelineConfig() : readWorkers(1), gridWorkers(1),
+    writeWorkers(1), queueSize(2), releaseWrittenImages(false) {}
+
+PagePipeline::PagePipeline(MathExpressionFinder* const finder,
+    const RunMode runMode, const PagePipelineConfig& config)
+: finder(finder), runMode(runMode), config(config), pageSources(NULL),
+  imageNames(NULL), keepImages(false), readQueue(NULL), gridQueue(NULL),
+  writeQueue(NULL), nextImage(0), readWorkersLeft(0), gridWorkersLeft(0),
+  analysisWorkersLeft(0) {
+  if(this->config.readWorkers < 1) {
+    this->config.readWorkers = 1;
+  }
+  if(this->config.gridWorkers < 1) {
+    this->config.gridWorkers = 1;
+  }
+  if(this->config.writeWorkers < 1) {
+    this->config.writeWorkers = 1;
+  }
+  if(this->config.queueSize < 1) {
+    this->config.queueSize = 1;
+  }
+}
+
+std::vector<MathExpressionFinderResults*> PagePipeline::run(
+    const std::vector<PageSource>& pageSources,
+    const std::vector<std::string>& imageNames,
+    const std::string& resultsDirName,
+    Pixa* const keptImages) {
+  assert(pageSources.size() == imageNames.size());
+  this->pageSources = &pageSources;
+  this->imageNames = &imageNames;
+  this->resultsDirName = resultsDirName;
+  keepImages = (keptImages != NULL);
+  results.assign(pageSources.size(), NULL);
+  images.assign(pageSources.size(), NULL);
+  nextImage = 0;
+  readWorkersLeft = config.readWorkers;
+  gridWorkersLeft = config.gridWorkers;
+  analysisWorkersLeft = 1;
+
+  if(resultsDirName != "" && !Utils::existsDirectory(resultsDirName)) {
+    Utils::exec("mkdir -p " + resultsDirName);
+  }
+
+  readQueue = new PageQueue(config.queueSize);
+  gridQueue = new PageQueue(config.queueSize);
+  writeQueue = new PageQueue(config.queueSize);
+
+  // Start every worker of every stage and wait for the last page to be written
+  const int numWorkers = config.readWorkers + config.gridWorkers + 1
+      + config.writeWorkers;
+  std::cout << "Running " << pageSources.size() << " pages through the pipeline with "
+      << config.readWorkers << " reading, " << config.gridWorkers
+      << " Tesseract, 1 analysis, and " << config.writeWorkers
+      << " writing worker(s).\n";
+  if(config.gridWorkers > 1) {
+    std::cout << "Warning: Tesseract hasn't been checked for thread safety with "
+        << "more than one Tesseract worker.\n";
+  }
+  dlib::thread_pool threadPool(numWorkers);
+  for(int i = 0; i < config.readWorkers; ++i) {
+    threadPool.add_task(*this, &PagePipeline::readWorker);
+  }
+  for(int i = 0; i < config.gridWorkers; ++i) {
+    threadPool.add_task(*this, &PagePipeline::gridWorker);
+  }
+  threadPool.add_task(*this, &PagePipeline::analysisWorker);
+  for(int i = 0; i < config.writeWorkers; ++i) {
+    threadPool.add_task(*this, &PagePipeline::writeWorker);
+  }
+  threadPool.wait_for_all_tasks();
+
+  delete readQueue;
+  delete gridQueue;
+  delete writeQueue;
+  readQueue = gridQueue = writeQueue = NULL;
+
+  // Failed pages don't have results (their images were already destroyed)
+  std::vector<MathExpressionFinderResults*> finishedResults;
+  failedPages.clear();
+  for(int i = 0; i < results.size(); ++i) {
+    if(results[i] == NULL) {
+      failedPages.push_back(i);
+      continue;
+    }
+    finishedResults.push_back(results[i]);
+    if(keepImages) {
+      pixaAddPix(keptImages, images[i], L_INSERT);
+    }
+  }
+  if(!failedPages.empty()) {
+    std::cout << failedPages.size() << " of " << results.size()
+        << " pages failed in the pipeline and were left out of the results.\n";
+  }
+  results.clear();
+  images.clear();
+  return finishedResults;
+}
+
+std::vector<int>& PagePipeline::getFailedPages() {
+  return failedPages;
+}
+
+void PagePipeline::readWorker() {
+  while(true) {
+    stateMutex.lock();
+    const int index = nextImage++;
+    stateMutex.unlock();
+    if(index >= pageSources->size()) {
+      break;
+    }
+    Page* page = new Page();
+    page->index = index;
+    page->image = NULL;
+    page->gridImage = NULL;
+    page->scale = 1;
+    page->seconds = 0;
+    page->api = NULL;
+    page->blobDataGrid = NULL;
+    page->results = NULL;
+    page->failed = false;
+    try {
+      page->image = (*pageSources)[index].readBinarized();
+    } catch(std::exception& e) {
+      failPage(page, "reading in", e.what());
+    } catch(...) {
+      failPage(page, "reading in", "unknown exception");
+    }
+#ifdef DBG_PAGE_PIPELINE
+    std::cout << "Read in " << (*imageNames)[index] << ".\n";
+#endif
+    readQueue->enqueue(page);
+  }
+  finishStage(&readWorkersLeft, readQueue, config.gridWorkers);
+}
+
+void PagePipeline::gridWorker() {
+  Page* page = NULL;
+  while(readQueue->dequeue(page) && page != NULL) {
+    if(page->failed) {
+      gridQueue->enqueue(page);
+      continue;
+    }
+    try {
+      buildGrid(page);
+    } catch(std::exception& e) {
+      failPage(page, "building the grid for", e.what());
+    } catch(...) {
+      failPage(page, "building the grid for", "unknown exception");
+    }
+    gridQueue->enqueue(page);
+  }
+  finishStage(&gridWorkersLeft, gridQueue, 1);
+}
+
+void PagePipeline::analysisWorker() {
+  Page* page = NULL;
+  while(gridQueue->dequeue(page) && page != NULL) {
+    if(page->failed) {
+      writeQueue->enqueue(page);
+      continue;
+    }
+    try {
+      analyzePage(page);
+    } catch(std::exception& e) {
+      failPage(page, "analyzing", e.what());
+    } catch(...) {
+      failPage(page, "analyzing", "unknown exception");
+    }
+    writeQueue->enqueue(page);
+  }
+  finishStage(&analysisWorkersLeft, writeQueue, config.writeWorkers);
+}
+
+void PagePipeline::buildGrid(Page* const page) {
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  const int targetDpi = finder->getTargetResolution();
+  if(targetDpi > 0) {
+    // each page has its own entry, set up before the pipeline started
+    PageResolution& pageResolution = finder->getResolutionStats()[page->index];
+    pageResolution.pageName = (*imageNames)[page->index];
+    page->gridImage = ResolutionNormalizer(targetDpi).normalize(page->image,
+        &pageResolution);
+    page->scale = pageResolution.scale;
+  } else {
+    page->gridImage = pixClone(page->image);
+  }
+  std::cout << "Creating blob grid for " << (*imageNames)[page->index] << ".\n";
+  page->api = new tesseract::TessBaseAPI();
+  MathExpressionFeatureExtractor* const featureExtractor =
+      finder->getFeatureExtractor();
+  page->blobDataGrid = featureExtractor->getFinderInfo()->getGridFactory()
+      .createBlobDataGrid(page->gridImage, page->api,
+          Utils::getNameFromPath((*imageNames)[page->index]), NULL,
+          featureExtractor->getGridOcrLevel());
+  page->seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+void PagePipeline::analyzePage(Page* const page) {
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  std::cout << "Analyzing " << (*imageNames)[page->index] << ".\n";
+  page->results = finder->analyzeGrid(runMode, page->blobDataGrid);
+  delete page->blobDataGrid;
+  page->blobDataGrid = NULL;
+  delete page->api;
+  page->api = NULL;
+  pixDestroy(&page->gridImage);
+  if(page->scale != 1) {
+    page->results->mapToOriginalImage(page->image, page->scale);
+  }
+  page->seconds += std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  if(finder->getTargetResolution() > 0) {
+    finder->getResolutionStats()[page->index].seconds = page->seconds;
+  }
+}
+
+void PagePipeline::writeWorker() {
+  Page* page = NULL;
+  while(writeQueue->dequeue(page) && page != NULL) {
+    if(!page->failed && resultsDirName != "") {
+      try {
+        MathExpressionFinderResults::printResultImagesToFiles(page->results,
+            resultsDirName);
+        if(config.releaseWrittenImages) {
+          page->results->releaseVisualResults();
+        }
+      } catch(std::exception& e) {
+        failPage(page, "writing out", e.what());
+      } catch(...) {
+        failPage(page, "writing out", "unknown exception");
+      }
+    }
+#ifdef DBG_PAGE_PIPELINE
+    std::cout << "Finished " << (*imageNames)[page->index] << ".\n";
+#endif
+    results[page->index] = page->results;
+    if(keepImages && !page->failed) {
+      images[page->index] = page->image;
+    } else {
+      pixDestroy(&page->image);
+    }
+    delete page;
+  }
+}
+
+void PagePipeline::failPage(Page* const page, const std::string& stage,
+    const std::string& what) {
+  std::cout << "ERROR: Exception caught while " << stage << " "
+      << (*imageNames)[page->index] << " (" << what << "). The page is "
+      << "left out of the results.\n";
+  page->failed = true;
+  delete page->results;
+  page->results = NULL;
+  delete page->blobDataGrid;
+  page->blobDataGrid = NULL;
+  delete page->api;
+  page->api = NULL;
+  pixDestroy(&page->gridImage);
+}
+
+void PagePipeline::finishStage(int* const workersLeft,
+    PageQueue* const nextQueue, const int nextWorkers) {
+  stateMutex.lock();
+  const bool lastWorker = (--(*workersLeft) == 0);
+  stateMutex.unlock();
+  if(lastWorker) {
+    for(int i = 0; i < nextWorkers; ++i) {
+      Page* done = NULL;
+      nextQueue->enqueue(done);
+    }
+  }
+}
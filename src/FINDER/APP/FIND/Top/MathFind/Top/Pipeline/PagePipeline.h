@@ -0,0 +1,160 @@
+/*
+ * PagePipeline.h
+ */
+
+#ifndef PAGEPIPELINE_H_
+#define PAGEPIPELINE_H_
+
+#include <MFinderResults.h>
+#include <PageSource.h>
+
+#include <allheaders.h>
+#include <baseapi.h>
+
+#include <dlib/pipe.h>
+#include <dlib/threads.h>
+
+#include <string>
+#include <vector>
+
+class MathExpressionFinder;
+class BlobDataGrid;
+
+/**
+ * The number of workers for each stage of a PagePipeline along with how
+ * many pages can wait between two stages
+ */
+struct PagePipelineConfig {
+  PagePipelineConfig();
+  int readWorkers; // read in and binarize the images
+  int gridWorkers; // run Tesseract and build the grids (one Tesseract api each)
+  int writeWorkers; // write out the result images
+  int queueSize; // pages held between two stages (bounds the memory used)
+  // destroy each page's result images once they've been written so that a
+  // long run's are never all in memory (they can't be displayed afterwards)
+  bool releaseWrittenImages;
+};
+
+/**
+ * Runs the pages of a finder run through a pipeline so that different pages
+ * can be in different stages at the same time. The stages, which are
+ * connected by bounded queues, are:
+ *  1. reading in and binarizing the image
+ *  2. bringing the page down to the finder's target resolution (if it has
+ *     one) then running Tesseract and building the blob grid
+ *  3. feature extraction, detection, and segmentation
+ *  4. writing out the result images
+ * Each stage has its own workers, so while one page is in Tesseract
+ * another can have its features extracted and another its images written.
+ * The third stage always has a single worker since the feature extractors
+ * keep data for the page being analyzed which the segmentor also uses, so
+ * only one page can be analyzed at a time. The throughput approaches that of
+ * the slowest stage, which is usually Tesseract, so that's where extra
+ * workers help the most.
+ *
+ * Each Tesseract worker has a TessBaseAPI of its own, but the vendored
+ * Tesseract hasn't been checked for thread safety with more than one API
+ * running at once (it keeps some state, like its parameters, in globals).
+ * One Tesseract worker is the only configuration known to be safe.
+ *
+ * A page that throws an exception in any stage is marked as failed and
+ * passed on through the rest of the stages without being worked on, so the
+ * other pages still finish. Failed pages are left out of the results.
+ */
+class PagePipeline {
+
+ public:
+
+  /**
+   * The finder isn't owned by the pipeline and has to already be initialized
+   */
+  PagePipeline(MathExpressionFinder* const finder, const RunMode runMode,
+      const PagePipelineConfig& config);
+
+  /**
+   * Runs all of the given pages through the pipeline and returns their
+   * results in the same order, leaving out any pages that failed (see
+   * getFailedPages). Each page is only read in once a reading
+   * worker gets to it. If a results directory is given
+   * then each page's result images are written to it as soon as the page is
+   * done (the results file itself is left to the caller). If kept images are
+   * given then the binarized images are added to it in the same order as the
+   * results, otherwise they're destroyed once their page is done.
+   */
+  std::vector<MathExpressionFinderResults*> run(
+      const std::vector<PageSource>& pageSources,
+      const std::vector<std::string>& imageNames,
+      const std::string& resultsDirName,
+      Pixa* const keptImages=NULL);
+
+  /**
+   * Gets the indexes (into the page sources) of the pages that failed on
+   * the last run, in order
+   */
+  std::vector<int>& getFailedPages();
+
+ private:
+
+  // A page on its way through the pipeline
+  struct Page {
+    int index;
+    Pix* image;
+    Pix* gridImage; // the image the grid is built on (reduced if it was normalized)
+    double scale; // gridImage's size over image's size
+    double seconds; // time spent building the grid and analyzing it
+    tesseract::TessBaseAPI* api; // the grid uses it, so it lives as long as the grid
+    BlobDataGrid* blobDataGrid;
+    MathExpressionFinderResults* results;
+    bool failed; // threw an exception in one of the stages
+  };
+
+  typedef dlib::pipe<Page*> PageQueue;
+
+  // The workers for each stage. Each one takes pages off of the queue before
+  // it until it gets a NULL page (there's one for each of the stage's
+  // workers), and puts them on the queue after it.
+  void readWorker();
+  void gridWorker();
+  void analysisWorker();
+  void writeWorker();
+
+  // The work done on each page by the Tesseract and analysis stages
+  void buildGrid(Page* const page);
+  void analyzePage(Page* const page);
+
+  // Called by a worker once it's done. The last worker of a stage lets the
+  // next stage know that there are no more pages coming.
+  void finishStage(int* const workersLeft, PageQueue* const nextQueue,
+      const int nextWorkers);
+
+  // Marks the page as failed in the given stage and gets rid of anything
+  // the stages built for it other than its image
+  void failPage(Page* const page, const std::string& stage,
+      const std::string& what);
+
+  MathExpressionFinder* finder;
+  RunMode runMode;
+  PagePipelineConfig config;
+
+  const std::vector<PageSource>* pageSources;
+  const std::vector<std::string>* imageNames;
+  std::string resultsDirName;
+  bool keepImages;
+
+  std::vector<MathExpressionFinderResults*> results;
+  std::vector<Pix*> images;
+  std::vector<int> failedPages;
+
+  PageQueue* readQueue; // read -> grid
+  PageQueue* gridQueue; // grid -> analysis
+  PageQueue* writeQueue; // analysis -> write
+
+  dlib::mutex stateMutex;
+  int nextImage; // next image to be read in
+  int readWorkersLeft;
+  int gridWorkersLeft;
+  int analysisWorkersLeft;
+};
+
+
+#endif /* PAGEPIPELINE_H_ */
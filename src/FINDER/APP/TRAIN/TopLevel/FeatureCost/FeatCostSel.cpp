@@ -0,0 +1,377 @@
+/*
+ * FeatCostSel.cpp
+ */
+
+#include <FeatCostSel.h>
+
+#include <TrainingSampleExtractor.h>
+#include <BlobFeatExt.h>
+#include <BlobFeatExtDesc.h>
+#include <BlobDataGrid.h>
+#include <BlobDataGridFactory.h>
+#include <BlobData.h>
+#include <DoubleFeature.h>
+#include <Sample.h>
+#include <Utils.h>
+
+#include <baseapi.h>
+#include <allheaders.h>
+
+#include <dlib/svm_threaded.h>
+#include <dlib/rand.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <assert.h>
+
+// the most blobs used for cross validation, picked at random from all of the
+// blobs on the sample pages (keeps the selection from taking forever when there
+// are a lot of pages)
+#define FEATURE_COST_MAX_SAMPLES 4000
+
+// the SVM's C parameter used for every subset. gamma is set from the number of
+// features in the subset (1 / number of features) since they're normalized.
+#define FEATURE_COST_SVM_C 10.
+
+// units faster than this are treated as taking this long so that nearly free
+// units don't blow up the accuracy gained per second
+#define FEATURE_COST_MIN_SECONDS 0.001
+
+// the balanced accuracy of guessing (or of an SVM without any features), which
+// a subset has to beat to be worth its extraction time
+#define FEATURE_COST_BASELINE_ACCURACY 0.5
+
+FeatureCostUnit::FeatureCostUnit() : factory(NULL), flag(NULL),
+    initSeconds(0), secondsPerPage(0), featureCount(0) {}
+
+std::string FeatureCostUnit::getName() {
+  std::string name = factory->getDescription()->getName();
+  if(flag != NULL) {
+    name += " (" + flag->getName() + ")";
+  }
+  return name;
+}
+
+double FeatureSubsetPoint::getAccuracy() const {
+  return (positiveAccuracy + negativeAccuracy) / 2.;
+}
+
+CostAwareFeatureSelector::CostAwareFeatureSelector(FinderInfo* const finderInfo,
+    const std::vector<BlobFeatureExtractorFactory*>& factories) {
+  this->finderInfo = finderInfo;
+  this->factories = factories;
+  for(int i = 0; i < factories.size(); ++i) {
+    originalFlags.push_back(factories[i]->getSelectedFlags());
+    const std::vector<FeatureExtractorFlagDescription*> flags =
+        factories[i]->getDescription()->getFlagDescriptions();
+    if(flags.empty()) {
+      FeatureCostUnit unit;
+      unit.factory = factories[i];
+      units.push_back(unit);
+    }
+    for(int j = 0; j < flags.size(); ++j) {
+      FeatureCostUnit unit;
+      unit.factory = factories[i];
+      unit.flag = flags[j];
+      units.push_back(unit);
+    }
+  }
+}
+
+void CostAwareFeatureSelector::measureUnits(const int pageCount) {
+  const int pages = std::min(pageCount,
+      (int)finderInfo->getGroundtruthImagePaths().size());
+  assert(pages > 0);
+  unitFeatures.assign(units.size(), std::vector<std::vector<double> >());
+  labels.clear();
+
+  std::vector<BlobFeatureExtractorFactory*> initializedFactories;
+  for(int i = 0; i < units.size(); ++i) {
+    std::cout << "Measuring " << units[i].getName() << " (" << (i + 1)
+        << " of " << units.size() << ") on " << pages << " pages.\n";
+    selectUnitFlags(i);
+    BlobFeatureExtractor* const extractor = units[i].factory->create(finderInfo);
+
+    // The trainer initialization can generate resources from the whole
+    // groundtruth set (i.e., the n-gram profile) so it's only done the first
+    // time an extractor is used, after that the resources are just loaded.
+    const std::chrono::steady_clock::time_point initStart =
+        std::chrono::steady_clock::now();
+    if(std::find(initializedFactories.begin(), initializedFactories.end(),
+        units[i].factory) == initializedFactories.end()) {
+      extractor->doTrainerInitialization();
+      initializedFactories.push_back(units[i].factory);
+    } else {
+      extractor->doFinderInitialization();
+    }
+    units[i].initSeconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - initStart).count();
+
+    double totalSeconds = 0;
+    for(int page = 0; page < pages; ++page) {
+      totalSeconds += measureUnitOnPage(extractor, i, page, i == 0);
+    }
+    units[i].secondsPerPage = totalSeconds / (double)pages;
+    delete extractor;
+
+    if(unitFeatures[i].size() != labels.size()) {
+      std::cout << "ERROR: " << units[i].getName() << " was run on "
+          << unitFeatures[i].size() << " blobs but the pages had " << labels.size()
+          << " blobs when they were labeled. The grids must be built the same "
+          << "way every time.\n";
+      assert(false);
+    }
+  }
+  for(int i = 0; i < factories.size(); ++i) {
+    factories[i]->getSelectedFlags() = originalFlags[i];
+  }
+
+  // Shuffle the blobs so that the ones used for cross validation come from
+  // all of the pages (the seed is fixed so the results can be reproduced)
+  cvSampleIndexes.clear();
+  for(int i = 0; i < labels.size(); ++i) {
+    cvSampleIndexes.push_back(i);
+  }
+  dlib::rand rnd;
+  for(int i = cvSampleIndexes.size() - 1; i > 0; --i) {
+    std::swap(cvSampleIndexes[i], cvSampleIndexes[rnd.get_random_32bit_number() % (i + 1)]);
+  }
+  if(cvSampleIndexes.size() > FEATURE_COST_MAX_SAMPLES) {
+    cvSampleIndexes.resize(FEATURE_COST_MAX_SAMPLES);
+  }
+}
+
+double CostAwareFeatureSelector::measureUnitOnPage(
+    BlobFeatureExtractor* const extractor, const int unitIndex,
+    const int pageIndex, const bool getLabels) {
+  tesseract::TessBaseAPI api;
+  const std::string imagePath = finderInfo->getGroundtruthImagePaths()[pageIndex];
+  Pix* image = Utils::leptReadImg(imagePath);
+  BlobDataGrid* blobDataGrid = finderInfo->getGridFactory().createBlobDataGrid(
+      image, &api, Utils::getNameFromPath(imagePath));
+
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  extractor->doPreprocessing(blobDataGrid);
+  BlobDataGridSearch bdgs(blobDataGrid);
+  bdgs.StartFullSearch();
+  BlobData* blob = NULL;
+  while((blob = bdgs.NextFullSearch()) != NULL) {
+    blob->appendExtractedFeatures(extractor->extractFeatures(blob));
+  }
+  const double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+
+  // Copy out the features (and labels) now that the timing's done
+  TrainingSampleExtractor labeler(finderInfo, NULL);
+  bdgs.StartFullSearch();
+  while((blob = bdgs.NextFullSearch()) != NULL) {
+    const std::vector<DoubleFeature*>& features = blob->getExtractedFeatures();
+    std::vector<double> values;
+    for(int i = 0; i < features.size(); ++i) {
+      values.push_back(features[i]->getFeature());
+    }
+    units[unitIndex].featureCount = values.size();
+    unitFeatures[unitIndex].push_back(values);
+    if(getLabels) {
+      GroundTruthEntry* const entry =
+          labeler.getBlobGTEntry(blob, pageIndex, blobDataGrid->getImage());
+      labels.push_back((entry != NULL) ? +1 : -1);
+      delete entry;
+    }
+  }
+
+  delete blobDataGrid;
+  pixDestroy(&image);
+  return seconds;
+}
+
+void CostAwareFeatureSelector::findParetoFront(const int folds) {
+  assert(!cvSampleIndexes.empty()); // must call measureUnits first
+  int positiveCount = 0;
+  for(int i = 0; i < cvSampleIndexes.size(); ++i) {
+    if(labels[cvSampleIndexes[i]] > 0) {
+      ++positiveCount;
+    }
+  }
+  if(positiveCount < folds || cvSampleIndexes.size() - positiveCount < folds) {
+    std::cout << "ERROR: The sample pages need at least " << folds << " math and "
+        << folds << " non-math blobs for cross validation. Try using more pages.\n";
+    assert(false);
+  }
+  evaluatedPoints.clear();
+
+  // Greedily add whichever unit gives the most accuracy per second of
+  // extraction time until none of the ones left improve the accuracy
+  std::vector<int> selected;
+  std::vector<bool> used(units.size(), false);
+  double currentAccuracy = FEATURE_COST_BASELINE_ACCURACY;
+  while(selected.size() < units.size()) {
+    int bestUnit = -1;
+    double bestScore = 0;
+    double bestAccuracy = 0;
+    for(int i = 0; i < units.size(); ++i) {
+      if(used[i]) {
+        continue;
+      }
+      std::vector<int> candidate = selected;
+      candidate.push_back(i);
+      const FeatureSubsetPoint point = evaluateSubset(candidate, folds);
+      evaluatedPoints.push_back(point);
+      const double gain = point.getAccuracy() - currentAccuracy;
+      const double score = gain /
+          std::max(units[i].secondsPerPage, FEATURE_COST_MIN_SECONDS);
+      if(gain > 0 && (bestUnit == -1 || score > bestScore)) {
+        bestUnit = i;
+        bestScore = score;
+        bestAccuracy = point.getAccuracy();
+      }
+    }
+    if(bestUnit == -1) {
+      break;
+    }
+    selected.push_back(bestUnit);
+    used[bestUnit] = true;
+    currentAccuracy = bestAccuracy;
+    std::cout << "Added " << units[bestUnit].getName() << ", accuracy is now "
+        << currentAccuracy << ".\n";
+  }
+
+  // Keep each subset that's more accurate than every faster one (and than
+  // the baseline, so the front is empty if none of the features help)
+  std::vector<FeatureSubsetPoint> sortedPoints = evaluatedPoints;
+  std::sort(sortedPoints.begin(), sortedPoints.end(),
+      [](const FeatureSubsetPoint& a, const FeatureSubsetPoint& b) {
+        if(a.secondsPerPage != b.secondsPerPage) {
+          return a.secondsPerPage < b.secondsPerPage;
+        }
+        return a.getAccuracy() > b.getAccuracy();
+      });
+  paretoFront.clear();
+  for(int i = 0; i < sortedPoints.size(); ++i) {
+    const double accuracyToBeat = paretoFront.empty() ?
+        FEATURE_COST_BASELINE_ACCURACY : paretoFront.back().getAccuracy();
+    if(sortedPoints[i].getAccuracy() > accuracyToBeat) {
+      paretoFront.push_back(sortedPoints[i]);
+    }
+  }
+}
+
+FeatureSubsetPoint CostAwareFeatureSelector::evaluateSubset(
+    const std::vector<int>& subsetUnits, const int folds) {
+  FeatureSubsetPoint point;
+  point.units = subsetUnits;
+  point.secondsPerPage = 0;
+  int featureCount = 0;
+  for(int i = 0; i < subsetUnits.size(); ++i) {
+    point.secondsPerPage += units[subsetUnits[i]].secondsPerPage;
+    featureCount += units[subsetUnits[i]].featureCount;
+  }
+  if(featureCount == 0) {
+    // nothing to train on (and no gamma to pick), so the subset can only
+    // call every blob non-math
+    point.positiveAccuracy = 0;
+    point.negativeAccuracy = 1;
+    return point;
+  }
+
+  std::vector<cost_sample_type> samples;
+  std::vector<double> sampleLabels;
+  for(int i = 0; i < cvSampleIndexes.size(); ++i) {
+    const int blobIndex = cvSampleIndexes[i];
+    cost_sample_type sample;
+    sample.set_size(featureCount, 1);
+    int k = 0;
+    for(int j = 0; j < subsetUnits.size(); ++j) {
+      const std::vector<double>& values = unitFeatures[subsetUnits[j]][blobIndex];
+      for(int l = 0; l < values.size(); ++l) {
+        sample(k++) = values[l];
+      }
+    }
+    samples.push_back(sample);
+    sampleLabels.push_back(labels[blobIndex]);
+  }
+  dlib::vector_normalizer<cost_sample_type> normalizer;
+  normalizer.train(samples);
+  for(int i = 0; i < samples.size(); ++i) {
+    samples[i] = normalizer(samples[i]);
+  }
+
+  typedef dlib::radial_basis_kernel<cost_sample_type> kernel_type;
+  dlib::svm_c_trainer<kernel_type> trainer;
+  trainer.set_kernel(kernel_type(1. / (double)featureCount));
+  trainer.set_c(FEATURE_COST_SVM_C);
+  const dlib::matrix<double> result = dlib::cross_validate_trainer_threaded(
+      trainer, samples, sampleLabels, folds, folds);
+  point.positiveAccuracy = result(0, 0);
+  point.negativeAccuracy = result(0, 1);
+  return point;
+}
+
+void CostAwareFeatureSelector::selectUnitFlags(const int unitIndex) {
+  std::vector<FeatureExtractorFlagDescription*>& flags =
+      units[unitIndex].factory->getSelectedFlags();
+  flags.clear();
+  if(units[unitIndex].flag != NULL) {
+    flags.push_back(units[unitIndex].flag);
+  }
+}
+
+void CostAwareFeatureSelector::printReport(std::ostream& stream) {
+  stream << "Extraction time for each feature (init is a one time cost):\n";
+  for(int i = 0; i < units.size(); ++i) {
+    stream << "  " << std::setw(50) << std::left << units[i].getName()
+        << std::right << " features: " << units[i].featureCount
+        << "  init: " << std::setw(9) << units[i].initSeconds << " s"
+        << "  per page: " << std::setw(9) << units[i].secondsPerPage * 1000.
+        << " ms\n";
+  }
+  stream << "Pareto front of accuracy versus extraction time (fastest first). "
+      << "Times are the sums of the features' times, so they're an upper bound "
+      << "for flags of the same extractor which share preprocessing.\n";
+  for(int i = 0; i < paretoFront.size(); ++i) {
+    const FeatureSubsetPoint& point = paretoFront[i];
+    stream << "[" << i << "] " << point.secondsPerPage * 1000. << " ms/page, "
+        << "accuracy: " << point.getAccuracy() << " (positive: "
+        << point.positiveAccuracy << ", negative: " << point.negativeAccuracy
+        << ")\n";
+    for(int j = 0; j < point.units.size(); ++j) {
+      stream << "      " << units[point.units[j]].getName() << std::endl;
+    }
+  }
+}
+
+std::vector<FeatureSubsetPoint>& CostAwareFeatureSelector::getParetoFront() {
+  return paretoFront;
+}
+
+int CostAwareFeatureSelector::getFastestMeetingAccuracy(const double minAccuracy) {
+  for(int i = 0; i < paretoFront.size(); ++i) {
+    if(paretoFront[i].getAccuracy() >= minAccuracy) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+std::vector<BlobFeatureExtractorFactory*> CostAwareFeatureSelector
+::applyFrontPoint(const int frontIndex) {
+  assert(frontIndex >= 0 && frontIndex < paretoFront.size());
+  const FeatureSubsetPoint& point = paretoFront[frontIndex];
+  std::vector<BlobFeatureExtractorFactory*> selection;
+  for(int i = 0; i < point.units.size(); ++i) {
+    FeatureCostUnit& unit = units[point.units[i]];
+    if(std::find(selection.begin(), selection.end(), unit.factory) == selection.end()) {
+      unit.factory->getSelectedFlags().clear();
+      selection.push_back(unit.factory);
+    }
+    if(unit.flag != NULL) {
+      unit.factory->getSelectedFlags().push_back(unit.flag);
+    }
+  }
+  return selection;
+}
@@ -0,0 +1,137 @@
+/*
+ * FeatCostSel.h
+ */
+
+#ifndef FEATCOSTSEL_H_
+#define FEATCOSTSEL_H_
+
+#include <FinderInfo.h>
+#include <BlobFeatExtFac.h>
+#include <FeatExtFlagDesc.h>
+
+#include <dlib/matrix.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+class BlobFeatureExtractor;
+
+/**
+ * A single selectable feature: one flag of a blob feature extractor, or the
+ * whole extractor if it doesn't have any flags.
+ */
+struct FeatureCostUnit {
+
+  FeatureCostUnit();
+
+  std::string getName();
+
+  BlobFeatureExtractorFactory* factory;
+  FeatureExtractorFlagDescription* flag; // NULL if the extractor has no flags
+  double initSeconds; // one time initialization (i.e., loading or generating profiles)
+  double secondsPerPage; // average preprocessing plus extraction time per page
+  int featureCount; // number of features extracted per blob
+};
+
+/**
+ * A subset of the units along with the per-page extraction time and
+ * cross validated accuracy measured for it.
+ */
+struct FeatureSubsetPoint {
+  std::vector<int> units; // indexes into the selector's units
+  double secondsPerPage; // sum of the unit times
+  double positiveAccuracy; // cross validated accuracy on the math blobs
+  double negativeAccuracy; // cross validated accuracy on the non-math blobs
+  double getAccuracy() const; // the mean of the two (balanced accuracy)
+};
+
+/**
+ * Picks out feature subsets that trade detection accuracy against how long
+ * it takes to extract the features. Each unit's extraction time is measured
+ * on its own on a sample of the groundtruth pages, and the units are then
+ * added greedily by how much cross validated accuracy they buy per second of
+ * extraction time. Every subset evaluated along the way is a candidate, and
+ * the ones not beaten by a faster subset make up the Pareto front.
+ */
+class CostAwareFeatureSelector {
+
+ public:
+
+  /**
+   * The units are made from the given factories with all of their flags.
+   * Neither the finder info nor the factories are owned by this class. The
+   * factories' selected flags are changed while measuring but are put back
+   * once done.
+   */
+  CostAwareFeatureSelector(FinderInfo* const finderInfo,
+      const std::vector<BlobFeatureExtractorFactory*>& factories);
+
+  /**
+   * Times every unit on the first pageCount groundtruth pages (the grids are
+   * rebuilt for each unit so that no unit benefits from another's
+   * preprocessing) and keeps the features they extract along with each
+   * blob's label for the cross validation.
+   */
+  void measureUnits(const int pageCount);
+
+  /**
+   * Runs the greedy forward selection over the measured units and finds the
+   * Pareto front of accuracy versus extraction time. Only subsets that are
+   * more accurate than guessing are put on the front, so it's empty if none
+   * of the features help. Must be called after measureUnits.
+   */
+  void findParetoFront(const int folds);
+
+  /**
+   * Prints each unit's cost and the Pareto front (fastest first)
+   */
+  void printReport(std::ostream& stream);
+
+  std::vector<FeatureSubsetPoint>& getParetoFront();
+
+  /**
+   * Gets the index of the fastest point on the Pareto front with at least
+   * the given accuracy, or -1 if none of them get there.
+   */
+  int getFastestMeetingAccuracy(const double minAccuracy);
+
+  /**
+   * Sets the selected flags of the factories to the ones at the given point
+   * on the front and returns the factories needed for it. The result can be
+   * passed straight to the trainer.
+   */
+  std::vector<BlobFeatureExtractorFactory*> applyFrontPoint(const int frontIndex);
+
+ private:
+
+  typedef dlib::matrix<double, 0, 1> cost_sample_type;
+
+  // Runs the given unit's extractor on the given page and appends its features
+  // to the unit's samples (also gets the blobs' labels if getLabels is set).
+  // Returns the time spent in preprocessing and extraction.
+  double measureUnitOnPage(BlobFeatureExtractor* const extractor,
+      const int unitIndex, const int pageIndex, const bool getLabels);
+
+  // Cross validates an RBF SVM on the given units' features
+  FeatureSubsetPoint evaluateSubset(const std::vector<int>& units,
+      const int folds);
+
+  // Turns the factories' selected flags into the given unit's flag only
+  void selectUnitFlags(const int unitIndex);
+
+  FinderInfo* finderInfo;
+  std::vector<BlobFeatureExtractorFactory*> factories;
+  std::vector<std::vector<FeatureExtractorFlagDescription*> > originalFlags;
+
+  std::vector<FeatureCostUnit> units;
+  std::vector<std::vector<std::vector<double> > > unitFeatures; // [unit][blob][feature]
+  std::vector<double> labels; // +1 for math blobs, -1 otherwise
+  std::vector<int> cvSampleIndexes; // the (shuffled, capped) blobs used for cross validation
+
+  std::vector<FeatureSubsetPoint> evaluatedPoints;
+  std::vector<FeatureSubsetPoint> paretoFront;
+};
+
+
+#endif /* FEATCOSTSEL_H_ */
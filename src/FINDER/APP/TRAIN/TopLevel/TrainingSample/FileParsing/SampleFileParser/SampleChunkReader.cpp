@@ -0,0 +1,111 @@
+/*
+ * SampleChunkReader.cpp
+ */
+
+#include <SampleChunkReader.h>
+
+#include <SampleFileParser.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <assert.h>
+#include <stdlib.h>
+
+SampleChunkReader::SampleChunkReader(const std::string& samplePath,
+    const int chunkSize) : samplePath(samplePath),
+        file(samplePath.c_str()), chunkSize(chunkSize), samplesRead(0) {
+  if(!file.is_open()) {
+    std::cout << "ERROR: Couldn't open sample file for reading at " << samplePath << std::endl;
+    assert(false);
+  }
+  assert(chunkSize > 0);
+}
+
+bool SampleChunkReader::nextChunk(std::vector<LabeledFeatures>* const chunk) {
+  // the chunk's entries are reused from one call to the next so that their
+  // vectors don't have to be reallocated for every sample
+  chunk->resize(chunkSize);
+  int count = 0;
+  std::string line;
+  while(count < chunkSize && std::getline(file, line)) {
+    if(line.empty()) {
+      continue; // readOldSamples allows for a trailing blank line or two
+    }
+    readLabeledFeatures(line, &(*chunk)[count++]);
+  }
+  chunk->resize(count);
+  samplesRead += count;
+  return count > 0;
+}
+
+void SampleChunkReader::rewind() {
+  file.clear();
+  file.seekg(0, std::ios::beg);
+  samplesRead = 0;
+}
+
+long SampleChunkReader::getSamplesRead() const {
+  return samplesRead;
+}
+
+// Only the first two space delimited fields (the label and the feature vector)
+// are looked at, and the features are parsed in place rather than being split
+// into strings first like readSample does.
+void SampleChunkReader::readLabeledFeatures(const std::string& line,
+    LabeledFeatures* const sample) {
+  const char* cur = line.c_str();
+  if(*cur != '0' && *cur != '1') {
+    SampleFileParser::error();
+  }
+  sample->label = (*cur == '1');
+  ++cur;
+  if(*cur != ' ') {
+    SampleFileParser::error();
+  }
+  ++cur;
+  sample->nonzeros.clear();
+  const char* const fvecstart = cur;
+  while(*cur != '\0' && *cur != ' ' && *cur != '|') {
+    ++cur;
+  }
+  char* end = NULL;
+  if(*cur == '|') {
+    // sparse: numfeat|index:value,index:value,...
+    sample->dimension = strtoul(fvecstart, &end, 10);
+    if(end != cur || sample->dimension == 0) {
+      SampleFileParser::error();
+    }
+    ++cur;
+    while(*cur != '\0' && *cur != ' ') {
+      const unsigned long index = strtoul(cur, &end, 10);
+      if(*end != ':' || index >= sample->dimension) {
+        SampleFileParser::error();
+      }
+      cur = end + 1;
+      const double value = strtod(cur, &end);
+      if(end == cur) {
+        SampleFileParser::error();
+      }
+      sample->nonzeros.push_back(std::make_pair(index, value));
+      cur = (*end == ',') ? end + 1 : end;
+    }
+  } else {
+    // dense: f1,f2,...
+    cur = fvecstart;
+    unsigned long index = 0;
+    while(*cur != '\0' && *cur != ' ') {
+      const double value = strtod(cur, &end);
+      if(end == cur) {
+        SampleFileParser::error();
+      }
+      if(value != 0) {
+        sample->nonzeros.push_back(std::make_pair(index, value));
+      }
+      ++index;
+      cur = (*end == ',') ? end + 1 : end;
+    }
+    sample->dimension = index;
+  }
+}
@@ -0,0 +1,67 @@
+/*
+ * SampleChunkReader.h
+ */
+
+#ifndef SAMPLECHUNKREADER_H_
+#define SAMPLECHUNKREADER_H_
+
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Just the label and features of a sample in the sample file. The features
+ * are kept as (index, value) pairs for the nonzero ones along with the total
+ * number of features, whichever way they were written to the file.
+ */
+struct LabeledFeatures {
+  bool label;
+  unsigned long dimension;
+  std::vector<std::pair<unsigned long, double> > nonzeros;
+};
+
+/**
+ * Reads the sample file (see SampleFileParser::writeSample for its format)
+ * a chunk of samples at a time, parsing only their labels and features. None
+ * of the BLSamples, DoubleFeatures, boxes or groundtruth entries which
+ * SampleFileParser::readOldSamples builds are created, so at most one chunk
+ * is held in memory no matter how big the file is. Meant for making passes
+ * over very large training sets, with rewind() starting the next pass.
+ */
+class SampleChunkReader {
+ public:
+
+  SampleChunkReader(const std::string& samplePath, const int chunkSize);
+
+  /**
+   * Replaces the contents of chunk with the next (up to) chunkSize samples.
+   * Returns false once there are none left.
+   */
+  bool nextChunk(std::vector<LabeledFeatures>* const chunk);
+
+  /**
+   * Goes back to the start of the file
+   */
+  void rewind();
+
+  /**
+   * Number of samples read since the start of the file
+   */
+  long getSamplesRead() const;
+
+  /**
+   * Parses the label and features from a line of the sample file
+   */
+  static void readLabeledFeatures(const std::string& line,
+      LabeledFeatures* const sample);
+
+ private:
+  std::string samplePath;
+  std::ifstream file;
+  int chunkSize;
+  long samplesRead;
+};
+
+
+#endif /* SAMPLECHUNKREADER_H_ */
@@ -42,7 +42,10 @@ void SampleFileParser::writeSamples(const std::string& sample_path,
 // writes the sample in the following space-delimited format:
 // label featurevec imgindex blobbox groundtruth_entry
 // label: 0 or 1
-// featurevec: comma delimited list of doubles
+// featurevec: comma delimited list of doubles, or if fewer than half of them
+//             are nonzero, the number of features followed by a | and a comma
+//             delimited list of index:value pairs for just the nonzero ones
+//             (i.e., 0,0,3,0,0,0,1.5,0 is written as 8|2:3,6:1.5)
 // imgname: gives the name of the image in which the blob resides (0.png, 1.png, 2.jpg, etc.)
 // imgindex: gives the index of the image in which the blob resides (should be an integer matching the name)
 // blobbox: comma delimited coordinates as follows x,y,w,h
@@ -60,9 +63,27 @@ void SampleFileParser::writeSample(BLSample* const sample, std::ofstream& fs) {
   else
     fs << 0 << " ";
   int numfeat = (sample->features).size();
+  int numnonzero = 0;
   for(int i = 0; i < numfeat; ++i) {
-    fs << std::setprecision(20) << sample->features[i]->getFeature();
-    fs << (((i + 1) < numfeat) ? "," : " ");
+    if(sample->features[i]->getFeature() != 0)
+      ++numnonzero;
+  }
+  if(numnonzero * 2 < numfeat) {
+    fs << numfeat << "|";
+    int numwritten = 0;
+    for(int i = 0; i < numfeat; ++i) {
+      const double feature = sample->features[i]->getFeature();
+      if(feature == 0)
+        continue;
+      fs << i << ":" << std::setprecision(20) << feature;
+      fs << ((++numwritten < numnonzero) ? "," : "");
+    }
+    fs << " ";
+  } else {
+    for(int i = 0; i < numfeat; ++i) {
+      fs << std::setprecision(20) << sample->features[i]->getFeature();
+      fs << (((i + 1) < numfeat) ? "," : " ");
+    }
   }
   fs << sample->imageName << " ";
   fs << sample->imageIndex << " ";
@@ -123,7 +144,8 @@ std::vector<std::vector<BLSample*> > SampleFileParser::readOldSamples(const std:
 // reads the sample in the following space-delimited format:
 // label featurevec imgindex blobbox groundtruth_entry
 // label: 0 or 1
-// featurevec: comma delimited list of doubles
+// featurevec: comma delimited list of doubles (or the sparse form described
+//             in writeSample)
 // imageName: gives the name of the image for this blob
 // imgIndex: gives the image number for the blob
 // blobbox: comma delimited coordinates as follows x,y,w,h
@@ -145,7 +167,7 @@ BLSample* SampleFileParser::readSample(const std::string& line,
 
   // get the feature vec
   std::string fvecstring = spacesplit[1];
-  std::vector<std::string> featureStrVec = Utils::stringSplit(fvecstring, ',');
+  std::vector<std::string> featureStrVec = readFeatureStrings(fvecstring);
   std::vector<DoubleFeature*> featureVec;
   int index = 0;
   for(int i = 0; i < blobFeatureExtractors.size(); ++i) {
@@ -237,6 +259,32 @@ BLSample* SampleFileParser::readSample(const std::string& line,
 
 
 
+std::vector<std::string> SampleFileParser::readFeatureStrings(
+    const std::string& fvecstring) {
+  const size_t barindex = fvecstring.find('|');
+  if(barindex == std::string::npos) {
+    return Utils::stringSplit(fvecstring, ',');
+  }
+  const int numfeat = atoi(fvecstring.substr(0, barindex).c_str());
+  if(numfeat <= 0)
+    error();
+  std::vector<std::string> featureStrVec(numfeat, "0");
+  const std::string pairsstring = fvecstring.substr(barindex + 1);
+  if(pairsstring.empty())
+    return featureStrVec;
+  std::vector<std::string> pairs = Utils::stringSplit(pairsstring, ',');
+  for(int i = 0; i < pairs.size(); ++i) {
+    const size_t colonindex = pairs[i].find(':');
+    if(colonindex == std::string::npos)
+      error();
+    const int featindex = atoi(pairs[i].substr(0, colonindex).c_str());
+    if(featindex < 0 || featindex >= numfeat)
+      error();
+    featureStrVec[featindex] = pairs[i].substr(colonindex + 1);
+  }
+  return featureStrVec;
+}
+
 void SampleFileParser::error() {
   std::cout << "ERROR: Invalid sample file!\n";
   assert(false);
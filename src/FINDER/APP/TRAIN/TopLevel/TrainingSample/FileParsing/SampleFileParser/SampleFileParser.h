@@ -27,6 +27,8 @@ std::vector<std::vector<BLSample*> > readOldSamples(const std::string& sample_pa
   const std::vector<BlobFeatureExtractor*>& blobFeatureExtractors);
 BLSample* readSample(const std::string& line,
     const std::vector<BlobFeatureExtractor*>& blobFeatureExtractors);
+// Splits a sample's feature vector (dense or sparse) into one string per feature
+std::vector<std::string> readFeatureStrings(const std::string& fvecstring);
 
 // Other
 void error();
@@ -22,6 +22,8 @@
 
 #include <allheaders.h>
 
+#include <fstream>
+#include <string>
 #include <vector>
 #include <assert.h>
 #include <stddef.h>
@@ -59,19 +61,7 @@ std::vector<std::vector<BLSample*> > TrainingSampleExtractor::getSamples() {
   }
   // get the samples
   std::string sample_path = finderInfo->getFinderTrainingPaths()->getSampleFilePath();
-  bool generateNewSamples = true;
-  if(Utils::existsFile(sample_path)) {
-    // Prompt to see if ok to just read in old files
-    std::cout << "The training samples were already previously extracted for this Finder "
-        "and stored to a file. Would you like to re-use the previously extracted samples "
-        "for this training? ";
-#ifndef RUNNING_BACKGROUND
-    generateNewSamples = !Utils::promptYesNo();
-#endif
-#ifdef RUNNING_BACKGROUND
-    generateNewSamples = false;
-#endif
-  }
+  const bool generateNewSamples = !reuseSampleFile(sample_path);
 
   if(generateNewSamples) {
     getNewSamples();
@@ -85,9 +75,103 @@ std::vector<std::vector<BLSample*> > TrainingSampleExtractor::getSamples() {
 }
 
 
-// does feature extraction on all images in the groundtruth data set and writes
-// the resulting features to a file
-void TrainingSampleExtractor::getNewSamples(bool writeToFile) {
+// Same as getSamples except that none of the samples are kept in memory. If
+// new samples are extracted then each image's samples are appended to the
+// sample file as soon as they're extracted and then deleted.
+std::string TrainingSampleExtractor::prepareSampleFile() {
+  std::string sample_path = finderInfo->getFinderTrainingPaths()->getSampleFilePath();
+  if(!reuseSampleFile(sample_path)) {
+    getNewSamples(true, 0, false);
+  }
+  return sample_path;
+}
+
+// If there's a sample file from an earlier run, prompts to see if it should
+// be reused rather than extracting the samples over again
+bool TrainingSampleExtractor::reuseSampleFile(const std::string& sample_path) {
+  if(!Utils::existsFile(sample_path)) {
+    return false;
+  }
+  // Prompt to see if ok to just read in old files
+  std::cout << "The training samples were already previously extracted for this Finder "
+      "and stored to a file. Would you like to re-use the previously extracted samples "
+      "for this training? ";
+#ifndef RUNNING_BACKGROUND
+  return Utils::promptYesNo();
+#endif
+#ifdef RUNNING_BACKGROUND
+  return true;
+#endif
+}
+
+// Reads in the samples that were extracted on an earlier run and only runs
+// feature extraction on the groundtruth images that came after them. Since the
+// images are named 0, 1, 2, etc. and the sample file holds a contiguous run of
+// them starting from 0, the images added since are just the ones past the end
+// of the file. The combined samples are written back to the file so that the
+// next update only has to deal with the images added after this one.
+// Note:
+// The calling class is responsible for deallocating the samples created here
+std::vector<std::vector<BLSample*> > TrainingSampleExtractor::getSamplesWithNewPages(
+    int* const firstNewImage) {
+  if(!samples_extracted.empty() || !samples_read.empty()) {
+    std::cout << "ERROR: samples have already been extracted but not deleted "
+         << "prior to calling getSamplesWithNewPages(). Make sure samples are "
+         << "deleted prior to calling this function.\n";
+    assert(false);
+  }
+  std::string sample_path = finderInfo->getFinderTrainingPaths()->getSampleFilePath();
+  if(!Utils::existsFile(sample_path)) {
+    std::cout << "No previously extracted samples were found at " << sample_path
+        << " so samples will be extracted from every groundtruth image.\n";
+    *firstNewImage = 0;
+    getNewSamples();
+    return samples_extracted;
+  }
+  samples_read = SampleFileParser::readOldSamples(
+      sample_path,
+      featureExtractor->getBlobFeatureExtractors());
+  *firstNewImage = samples_read.size();
+  const int imageCount = finderInfo->getGroundtruthImagePaths().size();
+  if(*firstNewImage > imageCount) {
+    std::cout << "ERROR: The sample file at " << sample_path << " holds samples for "
+        << *firstNewImage << " images but the groundtruth only has " << imageCount
+        << ". Images can only be added to the groundtruth for an update.\n";
+    assert(false);
+  }
+  if(*firstNewImage == imageCount) {
+    std::cout << "No images were added to the groundtruth since the samples were "
+        << "last extracted.\n";
+    return samples_read;
+  }
+  std::cout << "Extracting samples from the " << (imageCount - *firstNewImage)
+      << " groundtruth images added since the samples were last extracted.\n";
+  getNewSamples(false, *firstNewImage);
+  samples_read.insert(samples_read.end(),
+      samples_extracted.begin(), samples_extracted.end());
+  samples_extracted.clear(); // now owned through samples_read
+  SampleFileParser::writeSamples(sample_path, samples_read);
+  return samples_read;
+}
+
+// does feature extraction on the images in the groundtruth data set starting
+// from firstImage and writes the resulting features to a file. If the samples
+// aren't kept then they're written out (replacing the file) one image at a time.
+void TrainingSampleExtractor::getNewSamples(bool writeToFile, const int firstImage,
+    const bool keepSamples) {
+  assert(keepSamples || (writeToFile && firstImage == 0));
+  std::ofstream sampleFile;
+  int samplecount = 0;
+  if(!keepSamples) {
+    const std::string sample_path = finderInfo->getFinderTrainingPaths()->getSampleFilePath();
+    std::cout << "Writing the samples to " << sample_path << " as they're extracted\n";
+    sampleFile.open(sample_path.c_str());
+    if(!sampleFile.is_open()) {
+      std::cout << "ERROR: Couldn't open " << sample_path << " for writing\n";
+      assert(false);
+    }
+  }
+
   // assumes all n files in the training dir are images and are named as 0, 1, 2, etc.
   // iterate the images in the dataset, getting the features
   // from each and appending them to the samples vector
@@ -102,13 +186,14 @@ void TrainingSampleExtractor::getNewSamples(bool writeToFile) {
   // Extract the features for each image in the groundtruth dataset
   std::cout << "Extracting the features for each image in the groundtruth dataset.\n";
   //Utils::waitForInput();
-  for(int i = 0; i < finderInfo->getGroundtruthImagePaths().size(); ++i) {
+  for(int i = firstImage; i < finderInfo->getGroundtruthImagePaths().size(); ++i) {
     tesseract::TessBaseAPI api; // the tesseract api that will be used for features which require it during feature extraction
 
     const std::string imagePath = finderInfo->getGroundtruthImagePaths()[i];
     Pix* image = Utils::leptReadImg(imagePath);
 
-    BlobDataGrid* blobDataGrid = BlobDataGridFactory().createBlobDataGrid(image, &api, Utils::getNameFromPath(imagePath));
+    BlobDataGrid* blobDataGrid = finderInfo->getGridFactory().createBlobDataGrid(image, &api,
+        Utils::getNameFromPath(imagePath), NULL, featureExtractor->getGridOcrLevel());
 #ifdef DBG_SHOW_GRID
     std::string winname = "BlobDataGrid for Image " +  Utils::getNameFromPath(imagePath);
     ScrollView* gridviewer = blobDataGrid->MakeWindow(100, 100, winname.c_str());
@@ -163,7 +248,15 @@ void TrainingSampleExtractor::getNewSamples(bool writeToFile) {
     // now append the samples found for the current image to the
     // the vector which holds all of them. For now I have this organized
     // as a vector for each image
-    samples_extracted.push_back(img_samples);
+    if(keepSamples) {
+      samples_extracted.push_back(img_samples);
+    } else {
+      for(int j = 0; j < img_samples.size(); ++j) {
+        SampleFileParser::writeSample(img_samples[j], sampleFile);
+        delete img_samples[j];
+      }
+      samplecount += img_samples.size();
+    }
     pixDestroy(&image); // destroy finished image
 
 #ifdef DBG_MEDS_TRAINER
@@ -173,7 +266,9 @@ void TrainingSampleExtractor::getNewSamples(bool writeToFile) {
     std::cout << "Finished acquiring " << img_samples.size()
          << " samples for image " << finderInfo->getGroundtruthImagePaths()[i] << std::endl;
   }
-  if(writeToFile) {
+  if(!keepSamples) {
+    std::cout << "Total of " << samplecount << " samples written.\n";
+  } else if(writeToFile) {
     SampleFileParser::writeSamples(
         finderInfo->getFinderTrainingPaths()->getSampleFilePath(),
         samples_extracted);
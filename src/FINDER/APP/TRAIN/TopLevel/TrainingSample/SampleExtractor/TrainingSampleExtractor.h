@@ -14,6 +14,7 @@
 #include <BlobData.h>
 #include <FeatExt.h>
 
+#include <string>
 #include <vector>
 
 class TrainingSampleExtractor {
@@ -25,17 +26,44 @@ class TrainingSampleExtractor {
 
   std::vector<std::vector<BLSample*> > getSamples();
 
-
+  /**
+   * Makes sure the samples are in the sample file without reading them into
+   * memory, either by reusing the file from an earlier run or by extracting
+   * them and writing each image's samples out as soon as it's done. Returns
+   * the path to the sample file.
+   */
+  std::string prepareSampleFile();
+
+  /**
+   * Reads in the previously extracted samples and only extracts samples
+   * from the groundtruth images which were added after those were written
+   * (i.e., the images whose index is past the last one in the sample file).
+   * The new samples are appended to the sample file. Returns the samples for
+   * all of the images and sets firstNewImage to the index of the first new
+   * one (equal to the number of images if there were no new ones). If there
+   * is no sample file yet then all of the samples are extracted and
+   * firstNewImage is set to 0.
+   */
+  std::vector<std::vector<BLSample*> > getSamplesWithNewPages(
+      int* const firstNewImage);
 
   static void destroySamples(std::vector<std::vector<BLSample*> >& samples);
 
+  /**
+   * Gets the groundtruth entry for the math region the given blob on the given
+   * groundtruth image falls in, or NULL if it isn't in one (i.e., it's not math).
+   * The returned entry is owned by the caller.
+   */
+  GroundTruthEntry* getBlobGTEntry(BlobData* const blob, const int image_index, Pix* const img);
+
  private:
 
-  void getNewSamples(bool writeToFile=true);
+  void getNewSamples(bool writeToFile=true, const int firstImage=0,
+      const bool keepSamples=true);
 
-  std::vector<BLSample*> getGridSamples(BlobDataGrid* const grid, int image_index);
+  bool reuseSampleFile(const std::string& sample_path);
 
-  GroundTruthEntry* getBlobGTEntry(BlobData* const blob, const int image_index, Pix* const img);
+  std::vector<BLSample*> getGridSamples(BlobDataGrid* const grid, int image_index);
 
   void sampleReadVerify();
 
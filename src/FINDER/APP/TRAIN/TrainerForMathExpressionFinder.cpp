@@ -24,6 +24,7 @@
 #include <stddef.h>
 #include <assert.h>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #define JUST_GET_SAMPLES
@@ -50,12 +51,23 @@ void TrainerForMathExpressionFinder::runTraining() {
 
 void TrainerForMathExpressionFinder::trainDetector() {
 
-  // if the predictor already exists, prompt to make sure user wants to retrain, if not return otherwise continue.
+  // if the predictor already exists, prompt to see if the user wants to update it with
+  // new pages or retrain it, if neither then return otherwise continue.
   bool doDetectorTraining = true;
   if(Utils::existsFile(detector->getDetectorPath())) {
     std::cout << "A trained detector at " << detector->getDetectorPath()
             << " already exists for the Finder that was selected for training. "
-            << "Would you like to retrain that detector now? If you answer no, the "
+            << "Would you like to update it with any pages that were added to the "
+            << "groundtruth since it was trained? Only the new pages will have their "
+            << "features extracted and the detector will be updated without redoing "
+            << "the full training. ";
+    if(Utils::promptYesNo()) {
+      if(updateDetector()) {
+        return;
+      }
+      std::cout << "The detector could not be updated. ";
+    }
+    std::cout << "Would you like to retrain the detector from scratch now? If you answer no, the "
             << "detector training will not be carried out, and the old detector will "
             << "be kept untouched. ";
     doDetectorTraining = Utils::promptYesNo();
@@ -73,6 +85,17 @@ void TrainerForMathExpressionFinder::trainDetector() {
     return;
   }
 
+  // Detectors which can be trained straight from the sample file get it
+  // that way so the samples never all have to be held in memory at once
+  if(detector->canTrainFromFile()) {
+    const std::string samplePath =
+        TrainingSampleExtractor(finderInfo, featureExtractor).prepareSampleFile();
+    std::cout << "Finished getting samples.\n";
+    detector->doTrainingFromFile(samplePath);
+    std::cout << "Finished training the detector.\n";
+    return;
+  }
+
   // first get all of the binary labeled samples using the chosen feature extractors
   samples = getSamples();
   std::cout << "Finished getting samples.\n";
@@ -81,6 +104,36 @@ void TrainerForMathExpressionFinder::trainDetector() {
   std::cout << "Finished training the detector.\n";
 }
 
+bool TrainerForMathExpressionFinder::updateDetector() {
+  if(!DatasetSelectionMenu::groundtruthDirPathIsGood(finderInfo->getGroundtruthDirPath())) {
+    std::cout << "ERROR: The groundtruth directory at " << finderInfo->getGroundtruthDirPath()
+            << " appears to be corrupted. Cannot update the detector without a valid groundtruth path.\n";
+    return false;
+  }
+  if(!samples.empty()) {
+    TrainingSampleExtractor::destroySamples(samples);
+  }
+  int firstNewImage = 0;
+  samples = TrainingSampleExtractor(finderInfo, featureExtractor)
+      .getSamplesWithNewPages(&firstNewImage);
+  std::cout << "Finished getting samples.\n";
+  if(firstNewImage == samples.size()) {
+    std::cout << "There are no new pages to update the detector with. The "
+        << "detector was left untouched.\n";
+    return true;
+  }
+  std::cout << "Would you also like to compare the updated detector against one "
+      << "retrained from scratch on all of the samples (with the same parameters)? "
+      << "This takes about as long as the final step of a full training. ";
+  const bool compareToFullRetrain = Utils::promptYesNo();
+  if(!detector->doIncrementalTraining(samples, firstNewImage,
+      compareToFullRetrain)) {
+    return false;
+  }
+  std::cout << "Finished updating the detector.\n";
+  return true;
+}
+
 std::vector<std::vector<BLSample*> > TrainerForMathExpressionFinder::getSamples() {
   if(samples.empty()) {
     samples = TrainingSampleExtractor(finderInfo, featureExtractor).getSamples();
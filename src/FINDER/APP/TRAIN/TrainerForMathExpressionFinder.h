@@ -37,6 +37,7 @@ class TrainerForMathExpressionFinder {
  private:
 
   void trainDetector();
+  bool updateDetector(); // incremental update from newly added groundtruth pages
   void trainSegmentor();
 
   FinderInfo* finderInfo; // owned by this class
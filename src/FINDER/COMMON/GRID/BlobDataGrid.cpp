@@ -16,6 +16,7 @@
 #include <SentenceData.h>
 #include <M_Utils.h>
 #include <MFinderResults.h>
+#include <WordCache.h>
 
 #include <baseapi.h>
 
@@ -24,17 +25,21 @@ BlobDataGrid::BlobDataGrid(const int& gridsize,
     const ICOORD& tright,
     tesseract::TessBaseAPI* const tessBaseAPI,
     PIX* const image,
-    std::string imageName): nonItalicizedRatio(-1) {
+    std::string imageName): recognized(true), nonItalicizedRatio(-1),
+        blobCount(0) {
   this->Init(gridsize, bleft, tright);
   this->tessBaseAPI = tessBaseAPI;
   this->image = image;
   this->imageName = imageName;
   this->binaryImage = NULL;
+  this->filteredNoise = NULL;
+  this->pictureRegions = NULL;
   this->area = gridheight_ * gridwidth_;
 }
 
 // TODO: Make sure to deallocate things as necessary
 BlobDataGrid::~BlobDataGrid() {
+  WordClassificationCache::getInstance().endPage(tessBaseAPI);
   for(int i = 0; i < tesseractBlocks.size(); ++i) {
     delete tesseractBlocks[i];
   }
@@ -42,6 +47,8 @@ BlobDataGrid::~BlobDataGrid() {
   allRecognizedSentences.clear(); // these were just pointers managed by the blocks which should already have been deleted by now
 
   pixDestroy(&binaryImage);
+  boxaDestroy(&filteredNoise);
+  boxaDestroy(&pictureRegions);
 
   // First grab any shared (double) pointers. Have to delete them after the blobs are deleted
   GenericVector<BlobMergeData**> mergeDataShared;
@@ -99,10 +106,41 @@ Pix* BlobDataGrid::getBinaryImage() {
   return binaryImage;
 }
 
+void BlobDataGrid::setBinaryImage(Pix* const binaryImage) {
+  pixDestroy(&this->binaryImage);
+  this->binaryImage = binaryImage;
+}
+
+void BlobDataGrid::setFilteredNoise(Boxa* const filteredNoise) {
+  boxaDestroy(&this->filteredNoise);
+  this->filteredNoise = filteredNoise;
+}
+
+Boxa* BlobDataGrid::getFilteredNoise() {
+  return filteredNoise;
+}
+
+void BlobDataGrid::setPictureRegions(Boxa* const pictureRegions) {
+  boxaDestroy(&this->pictureRegions);
+  this->pictureRegions = pictureRegions;
+}
+
+Boxa* BlobDataGrid::getPictureRegions() {
+  return pictureRegions;
+}
+
 std::string BlobDataGrid::getImageName() {
   return imageName;
 }
 
+bool BlobDataGrid::hasRecognitionResults() {
+  return recognized;
+}
+
+void BlobDataGrid::setHasRecognitionResults(const bool recognized) {
+  this->recognized = recognized;
+}
+
 tesseract::TessBaseAPI* BlobDataGrid::getTessBaseAPI() {
   return tessBaseAPI;
 }
@@ -173,6 +211,39 @@ BlobData* BlobDataGrid::getEntryWithBoundingBox(const TBOX box) {
   return NULL;
 }
 
+int BlobDataGrid::indexBlobs() {
+  BlobDataGridSearch search(this);
+  search.SetUniqueMode(true);
+  search.StartFullSearch();
+  BlobData* blob = NULL;
+  int index = 0;
+  while((blob = search.NextFullSearch()) != NULL) {
+    blob->setBlobIndex(index++);
+  }
+  blobCount = index;
+  return blobCount;
+}
+
+int BlobDataGrid::getBlobCount() {
+  return blobCount;
+}
+
+int BlobDataGrid::applyDetectionThreshold(const double threshold) {
+  int scoredBlobs = 0;
+  BlobDataGridSearch search(this);
+  search.SetUniqueMode(true);
+  search.StartFullSearch();
+  BlobData* blob = NULL;
+  while((blob = search.NextFullSearch()) != NULL) {
+    if(blob->hasMathExpressionDetectionScore()) {
+      blob->setMathExpressionDetectionResult(
+          blob->getMathExpressionDetectionScore() >= threshold);
+      ++scoredBlobs;
+    }
+  }
+  return scoredBlobs;
+}
+
 MathExpressionFinderResults* BlobDataGrid::getDetectionResults(
     const std::string& resultsDirName) {
   return MathExpressionFinderResultsBuilder()
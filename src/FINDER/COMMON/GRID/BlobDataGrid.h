@@ -47,8 +47,25 @@ class BlobDataGrid : public tesseract::BBGrid<BlobData, BlobData_CLIST, BlobData
 
   Pix* getBinaryImage();
 
+  /**
+   * Sets the thresholded image for a grid that has no Tesseract api to get it
+   * from. The grid takes ownership.
+   */
+  void setBinaryImage(Pix* const binaryImage);
+
   std::string getImageName();
 
+  /**
+   * False if the grid was built from Tesseract's layout analysis alone (see
+   * BlobDataGridFactory::OcrLevel), in which case none of its blobs belong to
+   * a recognized character, word or row. Checks that go by the recognition
+   * results have to tell that apart from Tesseract failing to recognize the
+   * blobs. True unless set otherwise.
+   */
+  bool hasRecognitionResults();
+
+  void setHasRecognitionResults(const bool recognized);
+
   tesseract::TessBaseAPI* getTessBaseAPI();
 
   /**
@@ -95,6 +112,27 @@ class BlobDataGrid : public tesseract::BBGrid<BlobData, BlobData_CLIST, BlobData
    */
   BlobData* getEntryWithBoundingBox(const TBOX box);
 
+  /**
+   * Assigns each blob on the grid a unique index from 0 to the number of
+   * blobs - 1 and returns the number of blobs. Must be called again if
+   * blobs are inserted or removed afterwards. Feature extractors size their
+   * per-page data on the count and address it by each blob's index.
+   */
+  int indexBlobs();
+
+  /**
+   * Gets the number of blobs found on the grid the last time it was indexed
+   */
+  int getBlobCount();
+
+  /**
+   * Detects each blob that has a raw detection score again at the given
+   * threshold (i.e., as math if its score is at least the threshold). Blobs
+   * without a score keep the detection result they have. Returns the number
+   * of blobs that had a score.
+   */
+  int applyDetectionThreshold(const double threshold);
+
   /**
    * Builds out and returns the results of detection. The allocated memory
    * is owned by the caller.
@@ -149,6 +187,33 @@ class BlobDataGrid : public tesseract::BBGrid<BlobData, BlobData_CLIST, BlobData
 
   int getArea();
 
+  /**
+   * Sets the boxes of the connected components that were filtered out as
+   * noise rather than being put on the grid. The grid takes ownership.
+   */
+  void setFilteredNoise(Boxa* const filteredNoise);
+
+  /**
+   * Gets the boxes (in image coordinates) of the connected components that
+   * were filtered out as noise (owned by the grid). Empty if there weren't
+   * any and NULL if the grid wasn't made by the factory.
+   */
+  Boxa* getFilteredNoise();
+
+  /**
+   * Sets the boxes of the picture regions whose connected components were
+   * left off of the grid. The grid takes ownership.
+   */
+  void setPictureRegions(Boxa* const pictureRegions);
+
+  /**
+   * Gets the boxes (in image coordinates) of the picture regions whose
+   * connected components were left off of the grid (owned by the grid).
+   * Empty if there weren't any and NULL if the grid wasn't made by the
+   * factory.
+   */
+  Boxa* getPictureRegions();
+
  private:
 
   tesseract::TessBaseAPI* tessBaseAPI; // the api this grid relies on
@@ -159,6 +224,8 @@ class BlobDataGrid : public tesseract::BBGrid<BlobData, BlobData_CLIST, BlobData
 
   std::string imageName;
 
+  bool recognized; // whether Tesseract's recognition was run on the page
+
   // list of wrappers around groups of sentences/paragraphs or other contents
   // logically grouped together by Tesseract during layout analysis and recognition
   std::vector<TesseractBlockData*> tesseractBlocks;
@@ -181,6 +248,12 @@ class BlobDataGrid : public tesseract::BBGrid<BlobData, BlobData_CLIST, BlobData
   GenericVector<Segmentation*> segmentations;
 
   int area;
+
+  int blobCount; // number of blobs on the grid as of the last indexing
+
+  Boxa* filteredNoise; // components left off of the grid as noise
+
+  Boxa* pictureRegions; // regions whose components were left off of the grid
 };
 
 
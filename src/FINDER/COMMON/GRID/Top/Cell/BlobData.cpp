@@ -7,7 +7,6 @@
 
 #include <BlobData.h>
 
-#include <BlobFeatExtData.h>
 #include <WordData.h>
 #include <CharData.h>
 #include <RowData.h>
@@ -15,14 +14,18 @@
 #include <M_Utils.h>
 
 BlobData::BlobData(TBOX box, PIX* blobImage, BlobDataGrid* parentGrid)
-    : mathExpressionDetectionResult(false),
+    : mergeData(NULL),
       tesseractCharData(NULL),
+      layoutRow(NULL),
+      blobIndex(-1),
+      mathExpressionDetectionResult(false),
+      mathExpressionDetectionScore(0),
+      detectionScoreKnown(false),
       minTesseractCertainty(-20),
       markedAsTesseractSplit(false),
       markedForDeletion(false),
       inBadRegion(false),
-      badRegionKnown(false),
-      mergeData(NULL) {
+      badRegionKnown(false) {
   this->box = box;
   this->blobImage = blobImage;
   this->parentGrid = parentGrid;
@@ -104,35 +107,20 @@ TesseractBlockData* BlobData::getParentBlock() {
   return getParentRow()->getParentBlock();
 }
 
-/**
- * Gets the size of the variable data vector
- */
-int BlobData::getVariableDataLength() {
-  return variableExtractionData.size();
+void BlobData::setLayoutRow(TesseractRowData* const layoutRow) {
+  this->layoutRow = layoutRow;
 }
 
-/**
- * Looks up an entry in the variable data vector and
- * returns it as a char*. It is up to the feature extractor
- * to know the index and cast the returned pointer appropriately.
- */
-BlobFeatureExtractionData* BlobData::getVariableDataAt(const int& i) {
-  return variableExtractionData.at(i);
+TesseractRowData* BlobData::getLayoutRow() {
+  return layoutRow;
 }
 
-/**
- * Adds new data to the variable data vector for this blob.
- * No more than one data entry should be added per feature extractor
- * and if a feature extractor adds a data entry for one blob it must
- * add one for all of them. This method returns the vector index at
- * which the data was placed for this blob. This return can be viewed
- * as the key for grabbing the data later when it's needed. If no
- * data need be retrieved for this blob later than no need to use
- * this method.
- */
-int BlobData::appendNewVariableData(BlobFeatureExtractionData* const data) {
-  variableExtractionData.push_back(data);
-  return variableExtractionData.size() - 1;
+void BlobData::setBlobIndex(const int blobIndex) {
+  this->blobIndex = blobIndex;
+}
+
+int BlobData::getBlobIndex() {
+  return blobIndex;
 }
 
 /**
@@ -168,6 +156,20 @@ bool BlobData::getMathExpressionDetectionResult() {
   return mathExpressionDetectionResult;
 }
 
+void BlobData::setMathExpressionDetectionScore(
+    const double mathExpressionDetectionScore) {
+  this->mathExpressionDetectionScore = mathExpressionDetectionScore;
+  detectionScoreKnown = true;
+}
+
+double BlobData::getMathExpressionDetectionScore() {
+  return mathExpressionDetectionScore;
+}
+
+bool BlobData::hasMathExpressionDetectionScore() {
+  return detectionScoreKnown;
+}
+
 std::vector<DoubleFeature*> BlobData::getExtractedFeatures() {
   return extractedFeatures;
 }
@@ -226,6 +228,16 @@ bool BlobData::belongsToRecognizedNormalRow() {
   return getParentRow()->getIsConsideredNormal();
 }
 
+bool BlobData::belongsToNormalRow() {
+  if(parentGrid->hasRecognitionResults()) {
+    return belongsToRecognizedNormalRow();
+  }
+  if(layoutRow == NULL) {
+    return false;
+  }
+  return layoutRow->getIsConsideredNormal();
+}
+
 float BlobData::getAverageWordConfInRow() {
   if(getParentRow() == NULL) {
     return -20;
@@ -249,6 +261,11 @@ float BlobData::getAverageWordConfInRow() {
 }
 
 bool BlobData::belongsToBadRegion() {
+  // a bad region is one Tesseract couldn't recognize, which can't be told
+  // when recognition wasn't run (every blob would otherwise count as bad)
+  if(!parentGrid->hasRecognitionResults()) {
+    return false;
+  }
   if(getParentRow() != NULL) {
     return false;
   }
@@ -12,7 +12,7 @@
 
 
 #include <BlobDataGrid.h>
-#include <BlobFeatExtData.h>
+#include <DoubleFeature.h>
 
 #include <baseapi.h>
 #include <tesseractclass.h>
@@ -89,6 +89,19 @@ class BlobData: public ELIST_LINK {
   TesseractRowData* getParentRow();
   TesseractBlockData* getParentBlock();
 
+  /**
+   * Sets the row from Tesseract's layout analysis that this blob lies in.
+   * Only set on grids built without recognition results, where no blob
+   * belongs to a recognized character (and so to a recognized row).
+   */
+  void setLayoutRow(TesseractRowData* const layoutRow);
+
+  /**
+   * Gets the row from Tesseract's layout analysis that this blob lies in
+   * (NULL if it isn't in one or the grid has recognition results)
+   */
+  TesseractRowData* getLayoutRow();
+
   /**
    * Gets the features extracted by all feature extractors that
    * were run on this blob. There should be no need to call this
@@ -97,28 +110,17 @@ class BlobData: public ELIST_LINK {
   std::vector<DoubleFeature*> getExtractedFeatures();
 
   /**
-   * Gets the size of the variable data vector
+   * Sets the index of this blob within its parent grid. Indices are assigned
+   * once the grid is complete and run from 0 to the grid's blob count - 1.
    */
-  int getVariableDataLength();
+  void setBlobIndex(const int blobIndex);
 
   /**
-   * Looks up an entry in the variable data vector and
-   * returns it as a char*. It is up to the feature extractor
-   * to know the index and cast the returned pointer appropriately.
+   * Gets the index of this blob within its parent grid. Feature extractors
+   * use this as the row into the per-page data columns they own. Returns -1
+   * if the grid hasn't been indexed yet.
    */
-  BlobFeatureExtractionData* getVariableDataAt(const int& i);
-
-  /**
-   * Adds new data to the variable data vector for this blob.
-   * No more than one data entry should be added per feature extractor
-   * and if a feature extractor adds a data entry for one blob it must
-   * add one for all of them. This method returns the vector index at
-   * which the data was placed for this blob. This return can be viewed
-   * as the key for grabbing the data later when it's needed. If no
-   * data need be retrieved for this blob later than no need to use
-   * this method.
-   */
-  int appendNewVariableData(BlobFeatureExtractionData* const data);
+  int getBlobIndex();
 
   /**
    * Appends the provided vector of features to this blob entry's array
@@ -143,6 +145,24 @@ class BlobData: public ELIST_LINK {
    */
   bool getMathExpressionDetectionResult();
 
+  /**
+   * Sets the raw score the detector's decision was made from (should be set by
+   * detectors that have one), where the blob is detected as math if its score
+   * is at least the detector's threshold. Keeping it lets the blob be
+   * detected again at a different threshold without running the detector.
+   */
+  void setMathExpressionDetectionScore(const double mathExpressionDetectionScore);
+
+  /**
+   * Gets the raw detection score, only meaningful if hasMathExpressionDetectionScore
+   */
+  double getMathExpressionDetectionScore();
+
+  /**
+   * Returns true if the detector gave this blob a raw detection score
+   */
+  bool hasMathExpressionDetectionScore();
+
   /**
    * Returns true if this blob belongs to a recognized character belonging to a word
    * recognized as being valid by Tesseract during OCR
@@ -170,6 +190,13 @@ class BlobData: public ELIST_LINK {
    */
   bool belongsToRecognizedNormalRow();
 
+  /**
+   * Same as belongsToRecognizedNormalRow except that on a grid built without
+   * recognition results the blob's layout row is used in place of its
+   * recognized one (see getLayoutRow).
+   */
+  bool belongsToNormalRow();
+
   /**
    * Returns the average confidence for the words in the row to which this
    * blob belongs. If it doesn't belong to a row then returns the minimum (-20)
@@ -182,6 +209,7 @@ class BlobData: public ELIST_LINK {
    * Tesseract completely missed an entire row or paragraph of text (not only
    * missing it but returning NULL for every entry). In such a case all of the
    * blobs in that region will be marked such that this method will return false.
+   * Always false on a grid built without recognition results.
    */
   bool belongsToBadRegion();
   void setBadRegion(bool status);
@@ -266,9 +294,10 @@ class BlobData: public ELIST_LINK {
 
   TesseractCharData* tesseractCharData;
 
-  // Data structures which vary depending on the features extracted
-  // Based on feature extractor used, each entry is cast to its class type
-  std::vector<BlobFeatureExtractionData*> variableExtractionData;
+  TesseractRowData* layoutRow;
+
+  // index of this blob within its parent grid (-1 until the grid is indexed)
+  int blobIndex;
 
   // This blob entry's array of extracted features. There should be at least
   // one entry for each feature extractor run on this blob (some feature extractors
@@ -281,6 +310,8 @@ class BlobData: public ELIST_LINK {
   std::vector<DoubleFeature*> extractedFeatures;
 
   bool mathExpressionDetectionResult;
+  double mathExpressionDetectionScore;
+  bool detectionScoreKnown;
 
   // the lowest possible certainty of a blob defined by Tesseract
   // (should be defined to -20 in the init list)
@@ -17,6 +17,8 @@
 
 #include <NGramRanker.h>
 
+#include <WordCache.h>
+
 #include <baseapi.h>
 
 NGramRanker::NGramRanker(StopwordFileReader* stopwordHelper) {
@@ -278,6 +280,7 @@ void NGramRanker::writeNGramFile(const int& gram,
   // Init a tesseract api for validating words
   tesseract::TessBaseAPI api;
   api.Init("/usr/local/share/", "eng");
+  WordClassificationCache::getInstance().startPage(&api);
 
   for(int i = 0; i < sentences.length(); ++i) {
     char* s_txt = sentences[i]->sentence_txt;
@@ -345,13 +348,14 @@ void NGramRanker::writeNGramFile(const int& gram,
               }
               // discard any invalid word or any word on the stop word list
               if(word != NULL) {
-                if(((api.IsValidWord(word) == 0)
+                if((!WordClassificationCache::getInstance().isValidWord(&api, word)
                     && !Utils::stringCompare(word, "=")
                     && !Utils::stringCompare(word, "+")
                     && !Utils::stringCompare(word, "-")
                     && !Utils::stringCompare(word, "*")
                     && !Utils::stringCompare(word, "/"))
-                    || (gram == 1 && stopwordHelper->isStopWord(word))) {
+                    || (gram == 1 && WordClassificationCache::getInstance()
+                        .isStopWord(stopwordHelper, word))) {
                   Utils::destroyStr(word);
                 }
               }
@@ -401,6 +405,7 @@ void NGramRanker::writeNGramFile(const int& gram,
     }
     ngram.clear();
   }
+  WordClassificationCache::getInstance().endPage(&api);
   stream->close();
 }
 
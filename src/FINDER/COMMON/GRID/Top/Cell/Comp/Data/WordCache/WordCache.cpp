@@ -0,0 +1,141 @@
+/*
+ * WordCache.cpp
+ */
+
+#include <WordCache.h>
+
+#include <StopwordHelper.h>
+
+#include <baseapi.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <assert.h>
+
+WordClassificationCache& WordClassificationCache::getInstance() {
+  static WordClassificationCache cache;
+  return cache;
+}
+
+WordClassificationCache::WordClassificationCache() : resets(0) {
+  for(int i = 0; i < CLASSIFICATION_COUNT; ++i) {
+    hits[i] = 0;
+    misses[i] = 0;
+    missSeconds[i] = 0;
+  }
+}
+
+bool WordClassificationCache::isValidWord(tesseract::TessBaseAPI* const api,
+    const char* const word) {
+  return classify(VALID_WORD, std::string(word),
+      [this, api]() -> EntryMap* {
+        std::unordered_map<tesseract::TessBaseAPI*, EntryMap>::iterator it =
+            pageEntries.find(api);
+        return (it != pageEntries.end()) ? &it->second : NULL;
+      },
+      [api, word]() { return api->IsValidWord(word) != 0; });
+}
+
+void WordClassificationCache::startPage(tesseract::TessBaseAPI* const api) {
+  std::lock_guard<std::mutex> lock(mutex);
+  pageEntries[api].clear();
+}
+
+void WordClassificationCache::endPage(tesseract::TessBaseAPI* const api) {
+  std::lock_guard<std::mutex> lock(mutex);
+  pageEntries.erase(api);
+}
+
+bool WordClassificationCache::isStopWord(StopwordFileReader* const stopwords,
+    const std::string& word) {
+  return classify(STOP_WORD, word, [this]() { return &entries; },
+      [stopwords, &word]() { return stopwords->isStopWord(word); });
+}
+
+bool WordClassificationCache::isMathWord(
+    const GenericVector<std::string>& mathwords, const std::string& word) {
+  return classify(MATH_WORD, word, [this]() { return &entries; },
+      [&mathwords, &word]() {
+        for(int i = 0; i < mathwords.length(); ++i) {
+          if(word == mathwords[i]) {
+            return true;
+          }
+        }
+        return false;
+      });
+}
+
+template <typename GetEntries, typename LookUp>
+bool WordClassificationCache::classify(const Classification classification,
+    const std::string& word, GetEntries getEntries, LookUp lookUp) {
+  const unsigned char bit = 1 << classification;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const EntryMap* const found = getEntries();
+    if(found != NULL) {
+      EntryMap::const_iterator it = found->find(word);
+      if(it != found->end() && (it->second.known & bit)) {
+        ++hits[classification];
+        return (it->second.value & bit) != 0;
+      }
+    }
+  }
+
+  // Two threads may both miss on the same word and look it up, which is
+  // harmless since they'll get the same answer
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  const bool result = lookUp();
+  const double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ++misses[classification];
+  missSeconds[classification] += seconds;
+  EntryMap* const cached = getEntries(); // could have ended during the lookup
+  if(cached == NULL) {
+    return result;
+  }
+  if(cached->size() >= MAX_WORD_CACHE_ENTRIES
+      && cached->find(word) == cached->end()) {
+    cached->clear();
+    ++resets;
+  }
+  Entry& entry = (*cached)[word];
+  entry.known |= bit;
+  if(result) {
+    entry.value |= bit;
+  }
+  return result;
+}
+
+void WordClassificationCache::printStats(std::ostream& stream) {
+  const char* const names[CLASSIFICATION_COUNT] =
+    { "valid_word", "stopword", "math_word" };
+  std::lock_guard<std::mutex> lock(mutex);
+  stream << "lookup\thits\tmisses\thit_rate\tlookup_seconds\tseconds_saved\n";
+  for(int i = 0; i < CLASSIFICATION_COUNT; ++i) {
+    const long total = hits[i] + misses[i];
+    const double hitRate = (total > 0) ? (double)hits[i] / total : 0;
+    // each hit saves about as long as the average miss took to look up
+    const double secondsSaved = (misses[i] > 0) ?
+        hits[i] * (missSeconds[i] / misses[i]) : 0;
+    stream << names[i] << "\t" << hits[i] << "\t" << misses[i] << "\t"
+        << hitRate << "\t" << missSeconds[i] << "\t" << secondsSaved << "\n";
+  }
+  stream << "# " << entries.size() << " words cached (and valid words for "
+      << pageEntries.size() << " pages), cleared out " << resets
+      << " times after reaching " << MAX_WORD_CACHE_ENTRIES << "\n";
+}
+
+void WordClassificationCache::writeStatsFile(const std::string& path) {
+  std::ofstream stream(path.c_str());
+  if(!stream.is_open()) {
+    std::cout << "ERROR: Could not open " << path << " to write the word cache stats to\n";
+    assert(false);
+  }
+  printStats(stream);
+}
@@ -0,0 +1,121 @@
+/*
+ * WordCache.h
+ */
+
+#ifndef WORDCACHE_H_
+#define WORDCACHE_H_
+
+#include <StopwordHelper.h>
+
+#include <baseapi.h>
+
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Most words the cache holds before it's cleared out and started over
+#define MAX_WORD_CACHE_ENTRIES 200000
+
+/**
+ * Remembers whether each word Tesseract recognized is a valid dictionary word,
+ * a stopword, and a math word so that the same common words ("the", "of", a
+ * variable name used all over a paper) aren't looked up over and over. There's
+ * one cache for the whole process, shared by every thread. The stopwords and
+ * math words are shared by every page. A word's validity isn't, since
+ * Tesseract's answer also goes by the words it added to its document
+ * dictionary while recognizing the page and by whether the page's last word
+ * was hyphenated. Those are only known to be the same for one TessBaseAPI on
+ * one page, so valid words are cached separately for each API between calls
+ * to startPage and endPage. When a cache fills up (see
+ * MAX_WORD_CACHE_ENTRIES) it's just emptied out, since the common words that
+ * matter most are quick to come back.
+ */
+class WordClassificationCache {
+ public:
+
+  static WordClassificationCache& getInstance();
+
+  /**
+   * Same as api->IsValidWord(word). Only cached between startPage and
+   * endPage for the api.
+   */
+  bool isValidWord(tesseract::TessBaseAPI* const api, const char* const word);
+
+  /**
+   * Starts caching the valid words for the page the api was just run on
+   * (anything cached for it before is forgotten). Has to be called once the
+   * api is done recognizing a page and before its words are looked up.
+   */
+  void startPage(tesseract::TessBaseAPI* const api);
+
+  /**
+   * Forgets the valid words cached for the api's page. Has to be called
+   * before the api moves on to another page or is destroyed.
+   */
+  void endPage(tesseract::TessBaseAPI* const api);
+
+  /**
+   * Same as stopwords->isStopWord(word)
+   */
+  bool isStopWord(StopwordFileReader* const stopwords, const std::string& word);
+
+  /**
+   * True if the word exactly matches one of the given math words. The math
+   * words are assumed to be the same on every call.
+   */
+  bool isMathWord(const GenericVector<std::string>& mathwords,
+      const std::string& word);
+
+  /**
+   * Prints the hits, misses, and estimated time saved for each kind of lookup
+   */
+  void printStats(std::ostream& stream);
+
+  /**
+   * Writes the same stats as printStats to the given file
+   */
+  void writeStatsFile(const std::string& path);
+
+ private:
+
+  WordClassificationCache();
+
+  enum Classification {
+    VALID_WORD,
+    STOP_WORD,
+    MATH_WORD,
+    CLASSIFICATION_COUNT
+  };
+
+  // bit i of known is set once classification i has been looked up, in
+  // which case bit i of value holds the result
+  struct Entry {
+    Entry() : known(0), value(0) {}
+    unsigned char known;
+    unsigned char value;
+  };
+
+  typedef std::unordered_map<std::string, Entry> EntryMap;
+
+  // Returns the cached result for the word if there is one, otherwise calls
+  // lookUp to get it and caches that. The lock isn't held during the lookup.
+  // The entries are looked up with getEntries while the lock is held (NULL
+  // means the result isn't cached).
+  template <typename GetEntries, typename LookUp>
+  bool classify(const Classification classification, const std::string& word,
+      GetEntries getEntries, LookUp lookUp);
+
+  std::mutex mutex;
+  EntryMap entries; // stopwords and math words
+  std::unordered_map<tesseract::TessBaseAPI*, EntryMap> pageEntries; // valid words
+  long resets;
+
+  // per classification
+  long hits[CLASSIFICATION_COUNT];
+  long misses[CLASSIFICATION_COUNT];
+  double missSeconds[CLASSIFICATION_COUNT]; // total time spent on lookups
+};
+
+
+#endif /* WORDCACHE_H_ */
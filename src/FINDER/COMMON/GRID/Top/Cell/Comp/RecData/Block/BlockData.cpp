@@ -19,6 +19,7 @@
 #include <RowData.h>
 #include <WordData.h>
 #include <BlobDataGrid.h>
+#include <WordCache.h>
 
 //#define DBG_INFO_GRID
 //#define DBG_INFO_GRID_S
@@ -81,7 +82,7 @@ void TesseractBlockData::findRecognizedSentences(
         }
         if(isupper(wordstr[0]) && islower(wordstr[1])) {
           // see if the uppercase word is valid or not based on the api
-          if(api->IsValidWord(wordstr)) {
+          if(WordClassificationCache::getInstance().isValidWord(api, wordstr)) {
             // found the start of a sentence!!
             tesseractSentences.push_back(
                 new TesseractSentenceData(this, i, j));
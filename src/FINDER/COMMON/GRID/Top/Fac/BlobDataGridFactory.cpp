@@ -15,8 +15,10 @@
 #include <CharData.h>
 #include <RowData.h>
 #include <WordData.h>
+#include <WordCache.h>
 
 #include <string>
+#include <vector>
 
 #include <M_Utils.h>
 #include <Utils.h>
@@ -32,9 +34,27 @@
 //#define DBG_MULTI_PARENT_ISSUE
 //#define DBG_NO_OVERLAP
 //#define DBG_SHOW_SPLIT
+//#define DBG_SPECKLE
+//#define DBG_PICTURES
+
+// On grids built from the layout alone a row is considered normal (i.e., a
+// row of text rather than displayed math) if it is at least this fraction as
+// wide as the widest row on its block or if it starts at the block's left
+// margin (the last line of a paragraph)
+#define LAYOUT_NORMAL_ROW_WIDTH_RATIO .75
+#define LAYOUT_ROW_MARGIN_TOLERANCE 2 // in multiples of the row's height
+
+BlobDataGridFactory::BlobDataGridFactory() {}
+
+BlobDataGridFactory::BlobDataGridFactory(
+    const SpeckleFilterParams& speckleParams,
+    const PictureFilterParams& pictureParams)
+        : speckleParams(speckleParams), pictureParams(pictureParams) {}
 
 BlobDataGrid* BlobDataGridFactory::createBlobDataGrid(Pix* image,
-    tesseract::TessBaseAPI* tessBaseApi, const std::string imageName) {
+    tesseract::TessBaseAPI* tessBaseApi, const std::string imageName,
+    PageMemoryStats* const memoryStats, const OcrLevel ocrLevel) {
+  const bool recognize = (ocrLevel == FULL_RECOGNITION);
 
   // Initialize the tesseract api
   tessBaseApi->Init("/usr/local/share/", "eng");
@@ -45,49 +65,131 @@ BlobDataGrid* BlobDataGridFactory::createBlobDataGrid(Pix* image,
   tessBaseApi->SetPageSegMode(tesseract::PSM_AUTO);
 
   TesseractParamManager tesseractParamManager = TesseractParamManager(tessBaseApi); // in case...
-  tesseractParamManager.activateBoolParam("save_blob_choices"); // Tell Tesseract to save blob choices
+  if(recognize) {
+    tesseractParamManager.activateBoolParam("save_blob_choices"); // Tell Tesseract to save blob choices
+  }
 
   /**
    * ---------------
    *    Stage 1:
    * ---------------
+   * Get all of the image's raw connected components and pick out the ones
+   * that are just speckle or other noise or that are part of a picture. Those
+   * never make it onto the grid (and the pictures, along with the noise if
+   * asked for, aren't shown to Tesseract either), which on a dirty scan or a
+   * page full of figures can be the large majority of the components.
+   */
+  // Grab the connected components (as images)
+  Pixa* blobImages = pixaCreate(0);
+  Boxa* blobCoords = pixConnComp(image, &blobImages, 8);
+  assert(blobImages->n == blobCoords->n); // should be the same.. don't see why not...
+
+  SpeckleFilter speckleFilter(speckleParams);
+  std::vector<bool> isNoise;
+  const int noiseCount = speckleFilter.findNoise(blobCoords, blobImages, &isNoise);
+#ifdef DBG_SPECKLE
+  std::cout << "Filtered " << noiseCount << " of " << blobCoords->n
+      << " components as noise (median character height "
+      << speckleFilter.getMedianCharHeight() << ")\n";
+#endif
+  if(memoryStats != NULL) {
+    memoryStats->setNoiseComponentCount(noiseCount);
+    memoryStats->endStage("connected_components");
+  }
+
+  // Pictures are found from a halftone mask made on (usually) a reduced
+  // copy of the page and from how crowded with components each part of the
+  // page is, so they're cheap to find compared to putting their components
+  // through the rest of the pipeline
+  std::vector<bool> inPicture;
+  Boxa* pictureRegions = NULL;
+  const int pictureCount = PictureFilter(pictureParams).findPictureComponents(
+      image, blobCoords, isNoise, speckleFilter.getMedianCharHeight(),
+      &inPicture, &pictureRegions);
+#ifdef DBG_PICTURES
+  std::cout << "Found " << pictureRegions->n << " picture regions holding "
+      << pictureCount << " components\n";
+#endif
+  if(memoryStats != NULL) {
+    memoryStats->setPictureComponentCount(pictureCount);
+    memoryStats->endStage("picture_regions");
+  }
+
+  /**
+   * ---------------
+   *    Stage 2:
+   * ---------------
    * Here I leverage Tesseract's auto page segmentation. While their provided
    * math finding logic is disabled at this stage, the table detection
    * and segmentation logic is kept among various other features. I also
    * leverage their recognition results without any math equation detection in
-   * place.
+   * place (unless only the layout was asked for).
    */
-  // Run Tesseract's layout analysis and recognition
-  tessBaseApi->SetImage(image); // set the image
-  tessBaseApi->Recognize(NULL); // Run Tesseract's layout analysis and recognition without equation detection
+  // Run Tesseract's layout analysis and recognition. The picture components
+  // are erased from the image it's given since they're left off of the grid
+  // anyways, and recognizing them just turns up garbage words and rows.
+  std::vector<bool> isErased(inPicture);
+  if(speckleParams.cleanOcrImage) {
+    for(int i = 0; i < isErased.size(); ++i) {
+      isErased[i] = isErased[i] || isNoise[i];
+    }
+  }
+  if(pictureCount > 0 || (speckleParams.cleanOcrImage && noiseCount > 0)) {
+    // Tesseract keeps its own reference to the image it's given
+    Pix* cleanedImage = SpeckleFilter::getCleanedImage(image, blobCoords,
+        blobImages, isErased);
+    tessBaseApi->SetImage(cleanedImage);
+    pixDestroy(&cleanedImage);
+  } else {
+    tessBaseApi->SetImage(image); // set the image
+  }
+  if(recognize) {
+    tessBaseApi->Recognize(NULL); // Run Tesseract's layout analysis and recognition without equation detection
+  } else {
+    // Sets up the page results with the blocks, rows, and (unrecognized) words
+    // found by the layout analysis. The iterator it hands back isn't needed.
+    delete tessBaseApi->AnalyseLayout();
+  }
+  // the api's answers to IsValidWord go by the page it just recognized
+  WordClassificationCache::getInstance().startPage(tessBaseApi);
+  if(memoryStats != NULL) {
+    memoryStats->endStage(recognize ? "tesseract_recognize" : "tesseract_layout");
+  }
 
   /**
    * ---------------
-   *    Stage 2:
+   *    Stage 3:
    * ---------------
-   * Get all of the image's raw connected components and place them on a 2D search-able grid.
+   * Place the connected components that weren't filtered out (as noise or
+   * as part of a picture) on a 2D search-able grid.
    * The grid entries added include, at this stage, just the connected component image
    * and its bounding box coordinates. More information will be added for each connected
    * component at later stages.
    */
-  // Grab the connected components (as images)
-  Pixa* blobImages = pixaCreate(0);
-  Boxa* blobCoords = pixConnComp(image, &blobImages, 8);
-  assert(blobImages->n == blobCoords->n); // should be the same.. don't see why not...
-
   // Create a grid containing an entry for each connected component which includes
   // its image and coordinates
   BlobDataGrid* blobDataGrid = new BlobDataGrid(1,
       ICOORD(0, 0), ICOORD(image->w, image->h), tessBaseApi, image, imageName);
+  blobDataGrid->setHasRecognitionResults(recognize);
 
   // Load all of the connected components and their images onto the grid
-  // along with the recognition results
+  // along with the recognition results. The noise is kept track of by its
+  // boxes alone.
+  Boxa* filteredNoise = boxaCreate(noiseCount);
 #ifdef DBG_INFO_GRID
   int total_blobs_grid = 0; // for debugging, count the total number of blobs in the original BlobGrid
 #endif
   for(int i = 0; i < blobImages->n; ++i) {
     Box* box = blobCoords->box[i];
-    Pix* blobImage = blobImages->pix[i];
+    if(isNoise[i]) {
+      boxaAddBox(filteredNoise, box, L_COPY);
+      continue;
+    }
+    if(inPicture[i]) {
+      continue;
+    }
+    // each blob gets its own reference to its image
+    Pix* blobImage = pixaGetPix(blobImages, i, L_CLONE);
     BlobData* blobData =
         new BlobData(M_Utils::LeptBoxToTessBox(box, image),
             blobImage, blobDataGrid);
@@ -96,6 +198,13 @@ BlobDataGrid* BlobDataGridFactory::createBlobDataGrid(Pix* image,
     ++total_blobs_grid;
 #endif
   }
+  blobDataGrid->setFilteredNoise(filteredNoise);
+  blobDataGrid->setPictureRegions(pictureRegions);
+  pixaDestroy(&blobImages);
+  boxaDestroy(&blobCoords);
+  if(memoryStats != NULL) {
+    memoryStats->endStage("blob_grid");
+  }
 
 #ifdef DBG_INFO_GRID
   {
@@ -112,10 +221,10 @@ BlobDataGrid* BlobDataGridFactory::createBlobDataGrid(Pix* image,
 
   /**
    * ---------------
-   *    Stage 3:
+   *    Stage 4:
    * ---------------
    * Iterating the results of Tesseract's layout analysis, insert each symbol-level
-   * result into the grid created in Stage 2 at its appropriate connected component
+   * result into the grid created in Stage 3 at its appropriate connected component
    * entry.
    */
   // Note: While I'm using the mutable iterator, I'm still only changing the pointer through the higher level api.
@@ -130,7 +239,11 @@ BlobDataGrid* BlobDataGridFactory::createBlobDataGrid(Pix* image,
   // Block -> Row -> Word -> Character -> Blob
 
   // Iterate through the block(s) of text inside the page
-  const BLOCK_RES_LIST* block_results = &(tessBaseApi->extGetPageResults()->block_res_list);
+  // (AnalyseLayout leaves the page results NULL for a blank page)
+  const PAGE_RES* const pageResults = tessBaseApi->extGetPageResults();
+  BLOCK_RES_LIST emptyBlockResults;
+  const BLOCK_RES_LIST* block_results = (pageResults != NULL) ?
+      &(pageResults->block_res_list) : &emptyBlockResults;
   BLOCK_RES_IT bres_it((BLOCK_RES_LIST*)block_results);
   bres_it.move_to_first();
   for(int i = 0; i < block_results->length(); ++i) { // start iterating blocks on page
@@ -149,6 +262,11 @@ BlobDataGrid* BlobDataGridFactory::createBlobDataGrid(Pix* image,
       TesseractRowData* tesseractRowData = new TesseractRowData(rowresit.data(), tesseractBlockData);
       tesseractBlockData->getTesseractRows().push_back(tesseractRowData);
       tesseractRowData->rowIndex = j;
+      if(!recognize) {
+        // the layout analysis alone doesn't give anything below the rows
+        rowresit.forward();
+        continue;
+      }
       char* firstvalidword = getRowValidTessWord(tesseractRowData, tessBaseApi);
       if(firstvalidword != NULL) {
         tesseractRowData->setHasValidTessWord(true);
@@ -178,7 +296,8 @@ BlobDataGrid* BlobDataGridFactory::createBlobDataGrid(Pix* image,
 
         // Go ahead and find out if Tesseract api sees the word as valid or not
         if(tesseractWordData->wordstr() != NULL) {
-          tesseractWordData->setIsValidTessWord(tessBaseApi->IsValidWord(tesseractWordData->wordstr()));
+          tesseractWordData->setIsValidTessWord(WordClassificationCache::getInstance()
+              .isValidWord(tessBaseApi, tesseractWordData->wordstr()));
         }
 
         // Iterate the characters in the word, adding all of each character's blobs to the grid
@@ -348,12 +467,16 @@ BlobDataGrid* BlobDataGridFactory::createBlobDataGrid(Pix* image,
   }
 #endif
 
-  for(int i = 0; i < blobDataGrid->getTesseractBlocks().size(); ++i) {
-    blobDataGrid->getTesseractBlocks()[i]->findRecognizedSentences(
-        tessBaseApi, blobDataGrid);
-  }
+  // Sentences and the row characteristics are both made up from the
+  // recognized words
+  if(recognize) {
+    for(int i = 0; i < blobDataGrid->getTesseractBlocks().size(); ++i) {
+      blobDataGrid->getTesseractBlocks()[i]->findRecognizedSentences(
+          tessBaseApi, blobDataGrid);
+    }
 
-  findAllRowCharacteristics(blobDataGrid);
+    findAllRowCharacteristics(blobDataGrid);
+  }
 
   // Put all of the recognized sentences and rows directly on list stored within the grid for convenience
   for(int i = 0; i < blobDataGrid->getTesseractBlocks().size(); ++i) {
@@ -367,8 +490,15 @@ BlobDataGrid* BlobDataGridFactory::createBlobDataGrid(Pix* image,
     }
   }
 
-  // Run noise filter
-  {
+  // Without recognized words the rows are typed from their layout instead
+  if(!recognize) {
+    findLayoutRows(blobDataGrid);
+  }
+
+  // Run noise filter (only on recognized pages since it removes the small
+  // blobs Tesseract didn't recognize, and without recognition that would be
+  // all of them)
+  if(recognize) {
     double averageBlobArea = 0;
     // Compute the average blob size
     {
@@ -400,6 +530,14 @@ BlobDataGrid* BlobDataGridFactory::createBlobDataGrid(Pix* image,
     }
   }
 
+  // Number the blobs that made it onto the final grid so feature extractors
+  // can keep their per-page data in columns indexed by blob
+  blobDataGrid->indexBlobs();
+  if(memoryStats != NULL) {
+    memoryStats->setBlobCount(blobDataGrid->getBlobCount());
+    memoryStats->setGridCellCount(blobDataGrid->getArea());
+    memoryStats->endStage("recognition_data");
+  }
 
   return blobDataGrid;
 }
@@ -419,7 +557,7 @@ char* BlobDataGridFactory::getRowValidTessWord(
     WERD_CHOICE* wordchoice = wordres->best_choice;
     if(wordchoice != NULL) {
       char* wrd = (char*)wordchoice->unichar_string().string();
-      if(api->IsValidWord(wrd)) {
+      if(WordClassificationCache::getInstance().isValidWord(api, wrd)) {
         return wrd;
       }
     }
@@ -428,6 +566,65 @@ char* BlobDataGridFactory::getRowValidTessWord(
   return NULL;
 }
 
+void BlobDataGridFactory::findLayoutRows(BlobDataGrid* const blobDataGrid) {
+  std::vector<TesseractBlockData*>& tesseractBlocks = blobDataGrid->getTesseractBlocks();
+  for(int i = 0; i < tesseractBlocks.size(); ++i) {
+    std::vector<TesseractRowData*>& rows = tesseractBlocks[i]->getTesseractRows();
+    if(rows.empty()) {
+      continue;
+    }
+    // find the block's left margin and its widest row
+    int blockLeft = rows[0]->getBoundingBox().left();
+    int maxWidth = 0;
+    for(int j = 0; j < rows.size(); ++j) {
+      const TBOX rowBox = rows[j]->getBoundingBox();
+      if(rowBox.left() < blockLeft) {
+        blockLeft = rowBox.left();
+      }
+      if(rowBox.width() > maxWidth) {
+        maxWidth = rowBox.width();
+      }
+    }
+    // displayed math tends to be set on narrow, indented or centered rows
+    for(int j = 0; j < rows.size(); ++j) {
+      TesseractRowData* const row = rows[j];
+      const TBOX rowBox = row->getBoundingBox();
+      const bool wide = ((double)rowBox.width()
+          >= LAYOUT_NORMAL_ROW_WIDTH_RATIO * (double)maxWidth);
+      const bool atMargin = (rowBox.left() - blockLeft
+          <= LAYOUT_ROW_MARGIN_TOLERANCE * rowBox.height());
+      row->setIsConsideredNormal(wide || atMargin);
+#ifdef DBG_ROW_CHARACTERISTICS
+      std::cout << "Layout row at " << rowBox.left() << "," << rowBox.bottom()
+                << " (width " << rowBox.width() << " of " << maxWidth
+                << ") is " << (row->getIsConsideredNormal() ? "normal" : "abnormal")
+                << std::endl;
+#endif
+    }
+  }
+
+  // Link each blob to the first row whose box holds the blob's center
+  std::vector<TesseractRowData*>& rows = blobDataGrid->getAllTessRows();
+  for(int i = 0; i < rows.size(); ++i) {
+    const TBOX rowBox = rows[i]->getBoundingBox();
+    BlobDataGridSearch bdgs(blobDataGrid);
+    bdgs.SetUniqueMode(true);
+    bdgs.StartRectSearch(rowBox);
+    BlobData* blob = NULL;
+    while((blob = bdgs.NextRectSearch()) != NULL) {
+      if(blob->getLayoutRow() != NULL) {
+        continue;
+      }
+      const TBOX& blobBox = blob->getBoundingBox();
+      const int centerX = (blobBox.left() + blobBox.right()) / 2;
+      const int centerY = (blobBox.bottom() + blobBox.top()) / 2;
+      if(rowBox.contains(ICOORD(centerX, centerY))) {
+        blob->setLayoutRow(rows[i]);
+      }
+    }
+  }
+}
+
 void BlobDataGridFactory::findAllRowCharacteristics(BlobDataGrid* const blobDataGrid) {
 
   // Put all of the rows from the blocks on the page onto a single vector
@@ -461,7 +658,8 @@ void BlobDataGridFactory::findAllRowCharacteristics(BlobDataGrid* const blobData
       if(!words[j]->wordstr()) {
         continue;
       }
-      if(blobDataGrid->getTessBaseAPI()->IsValidWord(words[j]->wordstr())) {
+      if(WordClassificationCache::getInstance().isValidWord(
+          blobDataGrid->getTessBaseAPI(), words[j]->wordstr())) {
         ++valid_words_cur_row;
       }
     }
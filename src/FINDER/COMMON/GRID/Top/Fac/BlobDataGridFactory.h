@@ -10,6 +10,9 @@
 
 #include <allheaders.h>
 #include <baseapi.h>
+#include <MemStats.h>
+#include <SpeckleFilter.h>
+#include <PictureFilter.h>
 #include <string>
 
 class BlobDataGrid;
@@ -22,6 +25,35 @@ class BlobData;
 class BlobDataGridFactory {
  public:
 
+  /**
+   * How much of Tesseract's results the grid is built from. Recognition
+   * (character classification, dictionary lookups and the blob choices saved
+   * along the way) is most of the time spent building a grid, so finders
+   * whose features and segmentation don't look at any recognized text can
+   * build their grids from Tesseract's layout analysis alone. Those grids
+   * still have the blocks and rows found by the layout analysis, but none of
+   * their blobs belong to a recognized character, word or sentence. Their
+   * rows are considered normal or not from the layout alone and each blob is
+   * linked to the row it lies in (see BlobData::getLayoutRow).
+   */
+  enum OcrLevel {
+    LAYOUT_ONLY,
+    FULL_RECOGNITION
+  };
+
+  /**
+   * Creates a factory that filters out speckle and pictures with the default
+   * settings (both filters are off by default)
+   */
+  BlobDataGridFactory();
+
+  /**
+   * Creates a factory that filters out speckle and pictures with the given
+   * settings
+   */
+  BlobDataGridFactory(const SpeckleFilterParams& speckleParams,
+      const PictureFilterParams& pictureParams=PictureFilterParams());
+
   /**
    * Runs Tesseract's recognition on the given image with auto page segmentation,
    * inserts the raw connected components of the image into the grid, finds the
@@ -29,10 +61,24 @@ class BlobDataGridFactory {
    * inserting them into their appropriate entry in the grid, and returns the
    * created grid. The grid created is owned by the caller who should delete its
    * memory when finished with it. The parameters passed into this factory are
-   * also owned by the caller.
+   * also owned by the caller. If memory stats are given then the memory used
+   * by the recognition, the blob grid, and the recognition data is recorded
+   * to them as separate stages along with the page's blob and grid cell counts.
+   * If only the layout is asked for then Tesseract's layout analysis is run
+   * in place of its recognition and the grid is only filled in down to the
+   * rows (see OcrLevel). Components found to be speckle or other noise
+   * (see SpeckleFilter) and those within photographs, halftones and other
+   * pictures (see PictureFilter) are left off of the grid entirely, which
+   * makes them non-math as far as the results are concerned. The picture
+   * components are erased from the image given to Tesseract as well. The
+   * boxes of the noise and of the picture regions are kept on the grid for
+   * auditing and the number of components filtered out each way is recorded
+   * to the memory stats if there are any.
    */
   BlobDataGrid* createBlobDataGrid(Pix* image,
-      tesseract::TessBaseAPI* tessBaseApi, const std::string imageName);
+      tesseract::TessBaseAPI* tessBaseApi, const std::string imageName,
+      PageMemoryStats* const memoryStats=NULL,
+      const OcrLevel ocrLevel=FULL_RECOGNITION);
 
  private:
 
@@ -48,6 +94,13 @@ class BlobDataGridFactory {
   // analysis.
   void findAllRowCharacteristics(BlobDataGrid* const blobDataGrid);
 
+  // Stands in for findAllRowCharacteristics on grids built from the layout
+  // alone. A row is considered "abnormal" if it is much narrower than the
+  // widest row on its block and starts away from the block's left margin
+  // (as displayed math tends to). Each blob is then linked to the layout row
+  // it lies in (see BlobData::getLayoutRow).
+  void findLayoutRows(BlobDataGrid* const blobDataGrid);
+
   void dbgDisplayHierarchy(
       TesseractBlockData* tesseractBlockData,
       TesseractRowData* tesseractRowData,
@@ -56,6 +109,9 @@ class BlobDataGridFactory {
       BlobData* blob, Pix* image);
 
   void deleteMarkedEntries(BlobDataGrid* const blobDataGrid);
+
+  SpeckleFilterParams speckleParams;
+  PictureFilterParams pictureParams;
 };
 
 
@@ -0,0 +1,165 @@
+/*
+ * PictureFilter.cpp
+ */
+
+#include <PictureFilter.h>
+
+#include <algorithm>
+#include <vector>
+
+// The smallest page Leptonica will make a halftone mask for
+#define HALFTONE_MASK_MIN_DIM 100
+
+PictureFilterParams::PictureFilterParams()
+    : enabled(PICTURE_FILTER_ENABLED),
+      minOverlap(PICTURE_MIN_OVERLAP),
+      reduceMinWidth(PICTURE_REDUCE_MIN_WIDTH),
+      minComponentsPerCell(PICTURE_MIN_COMPONENTS_PER_CELL),
+      minRegionCells(PICTURE_MIN_REGION_CELLS) {}
+
+PictureFilter::PictureFilter(const PictureFilterParams& params)
+    : params(params) {}
+
+int PictureFilter::findPictureComponents(Pix* const image, Boxa* const boxes,
+    const std::vector<bool>& skip, const int medianCharHeight,
+    std::vector<bool>* const inPicture, Boxa** const pictureRegions) {
+  inPicture->assign(boxes->n, false);
+  *pictureRegions = boxaCreate(0);
+  if(!params.enabled) {
+    return 0;
+  }
+
+  int halftoneScale = 1;
+  Pix* halftoneMask = getHalftoneMask(image, &halftoneScale);
+  const int cellSize = std::max(medianCharHeight, 1);
+  Pix* crowdedMask = (medianCharHeight > 0) ?
+      getCrowdedCellMask(image, boxes, skip, cellSize) : NULL;
+  if(halftoneMask == NULL && crowdedMask == NULL) {
+    return 0;
+  }
+  if(halftoneMask != NULL) {
+    addMaskRegions(halftoneMask, halftoneScale, *pictureRegions);
+  }
+  if(crowdedMask != NULL) {
+    addMaskRegions(crowdedMask, cellSize, *pictureRegions);
+  }
+
+  // Only the components that touch one of the regions need a closer look
+  int pictureCount = 0;
+  for(int i = 0; i < boxes->n; ++i) {
+    if(skip[i]) {
+      continue;
+    }
+    Box* const box = boxes->box[i];
+    for(int j = 0; j < (*pictureRegions)->n; ++j) {
+      l_int32 intersects = 0;
+      boxIntersects(box, (*pictureRegions)->box[j], &intersects);
+      if(!intersects) {
+        continue;
+      }
+      l_uint32 crowded = 0;
+      if(crowdedMask != NULL) {
+        pixGetPixel(crowdedMask, (box->x + box->w / 2) / cellSize,
+            (box->y + box->h / 2) / cellSize, &crowded);
+      }
+      if(crowded || (halftoneMask != NULL
+          && getMaskOverlap(halftoneMask, box, halftoneScale) >= params.minOverlap)) {
+        (*inPicture)[i] = true;
+        ++pictureCount;
+      }
+      break;
+    }
+  }
+  pixDestroy(&halftoneMask);
+  pixDestroy(&crowdedMask);
+  return pictureCount;
+}
+
+Pix* PictureFilter::getHalftoneMask(Pix* const image, int* const scale) {
+  *scale = (image->w >= params.reduceMinWidth) ? 2 : 1;
+  Pix* reduced = (*scale == 2) ?
+      pixReduceRankBinary2(image, 1, NULL) : pixClone(image);
+  if(reduced->w < HALFTONE_MASK_MIN_DIM || reduced->h < HALFTONE_MASK_MIN_DIM) {
+    pixDestroy(&reduced);
+    return NULL;
+  }
+  l_int32 found = 0;
+  Pix* mask = pixGenHalftoneMask(reduced, NULL, &found, 0);
+  pixDestroy(&reduced);
+  if(!found) {
+    pixDestroy(&mask);
+  }
+  return mask;
+}
+
+Pix* PictureFilter::getCrowdedCellMask(Pix* const image, Boxa* const boxes,
+    const std::vector<bool>& skip, const int cellSize) {
+  const int cellsWide = (image->w + cellSize - 1) / cellSize;
+  const int cellsTall = (image->h + cellSize - 1) / cellSize;
+  std::vector<int> counts(cellsWide * cellsTall, 0);
+  for(int i = 0; i < boxes->n; ++i) {
+    if(skip[i]) {
+      continue;
+    }
+    const Box* const box = boxes->box[i];
+    const int cellx = (box->x + box->w / 2) / cellSize;
+    const int celly = (box->y + box->h / 2) / cellSize;
+    ++counts[celly * cellsWide + cellx];
+  }
+  Pix* crowded = pixCreate(cellsWide, cellsTall, 1);
+  bool any = false;
+  for(int y = 0; y < cellsTall; ++y) {
+    for(int x = 0; x < cellsWide; ++x) {
+      if(counts[y * cellsWide + x] > params.minComponentsPerCell) {
+        pixSetPixel(crowded, x, y, 1);
+        any = true;
+      }
+    }
+  }
+  if(!any) {
+    pixDestroy(&crowded);
+    return NULL;
+  }
+  // Fill in the odd cell within a picture that's a little less crowded than
+  // the rest, then drop whatever's too small to be a picture (i.e., a few
+  // crowded cells of dense subscripts in a formula)
+  Pix* closed = pixCloseSafeBrick(NULL, crowded, 3, 3);
+  pixDestroy(&crowded);
+  Pix* mask = pixSelectBySize(closed, params.minRegionCells,
+      params.minRegionCells, 8, L_SELECT_IF_BOTH, L_SELECT_IF_GTE, NULL);
+  pixDestroy(&closed);
+  l_int32 empty = 1;
+  pixZero(mask, &empty);
+  if(empty) {
+    pixDestroy(&mask);
+  }
+  return mask;
+}
+
+double PictureFilter::getMaskOverlap(Pix* const mask, const Box* const box,
+    const int scale) {
+  // round outwards so even a one pixel component covers part of the mask
+  const int left = box->x / scale;
+  const int top = box->y / scale;
+  const int right = std::min((box->x + box->w + scale - 1) / scale, (int)mask->w);
+  const int bottom = std::min((box->y + box->h + scale - 1) / scale, (int)mask->h);
+  if(right <= left || bottom <= top) {
+    return 0;
+  }
+  Box* maskBox = boxCreate(left, top, right - left, bottom - top);
+  Pix* clipped = pixClipRectangle(mask, maskBox, NULL);
+  l_int32 underMask = 0;
+  pixCountPixels(clipped, &underMask, NULL);
+  pixDestroy(&clipped);
+  boxDestroy(&maskBox);
+  return (double)underMask / ((right - left) * (bottom - top));
+}
+
+void PictureFilter::addMaskRegions(Pix* const mask, const int scale,
+    Boxa* const regions) {
+  Boxa* maskRegions = pixConnComp(mask, NULL, 8);
+  Boxa* scaled = boxaTransform(maskRegions, 0, 0, scale, scale);
+  boxaJoin(regions, scaled, 0, -1);
+  boxaDestroy(&scaled);
+  boxaDestroy(&maskRegions);
+}
@@ -0,0 +1,94 @@
+/*
+ * PictureFilter.h
+ */
+
+#ifndef PICTUREFILTER_H_
+#define PICTUREFILTER_H_
+
+#include <allheaders.h>
+
+#include <vector>
+
+// Defaults for the picture filter's parameters. The filter is off unless it's
+// turned on for the finder (see FinderInfo::isPictureFilterEnabled) since it
+// changes the grids the finder's features are extracted from.
+#define PICTURE_FILTER_ENABLED false
+#define PICTURE_MIN_OVERLAP 0.5 // fraction of a component's box that has to be under the halftone mask
+#define PICTURE_REDUCE_MIN_WIDTH 2000 // pages at least this wide (i.e., 300 dpi scans) are halved first
+#define PICTURE_MIN_COMPONENTS_PER_CELL 10 // a cell the size of a character with more components than this is crowded
+#define PICTURE_MIN_REGION_CELLS 3 // crowded regions have to be at least this many cells wide and tall
+
+/**
+ * Settings for the picture filter. The defaults are the #defines above.
+ */
+struct PictureFilterParams {
+  PictureFilterParams();
+
+  bool enabled;
+
+  // Leptonica's halftone mask is tuned for pages at 150 to 200 dpi, so
+  // wider pages are reduced by half before it's made
+  double minOverlap;
+  int reduceMinWidth;
+
+  // The page is split into square cells as tall as its median character,
+  // none of which ever has more than a few characters in it. A large
+  // enough region of cells crowded with components is taken as a picture.
+  int minComponentsPerCell;
+  int minRegionCells;
+};
+
+/**
+ * Finds the photographs, halftones and other picture regions on a page and
+ * picks out the connected components that lie within them. A single picture
+ * can break up into thousands of components, none of which are math, so
+ * they're kept off of the grid rather than having their features extracted
+ * and being run through the detector one by one. A picture is found in
+ * either of two ways:
+ *  - Leptonica's halftone mask, which finds dark and densely filled
+ *    pictures but misses the lighter dot patterns of a halftone
+ *  - a region crowded with far more components than text ever has, which
+ *    is what those dot patterns (and the cost of them) come down to
+ */
+class PictureFilter {
+ public:
+
+  PictureFilter(const PictureFilterParams& params);
+
+  /**
+   * Sets inPicture[i] to whether the i'th component (with the given box from
+   * pixConnComp on the image) lies within a picture region and returns how
+   * many of them do. Components with skip[i] set (i.e., noise) are neither
+   * counted nor marked. The median character height is the one found by
+   * the SpeckleFilter. The boxes of the picture regions found are returned
+   * in the image's coordinates and are owned by the caller. Nothing is found
+   * if the filter is disabled.
+   */
+  int findPictureComponents(Pix* const image, Boxa* const boxes,
+      const std::vector<bool>& skip, const int medianCharHeight,
+      std::vector<bool>* const inPicture, Boxa** const pictureRegions);
+
+ private:
+
+  // Returns the halftone mask for the image (NULL if no halftones were found)
+  // and sets the scale it was made at
+  Pix* getHalftoneMask(Pix* const image, int* const scale);
+
+  // Returns a mask with one pixel per cell of the given size that's set
+  // where the cell is part of a crowded region (NULL if there aren't any)
+  Pix* getCrowdedCellMask(Pix* const image, Boxa* const boxes,
+      const std::vector<bool>& skip, const int cellSize);
+
+  // Fraction of the component's box (scaled down to the mask) under the mask
+  static double getMaskOverlap(Pix* const mask, const Box* const box,
+      const int scale);
+
+  // Adds the boxes of the mask's regions (scaled up to the image) to the list
+  static void addMaskRegions(Pix* const mask, const int scale,
+      Boxa* const regions);
+
+  PictureFilterParams params;
+};
+
+
+#endif /* PICTUREFILTER_H_ */
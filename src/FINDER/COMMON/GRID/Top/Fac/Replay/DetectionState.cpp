@@ -0,0 +1,361 @@
+/*
+ * DetectionState.cpp
+ */
+
+#include <DetectionState.h>
+
+#include <BlobDataGrid.h>
+#include <BlobData.h>
+#include <BlockData.h>
+#include <RowData.h>
+#include <WordData.h>
+#include <CharData.h>
+#include <Utils.h>
+
+#include <baseapi.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <assert.h>
+#include <stdlib.h>
+
+// The file starts with the page (its size, the grid's cell size and its
+// name) followed by a section for each of the rows, words, characters and
+// blobs. Each section starts with its name and how many lines it has. Each
+// word refers to its row, each character to its word and each blob to its
+// character (or -1 if it isn't part of one) by its line number (from 0) in
+// the section before it. Each blob also refers to the row it lies in from
+// Tesseract's layout analysis (or -1 if it has none, as on recognized pages):
+//   page <width> <height> <gridsize> <name>
+//   recognized <whether recognition was run>
+//   rows <count>
+//   <normal>
+//   words <count>
+//   <row> <left> <bottom> <right> <top> <certainty> <valid> <math word> <stopword>
+//   chars <count>
+//   <word> <left> <bottom> <right> <top> <certainty> <unicode>
+//   blobs <count>
+//   <char> <left> <bottom> <right> <top> <detected as math> <detection score> <layout row>
+// A certainty Tesseract didn't give (or a detection score the detector didn't
+// give) is written as "none".
+#define NO_VALUE "none"
+
+static void writeBox(std::ostream& stream, const TBOX& box) {
+  stream << box.left() << " " << box.bottom() << " " << box.right() << " "
+      << box.top();
+}
+
+static void writeOptional(std::ostream& stream, const bool known,
+    const double value) {
+  if(known) {
+    stream << value;
+  } else {
+    stream << NO_VALUE;
+  }
+}
+
+DetectionState::DetectionState() : blobDataGrid(NULL) {}
+
+void DetectionState::write(BlobDataGrid* const blobDataGrid,
+    const std::string& path) {
+  std::ofstream stream(path.c_str());
+  if(!stream.is_open()) {
+    std::cout << "ERROR: Could not open " << path << " to save the detection state to\n";
+    assert(false);
+  }
+  // enough digits for the certainties and scores to be read back in exactly
+  stream << std::setprecision(17);
+
+  // number the rows, words and characters in the order the grid has them,
+  // keeping track of which row or word each one is under
+  std::vector<TesseractRowData*>& rows = blobDataGrid->getAllTessRows();
+  std::vector<TesseractWordData*> words;
+  std::vector<int> wordRows;
+  std::vector<TesseractCharData*> chars;
+  std::vector<int> charWords;
+  std::map<TesseractCharData*, int> charIndices;
+  std::map<TesseractRowData*, int> rowIndices;
+  for(int i = 0; i < rows.size(); ++i) {
+    rowIndices[rows[i]] = i;
+    GenericVector<TesseractWordData*>& rowWords = rows[i]->getTesseractWords();
+    for(int j = 0; j < rowWords.size(); ++j) {
+      if(rowWords[j] == NULL) {
+        continue;
+      }
+      std::vector<TesseractCharData*>& wordChars = rowWords[j]->getTesseractChars();
+      for(int k = 0; k < wordChars.size(); ++k) {
+        charIndices[wordChars[k]] = chars.size();
+        chars.push_back(wordChars[k]);
+        charWords.push_back(words.size());
+      }
+      words.push_back(rowWords[j]);
+      wordRows.push_back(i);
+    }
+  }
+
+  stream << "page " << blobDataGrid->tright().x() << " "
+      << blobDataGrid->tright().y() << " " << blobDataGrid->gridsize() << " "
+      << blobDataGrid->getImageName() << "\n";
+  stream << "recognized " << blobDataGrid->hasRecognitionResults() << "\n";
+
+  stream << "rows " << rows.size() << "\n";
+  for(int i = 0; i < rows.size(); ++i) {
+    stream << rows[i]->getIsConsideredNormal() << "\n";
+  }
+
+  stream << "words " << words.size() << "\n";
+  for(int i = 0; i < words.size(); ++i) {
+    TesseractWordData* const word = words[i];
+    stream << wordRows[i] << " ";
+    writeBox(stream, word->getBoundingBox());
+    stream << " ";
+    writeOptional(stream, word->bestchoice() != NULL,
+        (word->bestchoice() != NULL) ? word->bestchoice()->certainty() : 0);
+    stream << " " << word->getIsValidTessWord() << " "
+        << word->getResultMatchesMathWord() << " "
+        << word->getResultMatchesStopword() << "\n";
+  }
+
+  stream << "chars " << chars.size() << "\n";
+  for(int i = 0; i < chars.size(); ++i) {
+    TesseractCharData* const charData = chars[i];
+    stream << charWords[i] << " ";
+    writeBox(stream, *charData->getBoundingBox());
+    stream << " ";
+    writeOptional(stream, charData->getCharResultInfo() != NULL,
+        (charData->getCharResultInfo() != NULL) ?
+            charData->getCharResultInfo()->certainty() : 0);
+    stream << " " << charData->getUnicode() << "\n";
+  }
+
+  // the blobs are written in the order the grid gives them in so that they
+  // can be put back on it in the same order
+  stream << "blobs " << blobDataGrid->getBlobCount() << "\n";
+  BlobDataGridSearch search(blobDataGrid);
+  search.SetUniqueMode(true);
+  search.StartFullSearch();
+  BlobData* blob = NULL;
+  int blobCount = 0;
+  while((blob = search.NextFullSearch()) != NULL) {
+    std::map<TesseractCharData*, int>::const_iterator charIndex =
+        charIndices.find(blob->getParentChar());
+    stream << ((charIndex != charIndices.end()) ? charIndex->second : -1) << " ";
+    writeBox(stream, blob->getBoundingBox());
+    stream << " " << blob->getMathExpressionDetectionResult() << " ";
+    writeOptional(stream, blob->hasMathExpressionDetectionScore(),
+        blob->getMathExpressionDetectionScore());
+    std::map<TesseractRowData*, int>::const_iterator layoutRow =
+        rowIndices.find(blob->getLayoutRow());
+    stream << " " << ((layoutRow != rowIndices.end()) ? layoutRow->second : -1)
+        << "\n";
+    ++blobCount;
+  }
+  assert(blobCount == blobDataGrid->getBlobCount());
+}
+
+std::string DetectionState::getPath(const std::string& dirName,
+    const std::string& imageName) {
+  return Utils::checkTrailingSlash(dirName) + imageName + DETECTION_STATE_EXT;
+}
+
+// Reads in the name of a section and how many lines it has
+static bool readSectionStart(std::istream& stream, const std::string& section,
+    int* const count) {
+  std::string name;
+  return (stream >> name >> *count) && name == section && *count >= 0;
+}
+
+static bool readBox(std::istream& stream, TBOX* const box) {
+  int left, bottom, right, top;
+  if(!(stream >> left >> bottom >> right >> top)) {
+    return false;
+  }
+  *box = TBOX(left, bottom, right, top);
+  return true;
+}
+
+static bool readOptional(std::istream& stream, bool* const known,
+    double* const value) {
+  std::string token;
+  if(!(stream >> token)) {
+    return false;
+  }
+  *known = (token != NO_VALUE);
+  *value = *known ? atof(token.c_str()) : 0;
+  return true;
+}
+
+// Reads the rest of the line, leaving out the space separating it from
+// what came before
+static std::string readRestOfLine(std::istream& stream) {
+  std::string rest;
+  std::getline(stream, rest);
+  if(!rest.empty() && rest[0] == ' ') {
+    rest.erase(0, 1);
+  }
+  return rest;
+}
+
+BlobDataGrid* DetectionState::read(const std::string& path, Pix* const image) {
+  assert(blobDataGrid == NULL);
+  std::ifstream stream(path.c_str());
+  if(!stream.is_open()) {
+    std::cout << "ERROR: Could not open the detection state saved at " << path
+        << ". It has to have been saved by running with --save-detection first.\n";
+    assert(false);
+    return NULL;
+  }
+  bool ok = true;
+
+  std::string section;
+  int width = 0, height = 0, gridsize = 0;
+  ok = (stream >> section >> width >> height >> gridsize) && section == "page";
+  const std::string imageName = readRestOfLine(stream);
+  int recognized = 1;
+  ok = ok && (stream >> section >> recognized) && section == "recognized";
+  if(ok && (width != pixGetWidth(image) || height != pixGetHeight(image))) {
+    std::cout << "ERROR: The detection state at " << path << " was saved from a "
+        << width << "x" << height << " page, but the page it's being replayed on is "
+        << pixGetWidth(image) << "x" << pixGetHeight(image) << ". If it was saved "
+        << "with --dpi then the same --dpi has to be given when replaying it.\n";
+    assert(false);
+    return NULL;
+  }
+  if(ok) {
+    blobDataGrid = new BlobDataGrid(gridsize, ICOORD(0, 0),
+        ICOORD(width, height), NULL, image, imageName);
+    blobDataGrid->setBinaryImage(pixClone(image));
+    blobDataGrid->setHasRecognitionResults(recognized != 0);
+  }
+
+  // the rows all go in a single block, which the grid deletes along with
+  // the words and characters under it
+  TesseractBlockData* block = NULL;
+  std::vector<TesseractRowData*> rows;
+  int count = 0;
+  if(ok && (ok = readSectionStart(stream, "rows", &count))) {
+    block = new TesseractBlockData(NULL, blobDataGrid);
+    blobDataGrid->getTesseractBlocks().push_back(block);
+  }
+  for(int i = 0; ok && i < count; ++i) {
+    int normal = 0;
+    if(!(ok = (bool)(stream >> normal))) {
+      break;
+    }
+    TesseractRowData* const row = new TesseractRowData(NULL, block);
+    row->rowIndex = i;
+    row->setIsConsideredNormal(normal != 0);
+    block->getTesseractRows().push_back(row);
+    blobDataGrid->getAllTessRows().push_back(row);
+    rows.push_back(row);
+  }
+
+  std::vector<TesseractWordData*> words;
+  ok = ok && readSectionStart(stream, "words", &count);
+  for(int i = 0; ok && i < count; ++i) {
+    int rowIndex = -1;
+    TBOX box;
+    bool known = false;
+    double certainty = 0;
+    int valid = 0, mathWord = 0, stopword = 0;
+    if(!(ok = (stream >> rowIndex) && readBox(stream, &box)
+        && readOptional(stream, &known, &certainty)
+        && (stream >> valid >> mathWord >> stopword)
+        && rowIndex >= 0 && rowIndex < rows.size())) {
+      break;
+    }
+    WERD_RES* wordRes = NULL;
+    if(known) {
+      // the word result deletes its best choice
+      wordRes = new WERD_RES();
+      wordRes->best_choice = new WERD_CHOICE(&unicharset);
+      wordRes->best_choice->set_certainty(certainty);
+      wordResults.push_back(wordRes);
+    }
+    TesseractWordData* const word =
+        new TesseractWordData(box, wordRes, rows[rowIndex]);
+    word->setIsValidTessWord(valid != 0);
+    word->setResultMatchesMathWord(mathWord != 0);
+    word->setResultMatchesStopword(stopword != 0);
+    rows[rowIndex]->getTesseractWords().push_back(word);
+    words.push_back(word);
+  }
+
+  std::vector<TesseractCharData*> chars;
+  ok = ok && readSectionStart(stream, "chars", &count);
+  for(int i = 0; ok && i < count; ++i) {
+    int wordIndex = -1;
+    TBOX box;
+    bool known = false;
+    double certainty = 0;
+    if(!(ok = (stream >> wordIndex) && readBox(stream, &box)
+        && readOptional(stream, &known, &certainty)
+        && wordIndex >= 0 && wordIndex < words.size())) {
+      break;
+    }
+    TesseractCharData* const charData =
+        new TesseractCharData(box, words[wordIndex]);
+    charData->setRecognitionResultUnicode(readRestOfLine(stream));
+    if(known) {
+      BLOB_CHOICE* const charChoice = new BLOB_CHOICE();
+      charChoice->set_certainty(certainty);
+      charChoices.push_back(charChoice);
+      charData->setCharResultInfo(charChoice);
+    }
+    words[wordIndex]->getTesseractChars().push_back(charData);
+    chars.push_back(charData);
+  }
+
+  ok = ok && readSectionStart(stream, "blobs", &count);
+  for(int i = 0; ok && i < count; ++i) {
+    int charIndex = -1;
+    TBOX box;
+    int detected = 0;
+    bool scoreKnown = false;
+    double score = 0;
+    int layoutRow = -1;
+    if(!(ok = (stream >> charIndex) && readBox(stream, &box)
+        && (stream >> detected) && readOptional(stream, &scoreKnown, &score)
+        && (stream >> layoutRow)
+        && charIndex >= -1 && charIndex < chars.size()
+        && layoutRow >= -1 && layoutRow < rows.size())) {
+      break;
+    }
+    BlobData* const blob = new BlobData(box, NULL, blobDataGrid);
+    if(charIndex >= 0) {
+      blob->setCharacterRecognitionData(chars[charIndex]);
+      chars[charIndex]->getBlobs().push_back(blob);
+    }
+    if(layoutRow >= 0) {
+      blob->setLayoutRow(rows[layoutRow]);
+    }
+    blob->setMathExpressionDetectionResult(detected != 0);
+    if(scoreKnown) {
+      blob->setMathExpressionDetectionScore(score);
+    }
+    blobDataGrid->InsertBBox(true, true, blob);
+  }
+
+  if(!ok) {
+    std::cout << "ERROR: " << path << " isn't a valid detection state file.\n";
+    assert(false);
+    return NULL;
+  }
+  blobDataGrid->indexBlobs();
+  return blobDataGrid;
+}
+
+DetectionState::~DetectionState() {
+  // the grid goes first since its blobs and words refer to the stand-ins
+  delete blobDataGrid;
+  for(int i = 0; i < wordResults.size(); ++i) {
+    delete wordResults[i];
+  }
+  for(int i = 0; i < charChoices.size(); ++i) {
+    delete charChoices[i];
+  }
+}
@@ -0,0 +1,86 @@
+/*
+ * DetectionState.h
+ */
+
+#ifndef DETECTIONSTATE_H_
+#define DETECTIONSTATE_H_
+
+#include <allheaders.h>
+#include <baseapi.h>
+#include <ratngs.h>
+#include <pageres.h>
+#include <unicharset.h>
+
+#include <string>
+#include <vector>
+
+class BlobDataGrid;
+
+// Extension of the files a page's detection state is saved to
+#define DETECTION_STATE_EXT ".detstate"
+
+/**
+ * Saves everything the segmentor looks at on a page once detection is done
+ * so that segmentation can be replayed on it later without running Tesseract,
+ * the feature extractors or the detector again. That's each blob's box,
+ * detection result and raw detection score (if the detector gave it one, so
+ * the blobs can be detected again at another threshold) along with the rows,
+ * words and characters Tesseract recognized: whether each row is normal text,
+ * whether each word is valid, a math word or a stopword, and Tesseract's
+ * certainty in each word and character (and whether recognition was run on
+ * the page at all, along with the layout row each blob lies in when it
+ * wasn't). The file is plain text with one line per row, word, character and
+ * blob.
+ *
+ * A grid read back in has no Tesseract api behind it. Its recognition results
+ * are stand-ins holding just the certainties, so it can be segmented and have
+ * its results drawn but nothing else. The stand-ins and the grid are owned by
+ * the DetectionState they were read in by, which has to outlive the grid.
+ */
+class DetectionState {
+ public:
+
+  DetectionState();
+
+  /**
+   * Deletes the grid that was read in along with the recognition results
+   * standing in for Tesseract's
+   */
+  ~DetectionState();
+
+  /**
+   * Writes the detection state of the grid (which has to have been indexed
+   * and run through detection) to the given file
+   */
+  static void write(BlobDataGrid* const blobDataGrid, const std::string& path);
+
+  /**
+   * Gets the path a page's detection state is saved to in the given directory
+   */
+  static std::string getPath(const std::string& dirName,
+      const std::string& imageName);
+
+  /**
+   * Reads in the detection state saved at the given path and rebuilds the
+   * page's grid on the given image, which has to be the same (binarized)
+   * image the grid was originally built on. The blobs are put back on the
+   * grid in the same order they were originally found in so that the
+   * segmentor goes through them in the same order as before. Only one grid
+   * can be read in by each DetectionState.
+   */
+  BlobDataGrid* read(const std::string& path, Pix* const image);
+
+ private:
+
+  BlobDataGrid* blobDataGrid;
+
+  // the (empty) character set the stand-in word choices refer to
+  UNICHARSET unicharset;
+
+  // stand-ins for Tesseract's character and word results
+  std::vector<BLOB_CHOICE*> charChoices;
+  std::vector<WERD_RES*> wordResults;
+};
+
+
+#endif /* DETECTIONSTATE_H_ */
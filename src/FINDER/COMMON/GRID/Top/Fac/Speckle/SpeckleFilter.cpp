@@ -0,0 +1,87 @@
+/*
+ * SpeckleFilter.cpp
+ */
+
+#include <SpeckleFilter.h>
+
+#include <algorithm>
+#include <vector>
+#include <assert.h>
+
+SpeckleFilterParams::SpeckleFilterParams()
+    : enabled(SPECKLE_FILTER_ENABLED),
+      sizeFraction(SPECKLE_SIZE_FRACTION),
+      sparseSizeFraction(SPECKLE_SPARSE_SIZE_FRACTION),
+      minSparseDensity(SPECKLE_MIN_SPARSE_DENSITY),
+      minCharDim(SPECKLE_MIN_CHAR_DIM),
+      cleanOcrImage(SPECKLE_CLEAN_OCR_IMAGE) {}
+
+SpeckleFilter::SpeckleFilter(const SpeckleFilterParams& params)
+    : params(params), medianCharHeight(0) {}
+
+int SpeckleFilter::findNoise(Boxa* const boxes, Pixa* const images,
+    std::vector<bool>* const isNoise) {
+  assert(boxes->n == images->n);
+  isNoise->assign(boxes->n, false);
+  medianCharHeight = findMedianCharHeight(boxes);
+  if(!params.enabled || medianCharHeight == 0) {
+    return 0;
+  }
+  const double sizeThresh = params.sizeFraction * medianCharHeight;
+  const double sparseSizeThresh = params.sparseSizeFraction * medianCharHeight;
+  int noiseCount = 0;
+  for(int i = 0; i < boxes->n; ++i) {
+    const Box* const box = boxes->box[i];
+    const int size = std::max(box->w, box->h);
+    bool noise = false;
+    if(size < sizeThresh) {
+      noise = true;
+    } else if(size < sparseSizeThresh) {
+      // only the small components have their pixels counted
+      l_int32 foreground = 0;
+      pixCountPixels(images->pix[i], &foreground, NULL);
+      noise = ((double)foreground / (box->w * box->h)) < params.minSparseDensity;
+    }
+    if(noise) {
+      (*isNoise)[i] = true;
+      ++noiseCount;
+    }
+  }
+  return noiseCount;
+}
+
+int SpeckleFilter::getMedianCharHeight() {
+  return medianCharHeight;
+}
+
+// The speckle itself is left out so that a very dirty page doesn't drag the
+// median down with it
+int SpeckleFilter::findMedianCharHeight(Boxa* const boxes) {
+  std::vector<int> heights;
+  for(int i = 0; i < boxes->n; ++i) {
+    const Box* const box = boxes->box[i];
+    if(box->w >= params.minCharDim && box->h >= params.minCharDim) {
+      heights.push_back(box->h);
+    }
+  }
+  if(heights.empty()) {
+    return 0;
+  }
+  std::vector<int>::iterator median = heights.begin() + heights.size() / 2;
+  std::nth_element(heights.begin(), median, heights.end());
+  return *median;
+}
+
+Pix* SpeckleFilter::getCleanedImage(Pix* const image, Boxa* const boxes,
+    Pixa* const images, const std::vector<bool>& isErased) {
+  Pix* const cleaned = pixCopy(NULL, image);
+  for(int i = 0; i < isErased.size(); ++i) {
+    if(isErased[i]) {
+      // clear just the component's own pixels, not everything in its box
+      const Box* const box = boxes->box[i];
+      pixRasterop(cleaned, box->x, box->y, box->w, box->h,
+          PIX_DST & PIX_NOT(PIX_SRC), images->pix[i], 0, 0);
+    }
+  }
+  return cleaned;
+}
@@ -0,0 +1,88 @@
+/*
+ * SpeckleFilter.h
+ */
+
+#ifndef SPECKLEFILTER_H_
+#define SPECKLEFILTER_H_
+
+#include <allheaders.h>
+
+#include <vector>
+
+// Defaults for the speckle filter's parameters. The size thresholds are
+// fractions of the page's median character height. The filter is off unless
+// it's turned on for the finder (see FinderInfo::isSpeckleFilterEnabled)
+// since it changes the grids the finder's features are extracted from.
+#define SPECKLE_FILTER_ENABLED false
+#define SPECKLE_SIZE_FRACTION 0.1 // anything smaller than this on both sides is noise
+#define SPECKLE_SPARSE_SIZE_FRACTION 0.3 // anything smaller than this on both sides...
+#define SPECKLE_MIN_SPARSE_DENSITY 0.25 // ...is noise if less of its box than this is foreground
+#define SPECKLE_MIN_CHAR_DIM 4 // components smaller than this (in pixels) aren't counted as characters for the median
+#define SPECKLE_CLEAN_OCR_IMAGE false
+
+/**
+ * Settings for the speckle filter. The defaults are the #defines above.
+ */
+struct SpeckleFilterParams {
+  SpeckleFilterParams();
+
+  bool enabled;
+  double sizeFraction;
+  double sparseSizeFraction;
+  double minSparseDensity;
+  int minCharDim;
+
+  // If true then the noise is also erased from the image Tesseract is given
+  // so its layout analysis and recognition don't see it either. This is like
+  // an opening by reconstruction that only takes out whole components, so
+  // unlike a plain morphological opening it can't thin or break the strokes
+  // of the characters that are kept.
+  bool cleanOcrImage;
+};
+
+/**
+ * Picks out the dust and scanner speckle among a page's connected components
+ * so that it can be left off of the grid rather than going through every
+ * feature extractor and the detector as blobs of its own. A component is
+ * taken as noise if it's tiny compared to the page's median character height
+ * or if it's small and mostly empty (i.e., a stray hairline or a scattered
+ * clump of dots). Periods, dots on i's and other small marks are solid enough
+ * to be kept.
+ */
+class SpeckleFilter {
+ public:
+
+  SpeckleFilter(const SpeckleFilterParams& params);
+
+  /**
+   * Sets isNoise[i] to whether the i'th component is noise and returns how
+   * many of them are. The boxes and images are the ones given by pixConnComp
+   * and are left as they are. Nothing is filtered if the filter is disabled.
+   */
+  int findNoise(Boxa* const boxes, Pixa* const images,
+      std::vector<bool>* const isNoise);
+
+  /**
+   * Median height of the components counted as characters by the last call
+   * to findNoise (0 if there weren't any)
+   */
+  int getMedianCharHeight();
+
+  /**
+   * Returns a copy of the image with the marked components (i.e., the ones
+   * found to be noise or to lie within a picture) erased from it. The copy is
+   * owned by the caller.
+   */
+  static Pix* getCleanedImage(Pix* const image, Boxa* const boxes,
+      Pixa* const images, const std::vector<bool>& isErased);
+
+ private:
+
+  int findMedianCharHeight(Boxa* const boxes);
+
+  SpeckleFilterParams params;
+  int medianCharHeight;
+};
+
+
+#endif /* SPECKLEFILTER_H_ */
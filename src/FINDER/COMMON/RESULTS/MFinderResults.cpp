@@ -13,12 +13,21 @@
 
 #include <BlobMergeData.h>
 #include <M_Utils.h>
+#include <Lept_Utils.h>
 #include <Utils.h>
 
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
 #include <string>
 #include <iostream>
 #include <vector>
+#include <limits.h>
+#include <math.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <assert.h>
 
 /**
  * Constructor (only invoked by builder)
@@ -90,16 +99,77 @@ void MathExpressionFinderResults::displaySegmentationResults() {
   M_Utils::waitForInput();
 }
 
+void MathExpressionFinderResults::releaseVisualResults() {
+  pixDestroy(&visualResultsDisplay);
+  pixDestroy(&visualResultsEvalDisplay);
+}
+
+void MathExpressionFinderResults::mapToOriginalImage(Pix* const originalImage,
+    const double scale) {
+  const int scaledHeight = pixGetHeight(visualResultsDisplay);
+  const int width = pixGetWidth(originalImage);
+  const int height = pixGetHeight(originalImage);
+  for(int i = 0; i < segmentationResults.length(); ++i) {
+    // flip to image coordinates (origin at the top) on the scaled page, scale
+    // up rounding outwards, and flip back on the original page
+    TBOX* const box = segmentationResults[i]->box;
+    const int left = std::max((int)floor(box->left() / scale), 0);
+    const int right = std::min((int)ceil(box->right() / scale), width);
+    const int top = std::max((int)floor((scaledHeight - box->top()) / scale), 0);
+    const int bottom = std::min(
+        (int)ceil((scaledHeight - box->bottom()) / scale), height);
+    *box = TBOX(left, height - bottom, right, height - top);
+  }
+  pixDestroy(&visualResultsDisplay);
+  pixDestroy(&visualResultsEvalDisplay);
+  visualResultsDisplay = drawResults(originalImage, true);
+  visualResultsEvalDisplay = drawResults(originalImage, false);
+}
+
+Pix* MathExpressionFinderResults::drawResults(Pix* const image,
+    const bool drawBox) {
+  Pix* display = pixConvertTo32(image);
+  for(int i = 0; i < segmentationResults.length(); ++i) {
+    const Segmentation* seg = segmentationResults[i];
+    BOX* bbox = M_Utils::tessTBoxToImBox(seg->box, display);
+    const LayoutEval::Color color = (seg->res == DISPLAYED) ? LayoutEval::RED
+        : (seg->res == EMBEDDED) ? LayoutEval::BLUE : LayoutEval::GREEN;
+    M_Utils::drawHlBoxRegion(bbox, display, color);
+    if(drawBox) {
+      Lept_Utils::drawBox(display, bbox, color, (runMode == FIND) ? 10 : 7);
+    }
+    boxDestroy(&bbox);
+  }
+  return display;
+}
+
+std::string MathExpressionFinderResults::getResultsRectLines() {
+  std::stringstream rectLines;
+  for(int j = 0; j < segmentationResults.length(); ++j) {
+    const Segmentation* seg = segmentationResults[j];
+    BOX* bbox = M_Utils::tessTBoxToImBox(seg->box, visualResultsDisplay);
+    const RESULT_TYPE restype = seg->res;
+    rectLines << resultsName << " " <<
+        ((restype == DISPLAYED) ? "displayed" : (restype == EMBEDDED)
+            ? "embedded" : "label") << " " << bbox->x << " " << bbox->y
+            << " " << bbox->x + bbox->w << " " << bbox->y + bbox->h << std::endl;
+    boxDestroy(&bbox);
+  }
+  return rectLines.str();
+}
+
 void MathExpressionFinderResults::printResultsToFiles(
     const std::vector<MathExpressionFinderResults*>& results,
-    const std::string& resultsDirPath_) {
-
-  // Clear existing results directory and make new one to put results in
-  if(Utils::existsDirectory(resultsDirPath_)) {
-    Utils::exec("rm -rf " + resultsDirPath_, true);
+    const std::string& resultsDirPath_,
+    const bool writeImages) {
+
+  // Make the results directory if it isn't there yet. Nothing already in it
+  // gets removed here since a pipelined run has already written its images
+  // to it, the directory is cleared out before the run (see clearResultsDir).
+  if(!Utils::existsDirectory(resultsDirPath_)) {
+    Utils::exec("mkdir -p " + resultsDirPath_, true);
+    std::cout << "Creating results directory at " << resultsDirPath_ << std::endl;
   }
-  Utils::exec("mkdir " + resultsDirPath_, true);
-  std::cout << "Creating results directory at " << resultsDirPath_ << std::endl;
 
   const std::string resultsDirPath = Utils::checkTrailingSlash(resultsDirPath_);
   const std::string rectfile = resultsDirPath + std::string("results.rect");
@@ -111,34 +181,16 @@ void MathExpressionFinderResults::printResultsToFiles(
 
     MathExpressionFinderResults* const imageResults = results[i];
 
-    const std::string imgname = resultsDirPath + imageResults->getResultsName();
-
     // make sure no duplicate regions in segmentation results (sanity check)
     imageResults->ensureNoDuplicates();
 
     // print the segmentation results to the rect file
-    GenericVector<Segmentation*> segmentationResults = imageResults->getSegmentationResults();
-    for(int j = 0; j < segmentationResults.length(); ++j) {
-      const Segmentation* seg = segmentationResults[j];
-      BOX* bbox = M_Utils::tessTBoxToImBox(seg->box, imageResults->getVisualResultsDisplay());
-      const RESULT_TYPE restype = seg->res;
-      rectstream << imageResults->getResultsName() << " " <<
-          ((restype == DISPLAYED) ? "displayed" : (restype == EMBEDDED)
-              ? "embedded" : "label") << " " << bbox->x << " " << bbox->y
-              << " " << bbox->x + bbox->w << " " << bbox->y + bbox->h << std::endl;
-      boxDestroy(&bbox);
-    }
+    rectstream << imageResults->getResultsRectLines();
 
     // save the images
-    pixWrite((imgname + (std::string)".png").c_str(),
-        imageResults->getVisualResultsDisplay(),
-        IFF_PNG);
-    const std::string evalColoredDir = resultsDirPath + std::string("coloredEval/");
-    Utils::exec(std::string("mkdir -p ") + evalColoredDir);
-    const std::string evalColoredIm = evalColoredDir + imageResults->getResultsName();
-    pixWrite((evalColoredIm + (std::string)".png").c_str(),
-        imageResults->getVisualResultsEvalDisplay(),
-        IFF_PNG);
+    if(writeImages) {
+      printResultImagesToFiles(imageResults, resultsDirPath);
+    }
 
     // flush file stream
     rectstream.flush();
@@ -147,6 +199,279 @@ void MathExpressionFinderResults::printResultsToFiles(
   rectstream.close();
 }
 
+void MathExpressionFinderResults::printResultImagesToFiles(
+    MathExpressionFinderResults* const imageResults,
+    const std::string& resultsDirName) {
+  const std::string resultsDirPath = Utils::checkTrailingSlash(resultsDirName);
+  const std::string imgname = resultsDirPath + imageResults->getResultsName();
+  pixWrite((imgname + (std::string)".png").c_str(),
+      imageResults->getVisualResultsDisplay(),
+      IFF_PNG);
+  const std::string evalColoredDir = resultsDirPath + std::string("coloredEval/");
+  if(!Utils::existsDirectory(evalColoredDir)) {
+    Utils::exec(std::string("mkdir -p ") + evalColoredDir);
+  }
+  const std::string evalColoredIm = evalColoredDir + imageResults->getResultsName();
+  pixWrite((evalColoredIm + (std::string)".png").c_str(),
+      imageResults->getVisualResultsEvalDisplay(),
+      IFF_PNG);
+}
+
+void MathExpressionFinderResults::printShardResultsToFiles(
+    const std::vector<MathExpressionFinderResults*>& results,
+    const std::vector<int>& pageNumbers,
+    const std::string& shardResultsDirName,
+    const int shardIndex,
+    const int shardCount,
+    const bool writeImages) {
+  assert(results.size() == pageNumbers.size());
+  printResultsToFiles(results, shardResultsDirName, writeImages);
+
+  // the index holds the shard's place in the run followed by the position of
+  // each of its pages in the full run and the name its results are under
+  const std::string indexPath =
+      Utils::checkTrailingSlash(shardResultsDirName) + std::string("shard.index");
+  std::ofstream indexStream(indexPath.c_str());
+  indexStream << shardIndex << " " << shardCount << std::endl;
+  for(int i = 0; i < results.size(); ++i) {
+    indexStream << pageNumbers[i] << " " << results[i]->getResultsName() << std::endl;
+  }
+  indexStream.close();
+}
+
+bool MathExpressionFinderResults::mergeShardResults(
+    const std::string& resultsDirName, const int shardCount) {
+
+  // Read in every shard's index and results, keyed by page number
+  std::map<int, std::string> pageNames;
+  std::map<int, std::string> pageShardDirs;
+  std::map<std::string, std::vector<std::string> > pageRectLines;
+  std::vector<std::string> shardDirs;
+  for(int i = 0; i < shardCount; ++i) {
+    const std::string shardDir = Utils::checkTrailingSlash(
+        getShardResultsDirName(resultsDirName, i, shardCount));
+    shardDirs.push_back(shardDir);
+    std::ifstream indexStream((shardDir + std::string("shard.index")).c_str());
+    int indexShard = -1;
+    int indexShardCount = -1;
+    std::string line;
+    if(!indexStream.is_open() || !std::getline(indexStream, line)
+        || !(std::istringstream(line) >> indexShard >> indexShardCount)
+        || indexShard != i || indexShardCount != shardCount) {
+      std::cout << "ERROR: Shard " << i << " of " << shardCount << " is missing "
+          << "or incomplete (expected its results in " << shardDir << "). "
+          << "Can't merge the results until all of the shards have finished.\n";
+      return false;
+    }
+    // the page name is the rest of the line after the page number since it
+    // can have spaces in it
+    while(std::getline(indexStream, line)) {
+      const size_t spaceIndex = line.find(' ');
+      if(line.empty() || spaceIndex == std::string::npos) {
+        continue;
+      }
+      const int pageNumber = atoi(line.substr(0, spaceIndex).c_str());
+      if(pageNames.find(pageNumber) != pageNames.end()) {
+        std::cout << "ERROR: Page " << pageNumber << " is in more than one shard.\n";
+        return false;
+      }
+      pageNames[pageNumber] = line.substr(spaceIndex + 1);
+      pageShardDirs[pageNumber] = shardDir;
+    }
+    std::ifstream rectStream((shardDir + std::string("results.rect")).c_str());
+    while(std::getline(rectStream, line)) {
+      if(line.empty()) {
+        continue;
+      }
+      pageRectLines[getRectLinePageName(line)].push_back(line);
+    }
+  }
+
+  // Write them out in page order, just like a single run would have
+  if(!Utils::existsDirectory(resultsDirName)) {
+    Utils::exec("mkdir -p " + resultsDirName, true);
+    std::cout << "Creating results directory at " << resultsDirName << std::endl;
+  }
+  const std::string resultsDirPath = Utils::checkTrailingSlash(resultsDirName);
+  const std::string evalColoredDir = resultsDirPath + std::string("coloredEval/");
+  Utils::exec(std::string("mkdir -p ") + evalColoredDir);
+  std::ofstream rectstream((resultsDirPath + std::string("results.rect")).c_str());
+  std::vector<std::string> pageOrder;
+  for(std::map<int, std::string>::iterator it = pageNames.begin();
+      it != pageNames.end(); ++it) {
+    const std::string& pageName = it->second;
+    pageOrder.push_back(pageName);
+    const std::vector<std::string>& lines = pageRectLines[pageName];
+    for(int i = 0; i < lines.size(); ++i) {
+      rectstream << lines[i] << std::endl;
+    }
+    const std::string& shardDir = pageShardDirs[it->first];
+    Utils::exec(std::string("cp \"") + shardDir + pageName + std::string(".png\" \"")
+        + resultsDirPath + std::string("\""));
+    Utils::exec(std::string("cp \"") + shardDir + std::string("coloredEval/")
+        + pageName + std::string(".png\" \"") + evalColoredDir + std::string("\""));
+  }
+  rectstream.close();
+
+  // along with the stats each shard wrote about its own pages
+  mergeShardPageStats(shardDirs, "memory_stats.tsv", resultsDirPath, pageOrder);
+  mergeShardCacheStats(shardDirs, "word_cache_stats.tsv", resultsDirPath);
+  mergeShardCacheStats(shardDirs, "prediction_cache_stats.tsv", resultsDirPath);
+
+  std::cout << "Merged the results for " << pageNames.size() << " pages from "
+      << shardCount << " shards into " << resultsDirName << std::endl;
+  return true;
+}
+
+bool MathExpressionFinderResults::clearResultsDir(
+    const std::string& resultsDirName, const std::string& inputPath) {
+  if(!Utils::existsDirectory(resultsDirName)) {
+    return true;
+  }
+  // running on a directory from its parent would name the results after the
+  // input directory itself
+  char resultsRealPath[PATH_MAX];
+  char inputRealPath[PATH_MAX];
+  if(realpath(resultsDirName.c_str(), resultsRealPath) != NULL
+      && realpath(inputPath.c_str(), inputRealPath) != NULL) {
+    const std::string resultsPath =
+        Utils::checkTrailingSlash(std::string(resultsRealPath));
+    if(Utils::checkTrailingSlash(std::string(inputRealPath))
+        .compare(0, resultsPath.size(), resultsPath) == 0) {
+      std::cout << "ERROR: The results would go in " << resultsDirName
+          << ", which holds the input. Run from a different directory.\n";
+      return false;
+    }
+  }
+  Utils::exec(std::string("rm -rf \"") + resultsDirName + std::string("\""), true);
+  return true;
+}
+
+std::string MathExpressionFinderResults::getRectLinePageName(
+    const std::string& rectLine) {
+  size_t nameEnd = rectLine.size();
+  for(int i = 0; i < 5 && nameEnd != std::string::npos && nameEnd > 0; ++i) {
+    nameEnd = rectLine.rfind(' ', nameEnd - 1);
+  }
+  return (nameEnd == std::string::npos) ? rectLine : rectLine.substr(0, nameEnd);
+}
+
+void MathExpressionFinderResults::mergeShardPageStats(
+    const std::vector<std::string>& shardDirs, const std::string& fileName,
+    const std::string& resultsDirPath, const std::vector<std::string>& pageOrder) {
+  std::string header;
+  std::map<std::string, std::vector<std::string> > pageRows;
+  std::vector<std::string> pageNamesRead; // in the order they were read
+  for(int i = 0; i < shardDirs.size(); ++i) {
+    std::ifstream stream((shardDirs[i] + fileName).c_str());
+    std::string line;
+    if(!stream.is_open() || !std::getline(stream, line)) {
+      continue;
+    }
+    header = line;
+    while(std::getline(stream, line)) {
+      if(line.empty()) {
+        continue;
+      }
+      const std::string pageName = line.substr(0, line.find('\t'));
+      if(pageRows.find(pageName) == pageRows.end()) {
+        pageNamesRead.push_back(pageName);
+      }
+      pageRows[pageName].push_back(line);
+    }
+  }
+  if(header.empty()) {
+    return; // none of the shards wrote it
+  }
+  std::vector<std::string> mergedOrder = pageOrder;
+  for(int i = 0; i < pageNamesRead.size(); ++i) {
+    if(std::find(pageOrder.begin(), pageOrder.end(), pageNamesRead[i])
+        == pageOrder.end()) {
+      mergedOrder.push_back(pageNamesRead[i]);
+    }
+  }
+  std::ofstream stream((resultsDirPath + fileName).c_str());
+  stream << header << "\n";
+  for(int i = 0; i < mergedOrder.size(); ++i) {
+    const std::vector<std::string>& rows = pageRows[mergedOrder[i]];
+    for(int j = 0; j < rows.size(); ++j) {
+      stream << rows[j] << "\n";
+    }
+  }
+}
+
+void MathExpressionFinderResults::mergeShardCacheStats(
+    const std::vector<std::string>& shardDirs, const std::string& fileName,
+    const std::string& resultsDirPath) {
+  // the columns are all summed except for the row's name (if it has one) and
+  // the hit rate, which is worked out from the summed hits and misses
+  std::vector<std::string> columns;
+  std::vector<std::string> rowNames;
+  std::map<std::string, std::vector<double> > rowSums;
+  int shardsRead = 0;
+  for(int i = 0; i < shardDirs.size(); ++i) {
+    std::ifstream stream((shardDirs[i] + fileName).c_str());
+    std::string line;
+    if(!stream.is_open() || !std::getline(stream, line)) {
+      continue;
+    }
+    columns = Utils::stringSplit(line, '\t');
+    ++shardsRead;
+    while(std::getline(stream, line)) {
+      if(line.empty() || line[0] == '#') {
+        continue;
+      }
+      const std::vector<std::string> fields = Utils::stringSplit(line, '\t');
+      const bool named = (columns[0] != "hits");
+      const std::string rowName = named ? fields[0] : std::string("");
+      std::vector<double>& sums = rowSums[rowName];
+      if(sums.empty()) {
+        rowNames.push_back(rowName);
+        sums.assign(columns.size(), 0);
+      }
+      for(int j = named ? 1 : 0; j < fields.size() && j < columns.size(); ++j) {
+        sums[j] += atof(fields[j].c_str());
+      }
+    }
+  }
+  if(shardsRead == 0) {
+    return; // none of the shards wrote it
+  }
+  const int hitsColumn = std::find(columns.begin(), columns.end(), "hits")
+      - columns.begin();
+  const int missesColumn = std::find(columns.begin(), columns.end(), "misses")
+      - columns.begin();
+  std::ofstream stream((resultsDirPath + fileName).c_str());
+  stream.precision(12); // keeps large counts from going to scientific notation
+  for(int j = 0; j < columns.size(); ++j) {
+    stream << ((j > 0) ? "\t" : "") << columns[j];
+  }
+  stream << "\n";
+  for(int i = 0; i < rowNames.size(); ++i) {
+    const std::vector<double>& sums = rowSums[rowNames[i]];
+    for(int j = 0; j < columns.size(); ++j) {
+      stream << ((j > 0) ? "\t" : "");
+      if(j == 0 && columns[0] != "hits") {
+        stream << rowNames[i];
+      } else if(columns[j] == "hit_rate" && hitsColumn < columns.size()
+          && missesColumn < columns.size()) {
+        const double total = sums[hitsColumn] + sums[missesColumn];
+        stream << ((total > 0) ? sums[hitsColumn] / total : 0);
+      } else {
+        stream << sums[j];
+      }
+    }
+    stream << "\n";
+  }
+  stream << "# summed over " << shardsRead << " shards\n";
+}
+
+std::string MathExpressionFinderResults::getShardResultsDirName(
+    const std::string& resultsDirName, const int shardIndex,
+    const int shardCount) {
+  return resultsDirName + std::string("_shard_") + Utils::intToString(shardIndex)
+      + std::string("_of_") + Utils::intToString(shardCount);
+}
 
 void MathExpressionFinderResults::ensureNoDuplicates() {
   GenericVector<int> toRemove;
@@ -61,15 +61,88 @@ class MathExpressionFinderResults {
   // displays the segmentations
   void displaySegmentationResults();
 
+  // maps the results found on a copy of the page that was scaled down by the
+  // given factor (see ResolutionNormalizer) back onto the original page,
+  // redrawing the result images on it
+  void mapToOriginalImage(Pix* const originalImage, const double scale);
+
+  // gets the segmentations as lines in the .rect file format (one per
+  // segmentation): name type left top right bottom
+  std::string getResultsRectLines();
+
+  // destroys the result images once they've been written out so they don't
+  // take up memory for the rest of a long run. only the segmentations are
+  // left (the images can't be displayed or printed after this).
+  void releaseVisualResults();
+
   // prints the given result objects (each corresponding with an image,
-  // not a segmentations (each image can have 0 or more segmentations)
+  // not a segmentations (each image can have 0 or more segmentations).
+  // the images can be left out if they were already printed (see
+  // printResultImagesToFiles).
   static void printResultsToFiles(
       const std::vector<MathExpressionFinderResults*>& results,
+      const std::string& resultsDirName,
+      const bool writeImages=true);
+
+  // prints just the result images for one page (the results directory has
+  // to exist already)
+  static void printResultImagesToFiles(
+      MathExpressionFinderResults* const imageResults,
       const std::string& resultsDirName);
 
+  // prints the results for one shard of a run split over several processes
+  // (see printResultsToFiles) along with an index of which pages (by their
+  // position in the full run) the shard holds so the shards can be merged
+  static void printShardResultsToFiles(
+      const std::vector<MathExpressionFinderResults*>& results,
+      const std::vector<int>& pageNumbers,
+      const std::string& shardResultsDirName,
+      const int shardIndex,
+      const int shardCount,
+      const bool writeImages=true);
+
+  // merges the results printed by all of the shards of a run into the given
+  // results directory so that they're the same as if the run was done in a
+  // single process, along with the memory and cache stats the shards wrote.
+  // returns false if any of the shards are missing.
+  static bool mergeShardResults(const std::string& resultsDirName,
+      const int shardCount);
+
+  // removes whatever an earlier run left in the results directory so that it
+  // only ends up with this run's results. the directory is named after the
+  // input, so nothing is removed (and false is returned) if the input is in it.
+  static bool clearResultsDir(const std::string& resultsDirName,
+      const std::string& inputPath);
+
+  // gets the directory a shard's results are printed to for a run whose
+  // merged results go to the given directory
+  static std::string getShardResultsDirName(const std::string& resultsDirName,
+      const int shardIndex, const int shardCount);
+
  private:
   void ensureNoDuplicates();
 
+  // gets the page name a line of a results.rect file is for (page names can
+  // have spaces in them, the five fields after the name can't)
+  static std::string getRectLinePageName(const std::string& rectLine);
+
+  // writes the rows of a stats file from every shard that wrote it into one
+  // file in the merged results, in page order for the rows of the pages in
+  // pageOrder (any others, like pages that went over the memory ceiling, go
+  // after them)
+  static void mergeShardPageStats(const std::vector<std::string>& shardDirs,
+      const std::string& fileName, const std::string& resultsDirPath,
+      const std::vector<std::string>& pageOrder);
+
+  // adds up the hits, misses and seconds of a cache stats file from every
+  // shard that wrote it (see WordClassificationCache::printStats and
+  // SvmPredictionCache::printStats) and works out the hit rate again
+  static void mergeShardCacheStats(const std::vector<std::string>& shardDirs,
+      const std::string& fileName, const std::string& resultsDirPath);
+
+  // draws the results over the given page the same way the grid does
+  Pix* drawResults(Pix* const image, const bool drawBox);
+
   Pix* visualResultsDisplay;
   Pix* visualResultsEvalDisplay;
   GenericVector<Segmentation*> segmentationResults;
@@ -0,0 +1,231 @@
+/*
+ * MemStats.cpp
+ */
+
+#include <MemStats.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+
+#ifdef COUNT_ALLOCATIONS
+#include <atomic>
+#include <new>
+
+static std::atomic<long long> bytesAllocated(0);
+static std::atomic<long long> allocationCount(0);
+
+void* operator new(size_t size) {
+  bytesAllocated += size;
+  ++allocationCount;
+  void* const p = malloc(size == 0 ? 1 : size);
+  if(p == NULL) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  free(p);
+}
+#endif
+
+PageMemoryStats::PageMemoryStats(const std::string& pageName,
+    const long ceilingKB) : pageName(pageName), ceilingKB(ceilingKB),
+        baselineRssKB(getCurrentRssKB()), blobCount(0), gridCellCount(0),
+        noiseComponentCount(0), pictureComponentCount(0), failed(false) {
+  perStagePeak = resetPeakRss();
+  stageStartBytes = getBytesAllocated();
+  stageStartCount = getAllocationCount();
+}
+
+void PageMemoryStats::endStage(const std::string& stage) {
+  StageMemory stageMemory;
+  stageMemory.stage = stage;
+  stageMemory.rssKB = getCurrentRssKB();
+  stageMemory.peakRssKB = getPeakRssSoFarKB();
+  const long long bytes = getBytesAllocated();
+  const long long count = getAllocationCount();
+  stageMemory.bytesAllocated = (bytes < 0) ? -1 : bytes - stageStartBytes;
+  stageMemory.allocationCount = (count < 0) ? -1 : count - stageStartCount;
+  stages.push_back(stageMemory);
+
+  // start the next stage
+  if(perStagePeak) {
+    perStagePeak = resetPeakRss();
+  }
+  stageStartBytes = getBytesAllocated();
+  stageStartCount = getAllocationCount();
+}
+
+void PageMemoryStats::setBlobCount(const int blobCount) {
+  this->blobCount = blobCount;
+}
+
+void PageMemoryStats::setGridCellCount(const int gridCellCount) {
+  this->gridCellCount = gridCellCount;
+}
+
+void PageMemoryStats::setNoiseComponentCount(const int noiseComponentCount) {
+  this->noiseComponentCount = noiseComponentCount;
+}
+
+void PageMemoryStats::setPictureComponentCount(const int pictureComponentCount) {
+  this->pictureComponentCount = pictureComponentCount;
+}
+
+bool PageMemoryStats::isOverCeiling() {
+  if(ceilingKB <= 0 || stages.empty()) {
+    return false;
+  }
+  // if the peak can't be reset then it may belong to an earlier page, so
+  // only the current size can be held against this one
+  const StageMemory& last = stages.back();
+  return (perStagePeak ? last.peakRssKB : last.rssKB) - baselineRssKB
+      > ceilingKB;
+}
+
+long PageMemoryStats::getBaselineRssKB() {
+  return baselineRssKB;
+}
+
+void PageMemoryStats::setFailed() {
+  failed = true;
+}
+
+bool PageMemoryStats::isFailed() {
+  return failed;
+}
+
+std::string PageMemoryStats::getPageName() {
+  return pageName;
+}
+
+std::vector<StageMemory>& PageMemoryStats::getStages() {
+  return stages;
+}
+
+long PageMemoryStats::getPeakRssKB() {
+  long peak = 0;
+  for(int i = 0; i < stages.size(); ++i) {
+    if(stages[i].peakRssKB > peak) {
+      peak = stages[i].peakRssKB;
+    }
+  }
+  return peak;
+}
+
+void PageMemoryStats::writeStatsFile(std::vector<PageMemoryStats>& pageStats,
+    const std::string& path) {
+  std::ofstream statsStream(path.c_str());
+  if(!statsStream.is_open()) {
+    std::cout << "ERROR: Could not write the memory stats to " << path << std::endl;
+    return;
+  }
+  printHeader(statsStream);
+  for(int i = 0; i < pageStats.size(); ++i) {
+    pageStats[i].print(statsStream);
+  }
+  statsStream.close();
+}
+
+void PageMemoryStats::printHeader(std::ostream& stream) {
+  stream << "page\tstage\tpeak_rss_kb\trss_kb\tbytes_allocated\tallocations"
+      << "\tblobs\tgrid_cells\tnoise_filtered\tpicture_filtered"
+      << "\tpeak_is_per_stage\tstatus\n";
+}
+
+void PageMemoryStats::print(std::ostream& stream) {
+  for(int i = 0; i < stages.size(); ++i) {
+    const StageMemory& stage = stages[i];
+    stream << pageName << "\t" << stage.stage << "\t" << stage.peakRssKB
+        << "\t" << stage.rssKB << "\t" << stage.bytesAllocated << "\t"
+        << stage.allocationCount << "\t" << blobCount << "\t" << gridCellCount
+        << "\t" << noiseComponentCount << "\t" << pictureComponentCount << "\t"
+        << (perStagePeak ? 1 : 0) << "\t"
+        << ((failed && i == stages.size() - 1) ? "over_ceiling" : "ok") << "\n";
+  }
+}
+
+long PageMemoryStats::getCurrentRssKB() {
+  return readStatusKB("VmRSS");
+}
+
+long PageMemoryStats::getPeakRssSoFarKB() {
+  return readStatusKB("VmHWM");
+}
+
+long PageMemoryStats::getAddressSpaceKB() {
+  return readStatusKB("VmSize");
+}
+
+bool PageMemoryStats::resetPeakRss() {
+  // writing 5 to clear_refs resets VmHWM to the current RSS (Linux 4.0+)
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  if(!clearRefs.is_open()) {
+    return false;
+  }
+  clearRefs << "5";
+  clearRefs.close();
+  return !clearRefs.fail();
+}
+
+long PageMemoryStats::readStatusKB(const std::string& field) {
+  std::ifstream statusStream("/proc/self/status");
+  std::string line;
+  while(std::getline(statusStream, line)) {
+    if(line.compare(0, field.size() + 1, field + ":") == 0) {
+      std::istringstream lineStream(line.substr(field.size() + 1));
+      long kb = 0;
+      lineStream >> kb;
+      return kb;
+    }
+  }
+  return 0;
+}
+
+long long PageMemoryStats::getBytesAllocated() {
+#ifdef COUNT_ALLOCATIONS
+  return bytesAllocated;
+#else
+  return -1;
+#endif
+}
+
+long long PageMemoryStats::getAllocationCount() {
+#ifdef COUNT_ALLOCATIONS
+  return allocationCount;
+#else
+  return -1;
+#endif
+}
+
+PageMemoryLimit::PageMemoryLimit(const long ceilingKB) : set(false) {
+  const long addressSpaceKB = PageMemoryStats::getAddressSpaceKB();
+  if(ceilingKB <= 0 || addressSpaceKB <= 0
+      || getrlimit(RLIMIT_AS, &previousLimit) != 0) {
+    return;
+  }
+  struct rlimit pageLimit = previousLimit;
+  const rlim_t limitBytes = (rlim_t)(addressSpaceKB + ceilingKB) * 1024;
+  if(previousLimit.rlim_cur != RLIM_INFINITY
+      && previousLimit.rlim_cur < limitBytes) {
+    return; // already capped below the ceiling
+  }
+  pageLimit.rlim_cur = limitBytes;
+  set = (setrlimit(RLIMIT_AS, &pageLimit) == 0);
+}
+
+PageMemoryLimit::~PageMemoryLimit() {
+  if(set) {
+    setrlimit(RLIMIT_AS, &previousLimit);
+  }
+}
@@ -0,0 +1,171 @@
+/*
+ * MemStats.h
+ */
+
+#ifndef MEMSTATS_H_
+#define MEMSTATS_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+// Uncomment to replace the global operator new/delete with ones that count
+// the bytes and number of allocations made by each stage. Only allocations
+// made with new are counted, so the memory Leptonica and Tesseract get with
+// malloc only shows up in the resident set size.
+//#define COUNT_ALLOCATIONS
+
+/**
+ * The memory used by a single stage of processing a page
+ */
+struct StageMemory {
+  std::string stage;
+  long peakRssKB; // highest resident set size reached during the stage
+  long rssKB; // resident set size once the stage was done
+  long long bytesAllocated; // bytes allocated with new during the stage (-1 if not counted)
+  long long allocationCount; // number of allocations with new during the stage (-1 if not counted)
+};
+
+/**
+ * Keeps track of the peak resident set size (and the allocations if
+ * COUNT_ALLOCATIONS is defined) for each stage of processing a page. The
+ * peak is reset at the start of every stage on Linux kernels that allow it
+ * (through /proc/self/clear_refs), otherwise each stage's peak is the highest
+ * one seen by the process so far. A memory ceiling can be set on how much the
+ * page may grow the process by (over its resident set size when the page was
+ * started) so that a page that grows too large can be abandoned rather than
+ * having the OS kill the whole run. The ceiling is checked here after each
+ * stage, and is enforced during the stages by a PageMemoryLimit.
+ */
+class PageMemoryStats {
+
+ public:
+
+  /**
+   * Starts tracking the given page, taking the process's current resident set
+   * size as the page's baseline. A ceiling of 0 means there isn't one.
+   */
+  PageMemoryStats(const std::string& pageName, const long ceilingKB=0);
+
+  /**
+   * Records the memory used since the previous stage ended (or since the
+   * page was started) under the given stage name and starts the next stage
+   */
+  void endStage(const std::string& stage);
+
+  void setBlobCount(const int blobCount);
+  void setGridCellCount(const int gridCellCount);
+  void setNoiseComponentCount(const int noiseComponentCount);
+  void setPictureComponentCount(const int pictureComponentCount);
+
+  /**
+   * True if the peak of the last stage recorded went over the page's baseline
+   * by more than the ceiling
+   */
+  bool isOverCeiling();
+
+  /**
+   * Resident set size of the process when the page was started
+   */
+  long getBaselineRssKB();
+
+  /**
+   * Marks the page as abandoned (i.e., because it went over the ceiling)
+   */
+  void setFailed();
+  bool isFailed();
+
+  std::string getPageName();
+  std::vector<StageMemory>& getStages();
+
+  /**
+   * Gets the highest peak over all of the page's stages
+   */
+  long getPeakRssKB();
+
+  /**
+   * Writes one tab separated line per stage of each page to the given path
+   * (with a header line naming the columns) so that it can be read in by
+   * a script or spreadsheet.
+   */
+  static void writeStatsFile(std::vector<PageMemoryStats>& pageStats,
+      const std::string& path);
+
+  static void printHeader(std::ostream& stream);
+  void print(std::ostream& stream);
+
+  /**
+   * Current and peak resident set size of this process in kilobytes (0 if
+   * they couldn't be read)
+   */
+  static long getCurrentRssKB();
+  static long getPeakRssSoFarKB();
+
+  /**
+   * Size of this process's address space (i.e., its virtual memory) in
+   * kilobytes (0 if it couldn't be read)
+   */
+  static long getAddressSpaceKB();
+
+ private:
+
+  // Tries to reset the process's peak resident set size to its current one.
+  // Returns false if the kernel doesn't support it.
+  static bool resetPeakRss();
+
+  // Reads the given field (i.e., VmRSS or VmHWM) from /proc/self/status
+  static long readStatusKB(const std::string& field);
+
+  static long long getBytesAllocated();
+  static long long getAllocationCount();
+
+  std::string pageName;
+  long ceilingKB;
+  long baselineRssKB;
+  int blobCount;
+  int gridCellCount;
+  int noiseComponentCount; // components filtered out before the grid was built
+  int pictureComponentCount; // components left off of the grid for being in a picture
+  bool failed;
+  bool perStagePeak; // false if the peak couldn't be reset between stages
+  std::vector<StageMemory> stages;
+
+  // the allocation counters at the start of the current stage
+  long long stageStartBytes;
+  long long stageStartCount;
+};
+
+
+/**
+ * Enforces a page's memory ceiling while the page is being processed, so that
+ * a single stage can't run the process out of memory before the ceiling is
+ * checked at its end. For as long as the object is around, the process's
+ * address space is capped (with RLIMIT_AS) at its size when the object was
+ * made plus the ceiling. An allocation that would take the page over it then
+ * fails right away: new throws std::bad_alloc, which the caller catches to
+ * abandon the page, and malloc returns NULL to Leptonica. Address space is
+ * counted rather than resident memory, so the cap is never looser than the
+ * ceiling checked by PageMemoryStats. The previous limit is put back when
+ * the object is destroyed.
+ */
+class PageMemoryLimit {
+
+ public:
+
+  /**
+   * Caps the address space at its current size plus the given ceiling. A
+   * ceiling of 0 means there isn't one and nothing is capped.
+   */
+  PageMemoryLimit(const long ceilingKB);
+
+  ~PageMemoryLimit();
+
+ private:
+
+  struct rlimit previousLimit;
+  bool set;
+};
+
+
+#endif /* MEMSTATS_H_ */
@@ -0,0 +1,48 @@
+/*
+ * PageSource.cpp
+ */
+
+#include <PageSource.h>
+
+#include <Utils.h>
+
+#include <string>
+#include <vector>
+
+PageSource::PageSource(const std::string& path, const int page)
+: path(path), page(page) {}
+
+void PageSource::addPageSources(const std::string& path,
+    std::vector<PageSource>* const pageSources) {
+  const int pageCount = Utils::leptGetTiffPageCount(path);
+  if(pageCount <= 1) {
+    pageSources->push_back(PageSource(path));
+    return;
+  }
+  for(int i = 0; i < pageCount; ++i) {
+    pageSources->push_back(PageSource(path, i));
+  }
+}
+
+Pix* PageSource::readBinarized() const {
+  if(isTiffPage()) {
+    return Utils::leptReadAndBinarizeTiffPage(path, page);
+  }
+  return Utils::leptReadAndBinarizeImg(path);
+}
+
+std::string PageSource::getName() const {
+  // the file name without its directory or extension
+  const std::string::size_type slashIndex = path.find_last_of("/");
+  const std::string fileName = (slashIndex == std::string::npos) ?
+      path : path.substr(slashIndex + 1);
+  const std::string name = fileName.substr(0, fileName.find_last_of("."));
+  if(isTiffPage()) {
+    return name + "_p" + Utils::intToString(page);
+  }
+  return name;
+}
+
+bool PageSource::isTiffPage() const {
+  return page != WHOLE_FILE_PAGE;
+}
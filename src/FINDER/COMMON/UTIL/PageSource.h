@@ -0,0 +1,52 @@
+/*
+ * PageSource.h
+ */
+
+#ifndef PAGESOURCE_H_
+#define PAGESOURCE_H_
+
+#include <allheaders.h>
+
+#include <string>
+#include <vector>
+
+// Page index of a source that's a whole (single image) file
+#define WHOLE_FILE_PAGE -1
+
+/**
+ * Where one page of input comes from, either a single image file or one page
+ * of a multi-page TIFF. Nothing is read in until readBinarized is called, so
+ * a long TIFF can be gone through one page at a time without the rest of it
+ * ever being decoded.
+ */
+struct PageSource {
+  PageSource(const std::string& path, const int page=WHOLE_FILE_PAGE);
+
+  /**
+   * Adds a source for each page of a multi-page TIFF at the given path, or
+   * just one for the whole file if it's any other image (including a TIFF
+   * with only one page). Only the TIFF's page headers are read to count them.
+   */
+  static void addPageSources(const std::string& path,
+      std::vector<PageSource>* const pageSources);
+
+  /**
+   * Reads in and binarizes the page
+   */
+  Pix* readBinarized() const;
+
+  /**
+   * The name the page's results are kept under: the file's name without its
+   * extension, followed by _p and the page index for a page of a multi-page
+   * TIFF (e.g., scan_p12 for the 13th page of scan.tif)
+   */
+  std::string getName() const;
+
+  bool isTiffPage() const;
+
+  std::string path;
+  int page; // 0 based page of a multi-page TIFF, WHOLE_FILE_PAGE otherwise
+};
+
+
+#endif /* PAGESOURCE_H_ */
@@ -0,0 +1,98 @@
+/*
+ * ResolutionNormalizer.cpp
+ */
+
+#include <ResolutionNormalizer.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <assert.h>
+
+// Components smaller than this (in pixels) on either side aren't counted as
+// characters when estimating the resolution
+#define MIN_CHAR_DIM 4
+
+ResolutionNormalizer::ResolutionNormalizer(const int targetDpi)
+    : targetDpi(targetDpi) {
+  assert(targetDpi > 0);
+}
+
+int ResolutionNormalizer::estimateDpi(Pix* const image) {
+  // only the boxes are needed, which keeps this cheap even on a huge page
+  Boxa* boxes = pixConnComp(image, NULL, 8);
+  std::vector<int> heights;
+  for(int i = 0; i < boxes->n; ++i) {
+    const Box* const box = boxes->box[i];
+    if(box->w >= MIN_CHAR_DIM && box->h >= MIN_CHAR_DIM) {
+      heights.push_back(box->h);
+    }
+  }
+  boxaDestroy(&boxes);
+  if(heights.empty()) {
+    return 0;
+  }
+  std::vector<int>::iterator median = heights.begin() + heights.size() / 2;
+  std::nth_element(heights.begin(), median, heights.end());
+  return (int)(300.0 * (*median) / REFERENCE_CHAR_HEIGHT_AT_300_DPI + 0.5);
+}
+
+Pix* ResolutionNormalizer::normalize(Pix* const image,
+    PageResolution* const pageResolution) {
+  pageResolution->width = pixGetWidth(image);
+  pageResolution->height = pixGetHeight(image);
+  pageResolution->estimatedDpi = estimateDpi(image);
+  pageResolution->scale = 1;
+  pageResolution->processedWidth = pageResolution->width;
+  pageResolution->processedHeight = pageResolution->height;
+  if(pageResolution->estimatedDpi < targetDpi * RESOLUTION_TOLERANCE) {
+    return pixClone(image);
+  }
+  // Each reduced pixel gets the average of the original pixels it covers
+  // before being thresholded back to binary, which keeps the shape of the
+  // characters far better than subsampling or a rank reduction would
+  const double scale = (double)targetDpi / pageResolution->estimatedDpi;
+  Pix* gray = pixScaleToGray(image, (l_float32)scale);
+  Pix* reduced = pixThresholdToBinary(gray, REDUCED_GRAY_THRESHOLD);
+  pixDestroy(&gray);
+  // the scale actually used in each direction, after rounding to whole pixels
+  pageResolution->scale = (double)pixGetWidth(reduced) / pixGetWidth(image);
+  pageResolution->processedWidth = pixGetWidth(reduced);
+  pageResolution->processedHeight = pixGetHeight(reduced);
+  return reduced;
+}
+
+void ResolutionNormalizer::printReport(const std::vector<PageResolution>& pages,
+    std::ostream& stream) {
+  stream << "page\testimated_dpi\tscale\twidth\theight\tprocessed_width"
+      << "\tprocessed_height\tseconds\n";
+  int reducedPages = 0;
+  double totalSeconds = 0;
+  for(int i = 0; i < pages.size(); ++i) {
+    const PageResolution& page = pages[i];
+    stream << page.pageName << "\t" << page.estimatedDpi << "\t" << page.scale
+        << "\t" << page.width << "\t" << page.height << "\t"
+        << page.processedWidth << "\t" << page.processedHeight << "\t"
+        << page.seconds << "\n";
+    if(page.scale < 1) {
+      ++reducedPages;
+    }
+    if(page.seconds > 0) {
+      totalSeconds += page.seconds;
+    }
+  }
+  stream << "# " << reducedPages << " of " << pages.size()
+      << " pages reduced, " << totalSeconds << " seconds in total\n";
+}
+
+void ResolutionNormalizer::writeReportFile(
+    const std::vector<PageResolution>& pages, const std::string& path) {
+  std::ofstream stream(path.c_str());
+  if(!stream.is_open()) {
+    std::cout << "ERROR: Could not write the resolution report to " << path << std::endl;
+    return;
+  }
+  printReport(pages, stream);
+}
@@ -0,0 +1,88 @@
+/*
+ * ResolutionNormalizer.h
+ */
+
+#ifndef RESOLUTIONNORMALIZER_H_
+#define RESOLUTIONNORMALIZER_H_
+
+#include <allheaders.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Detection accuracy levels off at around 300 dpi, which is also what the
+// finders are usually trained on
+#define DEFAULT_TARGET_DPI 300
+
+// Median connected component height of 10 to 12 point body text scanned at
+// 300 dpi (most characters are x-height, the rest have ascenders)
+#define REFERENCE_CHAR_HEIGHT_AT_300_DPI 21
+
+// Pages aren't reduced unless they're estimated to be at least this much
+// over the target, so a 300 dpi page with slightly large print is left alone
+#define RESOLUTION_TOLERANCE 1.25
+
+// A reduced pixel is foreground if its gray value (after averaging the
+// original pixels it covers) is under this, i.e., if at least about 37% of
+// it was foreground. Leaning towards foreground keeps thin strokes intact.
+#define REDUCED_GRAY_THRESHOLD 160
+
+/**
+ * How one page was normalized and how long it took to process
+ */
+struct PageResolution {
+  std::string pageName;
+  int estimatedDpi; // 0 if there wasn't enough text to tell
+  double scale; // processed size over original size (1 if not reduced)
+  int width, height; // original size
+  int processedWidth, processedHeight; // size it was processed at
+  double seconds; // time taken to process the page (-1 if not timed)
+};
+
+/**
+ * Brings binary pages scanned at a high resolution down to the one the
+ * finder works best at. The grid, the number of components and their
+ * images, and every search over the page all grow with the resolution,
+ * while the detection results stop getting any better past the target.
+ * The resolution a page was scanned at is estimated from the height of its
+ * characters rather than taken from the image's header, since the header is
+ * often missing or wrong and it's the size of the print in pixels that
+ * matters anyway.
+ */
+class ResolutionNormalizer {
+ public:
+
+  ResolutionNormalizer(const int targetDpi=DEFAULT_TARGET_DPI);
+
+  /**
+   * Estimates the resolution of the binary page from the median height of
+   * its connected components. Returns 0 if there aren't any characters.
+   */
+  static int estimateDpi(Pix* const image);
+
+  /**
+   * Returns the page to process in place of the given binary one: a reduced
+   * copy if it's estimated to be well over the target resolution, otherwise
+   * a clone of it. Either is owned by the caller. The page's estimated
+   * resolution and the scale of what's returned are recorded to the given
+   * page resolution.
+   */
+  Pix* normalize(Pix* const image, PageResolution* const pageResolution);
+
+  /**
+   * Writes one tab separated line per page (with a header line naming the
+   * columns) followed by the totals as a comment
+   */
+  static void printReport(const std::vector<PageResolution>& pages,
+      std::ostream& stream);
+  static void writeReportFile(const std::vector<PageResolution>& pages,
+      const std::string& path);
+
+ private:
+
+  int targetDpi;
+};
+
+
+#endif /* RESOLUTIONNORMALIZER_H_ */
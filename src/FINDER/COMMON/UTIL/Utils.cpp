@@ -71,8 +71,43 @@ Pix* Utils::leptReadImg(std::string fn) {
 }
 
 Pix* Utils::leptReadAndBinarizeImg(std::string fn) {
+  return binarizeImg(leptReadImg(fn));
+}
+
+Pix* Utils::leptReadTiffPage(std::string fn, int page) {
+  Pix* img = pixReadTiff(fn.c_str(), page);
+  if (img == NULL) {
+    std::cout << "ERROR: Could not read page " << page << " of " << fn << std::endl;
+    assert(false);
+  }
+  return img;
+}
+
+Pix* Utils::leptReadAndBinarizeTiffPage(std::string fn, int page) {
+  return binarizeImg(leptReadTiffPage(fn, page));
+}
+
+int Utils::leptGetTiffPageCount(std::string fn) {
+  l_int32 format = IFF_UNKNOWN;
+  findFileFormat(fn.c_str(), &format);
+  if(format < IFF_TIFF || format > IFF_TIFF_ZIP) {
+    return 0;
+  }
+  FILE* fp = fopenReadStream(fn.c_str());
+  if(fp == NULL) {
+    return 0;
+  }
+  l_int32 pageCount = 0;
+  if(tiffGetCount(fp, &pageCount) != 0) {
+    pageCount = 0;
+  }
+  fclose(fp);
+  return pageCount;
+}
+
+// Binarizes the image the same way Tesseract would and destroys the original
+Pix* Utils::binarizeImg(Pix* inputImg) {
   tesseract::ImageThresholder thresh;
-  Pix* inputImg = leptReadImg(fn);
   Pix* binImg = pixCreate(inputImg->w, inputImg->h, inputImg->d);
   thresh.SetImage(inputImg);
   thresh.ThresholdToPix(&binImg);
@@ -487,6 +522,28 @@ std::string Utils::getNameFromPath(const std::string& path) {
   return path;
 }
 
+unsigned long long Utils::hashBytes(const char* const bytes,
+    const size_t length, unsigned long long hash) {
+  for(size_t i = 0; i < length; ++i) {
+    hash ^= (unsigned char)bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+unsigned long long Utils::hashFile(const std::string& path,
+    unsigned long long hash) {
+  std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+  if(!file.is_open()) {
+    return hash;
+  }
+  char buffer[4096];
+  while(file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+    hash = hashBytes(buffer, file.gcount(), hash);
+  }
+  return hash;
+}
+
 // wrapper around cin getline to avoid annoying \n issue.
 void Utils::getline(std::string& str) {
   while((char)(std::cin.peek()) == '\n') {
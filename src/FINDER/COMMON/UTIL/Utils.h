@@ -57,6 +57,22 @@ namespace Utils {
   // Reads in and then binarizes the image
   Pix* leptReadAndBinarizeImg(std::string fn);
 
+  // Binarizes the image the same way Tesseract would, the given image is
+  // destroyed
+  Pix* binarizeImg(Pix* inputImg);
+
+  // Read in one page (0 based) of a multi-page TIFF using Leptonica, end
+  // execution with error message if the page can't be read. Only that page
+  // is decoded.
+  Pix* leptReadTiffPage(std::string fn, int page);
+
+  // Reads in and then binarizes one page of a multi-page TIFF
+  Pix* leptReadAndBinarizeTiffPage(std::string fn, int page);
+
+  // Returns the number of pages in the file if it's a TIFF, otherwise 0.
+  // Only the page headers are read, not the images.
+  int leptGetTiffPageCount(std::string fn);
+
   // returns the number of digits in a given integer decimal number
   int digit_count(int decnum);
 
@@ -121,6 +137,16 @@ namespace Utils {
   // doesn't modify original string, but returns newly allocated copy
   char* strCopy(const char* const str);
 
+  // 64-bit FNV-1a hash of the given bytes. The hash returned by a previous
+  // call can be passed in to hash several pieces of data together.
+  unsigned long long hashBytes(const char* const bytes, const size_t length,
+      unsigned long long hash=14695981039346656037ULL);
+
+  // same as above but on the contents of the file at the given path (the
+  // hash passed in is returned as is if the file can't be read)
+  unsigned long long hashFile(const std::string& path,
+      unsigned long long hash=14695981039346656037ULL);
+
   inline void destroyStr(char*& str) {
     if(str != NULL) {
       delete [] str;